@@ -0,0 +1,222 @@
+// Transaction page decoding: the cJSON DOM path the client used to take
+// (parse the whole body, then copy fields out of the tree) against the
+// streaming ResponseDecoder, fed the whole body at once and in 16 KiB pieces
+// as curl delivers it. Every path must produce the same records.
+//
+// Usage: decode_bench [rows per page, default 1000]
+
+#include "layer1_client.h"
+#include "response_decoder.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SECONDS 0.5             // Per measurement
+#define CHUNK_SIZE (16 * 1024)  // CURL_MAX_WRITE_SIZE
+
+typedef TransactionListResponse *(*DecodeFunction)(const char *json, size_t length);
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t next_random(void) {
+    random_state = random_state * 6364136223846793005ull + 1442695040888963407ull;
+    return (uint32_t)(random_state >> 33);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// A page shaped like the API's, with fields the client ignores included
+static char *generate_page(int rows) {
+    static const char *const statuses[] = { "SUCCESS", "PENDING", "FAILED" };
+    static const char *const networks[] = { "ETHEREUM", "TRON", "SOLANA", "POLYGON" };
+    cJSON *page = cJSON_CreateObject();
+    cJSON *content = cJSON_AddArrayToObject(page, "content");
+    for (int i = 0; i < rows; i++) {
+        char id[LAYER1_TRANSACTION_ID_TEXT_SIZE], reference[32], amount[32], created_at[32];
+        for (int k = 0; k < LAYER1_TRANSACTION_ID_TEXT_SIZE - 1; k++) {
+            id[k] = "0123456789abcdef"[next_random() % 16];
+        }
+        id[LAYER1_TRANSACTION_ID_TEXT_SIZE - 1] = '\0';
+        snprintf(reference, sizeof(reference), "order-%06u", next_random() % 1000000);
+        snprintf(amount, sizeof(amount), "%u.%09u", next_random() % 10000, next_random() % 1000000000u);
+        snprintf(created_at, sizeof(created_at), "2025-03-%02uT%02u:%02u:%02u.%03uZ",
+                 1 + next_random() % 28, next_random() % 24, next_random() % 60,
+                 next_random() % 60, next_random() % 1000);
+
+        cJSON *transaction = cJSON_CreateObject();
+        cJSON_AddStringToObject(transaction, "id", id);
+        cJSON_AddStringToObject(transaction, "status", statuses[next_random() % 3]);
+        cJSON_AddStringToObject(transaction, "type", "deposit");
+        cJSON_AddStringToObject(transaction, "asset", "USDT");
+        cJSON_AddStringToObject(transaction, "amount", amount);
+        cJSON_AddStringToObject(transaction, "createdAt", created_at);
+        cJSON *address = cJSON_AddObjectToObject(transaction, "address");
+        cJSON_AddStringToObject(address, "reference", reference);
+        cJSON_AddStringToObject(address, "network", networks[next_random() % 4]);
+        cJSON_AddStringToObject(address, "address", "0x64c0a1f7b2e9d3c8");
+        cJSON *extra = cJSON_AddObjectToObject(transaction, "extra");
+        cJSON_AddNumberToObject(extra, "confirmations", next_random() % 64);
+        cJSON_AddNullToObject(extra, "memo");
+        cJSON_AddItemToArray(content, transaction);
+    }
+    cJSON_AddNumberToObject(page, "pageNumber", 0);
+    cJSON_AddNumberToObject(page, "pageSize", rows);
+    cJSON_AddNumberToObject(page, "totalElements", rows);
+    char *text = cJSON_PrintUnformatted(page);
+    cJSON_Delete(page);
+    return text;
+}
+
+static char *copy_string(const cJSON *object, const char *name) {
+    const cJSON *item = object ? cJSON_GetObjectItemCaseSensitive(object, name) : NULL;
+    return cJSON_IsString(item) ? strdup(item->valuestring) : NULL;
+}
+
+// Build the whole tree, then copy each field out of it
+static TransactionListResponse *decode_with_cjson(const char *json, size_t length) {
+    cJSON *root = cJSON_ParseWithLength(json, length);
+    cJSON *content = cJSON_GetObjectItemCaseSensitive(root, "content");
+    if (!cJSON_IsArray(content)) {
+        cJSON_Delete(root);
+        return NULL;
+    }
+
+    TransactionListResponse *response = calloc(1, sizeof(TransactionListResponse));
+    int count = cJSON_GetArraySize(content);
+    response->transactions = calloc((size_t)(count > 0 ? count : 1), sizeof(Transaction));
+    const cJSON *item;
+    cJSON_ArrayForEach(item, content) {
+        Transaction *transaction = &response->transactions[response->count++];
+        const cJSON *address = cJSON_GetObjectItemCaseSensitive(item, "address");
+        transaction->id = copy_string(item, "id");
+        transaction->status = copy_string(item, "status");
+        transaction->asset = copy_string(item, "asset");
+        transaction->amount = copy_string(item, "amount");
+        transaction->createdAt = copy_string(item, "createdAt");
+        transaction->reference = copy_string(address, "reference");
+        transaction->network = copy_string(address, "network");
+        transaction->createdAtMs = LAYER1_TIME_NONE;
+    }
+    cJSON_Delete(root);
+    return response;
+}
+
+// The streaming decoder fed the body in pieces, as from a write callback
+static TransactionListResponse *decode_in_chunks(const char *json, size_t length) {
+    TransactionListResponse *response = calloc(1, sizeof(TransactionListResponse));
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_TRANSACTION, true, collect_transaction_record, response);
+    bool ok = true;
+    for (size_t offset = 0; ok && offset < length; offset += CHUNK_SIZE) {
+        size_t piece = length - offset < CHUNK_SIZE ? length - offset : CHUNK_SIZE;
+        ok = response_decoder_feed(&decoder, json + offset, piece);
+    }
+    ok = ok && response_decoder_finish(&decoder);
+    response_decoder_free(&decoder);
+    if (!ok) {
+        layer1_free_transaction_list_response(response);
+        return NULL;
+    }
+    return response;
+}
+
+static bool same_string(const char *a, const char *b) {
+    return (!a && !b) || (a && b && strcmp(a, b) == 0);
+}
+
+static bool same_records(const TransactionListResponse *a, const TransactionListResponse *b) {
+    if (!a || !b || a->count != b->count) {
+        return false;
+    }
+    for (int i = 0; i < a->count; i++) {
+        const Transaction *x = &a->transactions[i];
+        const Transaction *y = &b->transactions[i];
+        if (!same_string(x->id, y->id) || !same_string(x->status, y->status) ||
+            !same_string(x->network, y->network) || !same_string(x->asset, y->asset) ||
+            !same_string(x->reference, y->reference) || !same_string(x->createdAt, y->createdAt) ||
+            !same_string(x->amount, y->amount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decodes per second of json, best of three runs
+static double measure(DecodeFunction decode, const char *json, size_t length) {
+    double best = 0.0;
+    for (int run = 0; run < 3; run++) {
+        long decodes = 0;
+        double start = now_seconds();
+        double elapsed;
+        do {
+            layer1_free_transaction_list_response(decode(json, length));
+            decodes++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < SECONDS);
+
+        double rate = (double)decodes / elapsed;
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 1000;
+    if (rows <= 0) {
+        fprintf(stderr, "Usage: %s [rows per page]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char *json = generate_page(rows);
+    if (!json) {
+        fprintf(stderr, "Error: Could not generate the page\n");
+        return EXIT_FAILURE;
+    }
+    size_t length = strlen(json);
+
+    static const struct {
+        const char *name;
+        DecodeFunction decode;
+    } paths[] = {
+        { "cjson-dom", decode_with_cjson },
+        { "stream-whole", decode_transaction_list_response },
+        { "stream-16k-chunks", decode_in_chunks },
+    };
+    int count = (int)(sizeof(paths) / sizeof(paths[0]));
+
+    TransactionListResponse *reference = decode_with_cjson(json, length);
+    bool ok = reference && reference->count == rows;
+    for (int i = 1; ok && i < count; i++) {
+        TransactionListResponse *decoded = paths[i].decode(json, length);
+        if (!same_records(reference, decoded)) {
+            fprintf(stderr, "Error: %s does not match %s\n", paths[i].name, paths[0].name);
+            ok = false;
+        }
+        layer1_free_transaction_list_response(decoded);
+    }
+    layer1_free_transaction_list_response(reference);
+
+    if (ok) {
+        printf("%d transactions, %zu bytes; all paths decode identical records\n", rows, length);
+        double baseline = 0.0;
+        for (int i = 0; i < count; i++) {
+            double rate = measure(paths[i].decode, json, length);
+            if (i == 0) {
+                baseline = rate;
+            }
+            printf("%-18s %9.1f MB/s %10.0f rows/ms %6.2fx\n", paths[i].name,
+                   rate * (double)length / 1e6, rate * rows / 1e3, rate / baseline);
+        }
+    }
+
+    free(json);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
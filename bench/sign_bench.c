@@ -0,0 +1,130 @@
+// Request signing rate per algorithm on one core. With no arguments it
+// generates an RSA-2048, an ECDSA P-256 and an Ed25519 key in memory; given
+// PEM key files it measures those instead. Each key goes through
+// http_signer_create, so the algorithm is the one the client would pick.
+//
+// Two rates are reported per key: bare signatures over a fixed signature
+// base, and whole GET requests signed with http_signer_add_headers_with_ctx,
+// which adds building the base, the parameters and the headers.
+//
+// Usage: sign_bench [key.pem ...]
+
+#include "http_signer.h"
+#include "layer1_client.h"
+#include <openssl/bio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SECONDS 1.0             // Per measurement
+
+static const char bench_url[] =
+    "https://api.layer1.com/digital/v1/transactions?assetPoolId=0195bb81-4a56-7916-aae8-109f276eb8fd"
+    "&q=reference:order-000123+type:(deposit+withdrawal)";
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// PEM text of a fresh key of the given type, e.g. "RSA"/2048 or "EC"/"P-256"
+static char *generate_key_pem(const char *type, EVP_PKEY *key) {
+    if (!key) {
+        fprintf(stderr, "Error: Could not generate a %s key\n", type);
+        return NULL;
+    }
+
+    char *pem = NULL;
+    BIO *bio = BIO_new(BIO_s_mem());
+    if (bio && PEM_write_bio_PrivateKey(bio, key, NULL, NULL, 0, NULL, NULL)) {
+        char *data;
+        long length = BIO_get_mem_data(bio, &data);
+        pem = malloc((size_t)length + 1);
+        if (pem) {
+            memcpy(pem, data, (size_t)length);
+            pem[length] = '\0';
+        }
+    }
+    BIO_free(bio);
+    EVP_PKEY_free(key);
+    return pem;
+}
+
+static bool bench_signer(const char *label, const char *pem) {
+    HttpSigner *signer = pem ? http_signer_create(pem, "bench-client") : NULL;
+    EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+    if (!signer || !md_ctx) {
+        fprintf(stderr, "Error: Could not load the %s key\n", label);
+        http_signer_destroy(signer);
+        EVP_MD_CTX_free(md_ctx);
+        return false;
+    }
+
+    char *params = create_signature_parameters(signer->client_id, NULL, signer->algorithm);
+    char base[1024];
+    snprintf(base, sizeof(base), "\"@method\": GET\n\"@target-uri\": %s\n\"@signature-params\": %s",
+             bench_url, params ? params : "");
+    free(params);
+
+    bool ok = true;
+    long signatures = 0;
+    double start = now_seconds();
+    double elapsed;
+    do {
+        char *signature = sign_request_with_ctx(md_ctx, signer->signing_key, signer->algorithm, base);
+        ok = ok && signature != NULL;
+        free(signature);
+        signatures++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < SECONDS);
+    double signature_rate = (double)signatures / elapsed;
+
+    long requests = 0;
+    start = now_seconds();
+    do {
+        struct curl_slist *headers = NULL;
+        ok = ok && http_signer_add_headers_with_ctx(signer, md_ctx, bench_url, NULL, "GET", &headers);
+        curl_slist_free_all(headers);
+        requests++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < SECONDS);
+    double request_rate = (double)requests / elapsed;
+
+    if (ok) {
+        printf("%-16s %-20s %10.0f sig/s %10.0f req/s\n", label,
+               signature_algorithm_name(signer->algorithm), signature_rate, request_rate);
+    } else {
+        fprintf(stderr, "Error: Signing failed with the %s key\n", label);
+    }
+
+    EVP_MD_CTX_free(md_ctx);
+    http_signer_destroy(signer);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    bool ok = true;
+    printf("%-16s %-20s %16s %16s\n", "key", "algorithm", "signatures", "GET requests");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            char *pem = read_file_to_string(argv[i]);
+            ok = bench_signer(argv[i], pem) && ok;
+            free(pem);
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    char *rsa = generate_key_pem("RSA", EVP_PKEY_Q_keygen(NULL, NULL, "RSA", (size_t)2048));
+    char *ec = generate_key_pem("EC", EVP_PKEY_Q_keygen(NULL, NULL, "EC", "P-256"));
+    char *ed = generate_key_pem("Ed25519", EVP_PKEY_Q_keygen(NULL, NULL, "ED25519"));
+    ok = bench_signer("rsa-2048", rsa) && ok;
+    ok = bench_signer("ecdsa-p256", ec) && ok;
+    ok = bench_signer("ed25519", ed) && ok;
+    free(rsa);
+    free(ec);
+    free(ed);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,10 @@
+#ifndef BULK_CREATE_ADDRESS_BY_ASSET_H
+#define BULK_CREATE_ADDRESS_BY_ASSET_H
+
+#include "layer1_client.h"
+
+void register_bulk_create_address_by_asset_command(void);
+bool execute_bulk_create_address_by_asset_command(Layer1Client *client, int argc, char **argv);
+void bulk_create_address_by_asset_help(void);
+
+#endif /* BULK_CREATE_ADDRESS_BY_ASSET_H */
@@ -0,0 +1,10 @@
+#ifndef RECONCILE_H
+#define RECONCILE_H
+
+#include "layer1_client.h"
+
+void register_reconcile_command(void);
+bool execute_reconcile_command(Layer1Client *client, int argc, char **argv);
+void reconcile_help(void);
+
+#endif /* RECONCILE_H */
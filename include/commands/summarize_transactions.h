@@ -0,0 +1,10 @@
+#ifndef SUMMARIZE_TRANSACTIONS_H
+#define SUMMARIZE_TRANSACTIONS_H
+
+#include "layer1_client.h"
+
+void register_summarize_transactions_command(void);
+bool execute_summarize_transactions_command(Layer1Client *client, int argc, char **argv);
+void summarize_transactions_help(void);
+
+#endif /* SUMMARIZE_TRANSACTIONS_H */
@@ -7,26 +7,50 @@
 #include <curl/curl.h>
 #include <stdbool.h>
 
+// Signature algorithms supported by the signer, detected from the loaded key
+typedef enum {
+    SIGNATURE_ALG_RSA_V1_5_SHA256,
+    SIGNATURE_ALG_ECDSA_P256_SHA256,
+    SIGNATURE_ALG_ED25519
+} SignatureAlgorithm;
+
 typedef struct {
     EVP_PKEY *signing_key;
     char *client_id;
+    SignatureAlgorithm algorithm;
 } HttpSigner;
 
 // Initialize the HTTP signer with a private key and client ID
 HttpSigner *http_signer_create(const char *private_key, const char *client_id);
 
+// Create an independent copy of a signer with its own key object
+HttpSigner *http_signer_dup(const HttpSigner *signer);
+
 // Free resources used by the HTTP signer
 void http_signer_destroy(HttpSigner *signer);
 
 // Add authentication headers to a CURL handle
-bool http_signer_add_headers(HttpSigner *signer, CURL *curl, const char *url, 
-                            const char *payload, const char *method, 
+bool http_signer_add_headers(HttpSigner *signer, CURL *curl, const char *url,
+                            const char *payload, const char *method,
                             struct curl_slist **headers);
 
+// Same as http_signer_add_headers, reusing a caller-owned signing context
+bool http_signer_add_headers_with_ctx(HttpSigner *signer, EVP_MD_CTX *md_ctx, const char *url,
+                                      const char *payload, const char *method,
+                                      struct curl_slist **headers);
+
+// Same as above for a body whose Content-Digest value was computed already
+bool http_signer_add_headers_for_digest(HttpSigner *signer, EVP_MD_CTX *md_ctx, const char *url,
+                                        const char *content_digest, const char *method,
+                                        struct curl_slist **headers);
+
 // Helper functions
+const char *signature_algorithm_name(SignatureAlgorithm algorithm);
 char *create_digest(const char *algorithm, const char *data);
-char *create_signature_parameters(const char *client_id, const char *content_digest);
-char *sign_request(EVP_PKEY *private_key, const char *signature_base);
+char *format_digest(const char *algorithm, const unsigned char *hash, size_t hash_len);
+char *create_signature_parameters(const char *client_id, const char *content_digest, SignatureAlgorithm algorithm);
+char *sign_request(EVP_PKEY *private_key, SignatureAlgorithm algorithm, const char *signature_base);
+char *sign_request_with_ctx(EVP_MD_CTX *md_ctx, EVP_PKEY *private_key, SignatureAlgorithm algorithm, const char *signature_base);
 char *prepare_key(const char *raw_key);
 
 #endif // HTTP_SIGNER_H
@@ -0,0 +1,78 @@
+#ifndef LAYER1_ASYNC_H
+#define LAYER1_ASYNC_H
+
+#include "layer1_client.h"
+
+// Event-driven front end to a Layer1Client for services that already run an
+// event loop (epoll, kqueue, libuv, ...). Nothing here blocks: the loop is
+// told which sockets and timeout to watch through the callbacks given to
+// layer1_async_create, and reports readiness back with
+// layer1_async_socket_action and layer1_async_timeout. Each request moves
+// through signing, transfer and decoding as those events arrive, and its
+// completion callback runs on the loop thread.
+//
+// A Layer1Async and every request on it belong to the thread driving the
+// loop. The underlying Layer1Client can still be used by other threads.
+
+typedef struct Layer1Async Layer1Async;
+
+// Start, change or stop watching fd. what is CURL_POLL_IN, CURL_POLL_OUT,
+// CURL_POLL_INOUT or CURL_POLL_REMOVE. socket_data is the pointer last
+// attached to fd with layer1_async_assign, NULL until then.
+typedef void (*Layer1SocketCallback)(Layer1Async *async, curl_socket_t fd, int what,
+                                     void *user_data, void *socket_data);
+
+// (Re)arm the single loop timer to call layer1_async_timeout after
+// timeout_ms. -1 disarms it, 0 asks for a call as soon as possible.
+typedef void (*Layer1TimerCallback)(Layer1Async *async, long timeout_ms, void *user_data);
+
+// Completion callbacks. The response is NULL when the request failed or was
+// cancelled, otherwise the callback owns it and frees it with the matching
+// layer1_free_* function.
+typedef void (*Layer1AddressCallback)(AddressResponse *response, void *user_data);
+typedef void (*Layer1AddressListCallback)(AddressListResponse *response, void *user_data);
+typedef void (*Layer1TransactionCallback)(TransactionResponse *response, void *user_data);
+typedef void (*Layer1TransactionListCallback)(TransactionListResponse *response, void *user_data);
+
+// Create an async front end for client, which must outlive it.
+// signing_workers > 0 moves request signing onto that many threads, whose
+// results are handed back through a pipe reported like any other socket;
+// 0 signs on the loop thread when a request is started.
+Layer1Async *layer1_async_create(Layer1Client *client, int signing_workers,
+                                 Layer1SocketCallback on_socket, Layer1TimerCallback on_timer,
+                                 void *user_data);
+
+// Cancel every unfinished request, calling its callback with NULL, and free
+// the front end. Must not be called from a completion callback.
+void layer1_async_destroy(Layer1Async *async);
+
+// Report activity on fd. events is a mask of CURL_CSELECT_IN, CURL_CSELECT_OUT
+// and CURL_CSELECT_ERR. Completion callbacks run from here.
+void layer1_async_socket_action(Layer1Async *async, curl_socket_t fd, int events);
+
+// Report that the timer armed through Layer1TimerCallback has expired
+void layer1_async_timeout(Layer1Async *async);
+
+// Attach a loop-side pointer to fd, passed back as socket_data
+bool layer1_async_assign(Layer1Async *async, curl_socket_t fd, void *socket_data);
+
+// Requests started and not yet completed
+int layer1_async_in_flight(Layer1Async *async);
+
+// Start a request. On false nothing was started and on_done will not be
+// called; otherwise on_done is called exactly once. Completion callbacks may
+// start further requests.
+bool layer1_async_create_address(Layer1Async *async, const char *asset_pool_id, const char *network,
+                                 const char *asset, const char *reference,
+                                 Layer1AddressCallback on_done, void *user_data);
+bool layer1_async_create_address_by_asset(Layer1Async *async, const char *asset_pool_id, const char *asset,
+                                          const char *reference, Layer1AddressCallback on_done, void *user_data);
+bool layer1_async_list_addresses(Layer1Async *async, const char *asset_pool_id, const char *reference,
+                                 Layer1AddressListCallback on_done, void *user_data);
+bool layer1_async_create_transaction(Layer1Async *async, const char *asset_pool_id, const char *network,
+                                     const char *asset, const char *to_address, const char *amount,
+                                     const char *reference, Layer1TransactionCallback on_done, void *user_data);
+bool layer1_async_list_transactions(Layer1Async *async, const char *asset_pool_id, const char *query,
+                                    Layer1TransactionListCallback on_done, void *user_data);
+
+#endif // LAYER1_ASYNC_H
@@ -0,0 +1,47 @@
+#ifndef REQUEST_BODY_H
+#define REQUEST_BODY_H
+
+#include <openssl/evp.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// JSON request body that is hashed for Content-Digest while it is written,
+// so the digest, the bytes and the length all come out of a single pass
+typedef struct RequestBody {
+    char *data;
+    size_t length;
+    size_t capacity;
+    size_t digested;                // Bytes already fed to the digest
+    EVP_MD_CTX *digest_ctx;
+    unsigned int depth;
+    unsigned int need_comma;        // One bit per nesting level
+    bool failed;
+} RequestBody;
+
+// Create an empty body with room for initial_capacity bytes
+RequestBody *request_body_create(size_t initial_capacity);
+
+// Free the body and its buffer
+void request_body_destroy(RequestBody *body);
+
+// Empty the body for the next request, keeping its buffer
+bool request_body_reset(RequestBody *body);
+
+// Append raw bytes
+void request_body_append(RequestBody *body, const char *data, size_t length);
+
+// Append value as a quoted, escaped JSON string
+void request_body_append_string(RequestBody *body, const char *value);
+
+// JSON writers, key is NULL for array elements and the top-level value.
+// NULL string values are skipped like cJSON_AddStringToObject does.
+void request_body_begin_object(RequestBody *body, const char *key);
+void request_body_end_object(RequestBody *body);
+void request_body_begin_array(RequestBody *body, const char *key);
+void request_body_end_array(RequestBody *body);
+void request_body_add_string(RequestBody *body, const char *key, const char *value);
+
+// Finish hashing and return the Content-Digest value (sha-256=:...:)
+char *request_body_finish_digest(RequestBody *body);
+
+#endif // REQUEST_BODY_H
@@ -0,0 +1,54 @@
+#ifndef SIGNING_POOL_H
+#define SIGNING_POOL_H
+
+#include "http_signer.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct SigningJob SigningJob;
+
+// Called on a worker thread once the job's signature headers are ready
+typedef void (*SigningJobCallback)(SigningJob *job, void *user_data);
+
+// A request waiting to be signed. The caller owns the job and every string it
+// points to until on_signed has been called.
+struct SigningJob {
+    const char *url;
+    const char *payload;
+    const char *content_digest;     // When set, used instead of hashing payload
+    const char *method;
+    struct curl_slist *headers;     // Signature headers are appended here
+    bool success;
+    SigningJobCallback on_signed;
+    void *user_data;
+
+    // Internal
+    _Atomic(SigningJob *) next;
+    uint64_t enqueued_ns;
+};
+
+typedef struct {
+    size_t queue_depth;             // Jobs submitted but not yet signed
+    uint64_t jobs_signed;
+    uint64_t jobs_failed;
+    double avg_wait_ms;             // Time between submit and a worker picking the job up
+    double max_wait_ms;
+} SigningPoolStats;
+
+typedef struct SigningPool SigningPool;
+
+// Start a pool of worker threads, each with its own copy of the signer's key
+SigningPool *signing_pool_create(const HttpSigner *signer, int worker_count);
+
+// Stop the workers after the queued jobs have been signed
+void signing_pool_destroy(SigningPool *pool);
+
+// Queue a job for signing; safe to call from any number of threads
+bool signing_pool_submit(SigningPool *pool, SigningJob *job);
+
+// Snapshot queue depth and wait time counters
+void signing_pool_get_stats(SigningPool *pool, SigningPoolStats *stats);
+
+#endif // SIGNING_POOL_H
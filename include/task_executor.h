@@ -0,0 +1,37 @@
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct TaskExecutor TaskExecutor;
+
+// A unit of work. Tasks may submit further tasks to the same executor.
+typedef void (*TaskFunction)(TaskExecutor *executor, void *arg);
+
+typedef struct {
+    uint64_t tasks_run;
+    uint64_t tasks_stolen;      // Tasks taken from another worker's deque
+    uint64_t tasks_delayed;     // Tasks that went through the timer queue
+} TaskExecutorStats;
+
+// Start worker_count threads, each with its own deque. Workers pop their own
+// newest task first and steal the oldest task of another worker when idle.
+// worker_count <= 0 uses the number of CPUs.
+TaskExecutor *task_executor_create(int worker_count);
+
+// Wait for every queued, delayed and running task, then stop the workers
+void task_executor_destroy(TaskExecutor *executor);
+
+// Queue a task. From a worker it goes onto that worker's own deque.
+bool task_executor_submit(TaskExecutor *executor, TaskFunction function, void *arg);
+
+// Queue a task to run once delay_ms has passed, without occupying a worker
+bool task_executor_submit_after(TaskExecutor *executor, unsigned int delay_ms, TaskFunction function, void *arg);
+
+// Block until no task is queued, delayed or running
+void task_executor_wait(TaskExecutor *executor);
+
+void task_executor_get_stats(TaskExecutor *executor, TaskExecutorStats *stats);
+
+#endif // TASK_EXECUTOR_H
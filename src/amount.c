@@ -0,0 +1,202 @@
+#include "amount.h"
+#include <stdint.h>
+#include <string.h>
+
+__extension__ typedef unsigned __int128 AmountMagnitude;
+
+static const struct {
+    const char *asset;
+    int scale;
+} asset_scales[] = {
+    { "BTC", 8 },
+    { "WBTC", 8 },
+    { "LTC", 8 },
+    { "DOGE", 8 },
+    { "SOL", 9 },
+    { "USDC", 6 },
+    { "USDT", 6 },
+    { "EURC", 6 },
+    { "PYUSD", 6 },
+    { "TRX", 6 },
+    { "XRP", 6 },
+    { "ETH", 18 },
+    { "DAI", 18 },
+    { "POL", 18 },
+    { "BNB", 18 },
+    { "AVAX", 18 }
+};
+
+int amount_scale_for_asset(const char *asset) {
+    if (!asset) {
+        return AMOUNT_DEFAULT_SCALE;
+    }
+
+    for (size_t i = 0; i < sizeof(asset_scales) / sizeof(asset_scales[0]); i++) {
+        if (strcmp(asset_scales[i].asset, asset) == 0) {
+            return asset_scales[i].scale;
+        }
+    }
+    return AMOUNT_DEFAULT_SCALE;
+}
+
+static const uint64_t powers_of_ten[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+    100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+    10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+    100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+#define MAGNITUDE_MAX (~(AmountMagnitude)0 >> 1)
+
+// value = value * 10^digits + addend, false on overflow
+static bool shift_in(AmountMagnitude *value, int digits, uint64_t addend) {
+    AmountMagnitude scale = powers_of_ten[digits];
+    if (*value > (MAGNITUDE_MAX - addend) / scale) {
+        return false;
+    }
+    *value = *value * scale + addend;
+    return true;
+}
+
+// Convert 8 ASCII digits with one multiply-and-shift per halving of the
+// width, after checking all eight are digits. Little-endian loads only.
+static bool parse_eight_digits(const char *p, uint64_t *value) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+
+    // Every byte in '0'..'9': high nibble 3 before and after adding 6
+    if ((((chunk & 0xF0F0F0F0F0F0F0F0ull) >> 4) |
+         ((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull)) != 0x3333333333333333ull) {
+        return false;
+    }
+
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    *value = chunk & 0xFFFFFFFFull;
+    return true;
+#else
+    uint64_t result = 0;
+    for (int i = 0; i < 8; i++) {
+        if (p[i] < '0' || p[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (uint64_t)(p[i] - '0');
+    }
+    *value = result;
+    return true;
+#endif
+}
+
+// Append the digits in [p, end) to value, eight at a time where possible
+static bool shift_in_digits(AmountMagnitude *value, const char *p, const char *end) {
+    while (end - p >= 8) {
+        uint64_t chunk;
+        if (!parse_eight_digits(p, &chunk) || !shift_in(value, 8, chunk)) {
+            return false;
+        }
+        p += 8;
+    }
+
+    uint64_t tail = 0;
+    int digits = (int)(end - p);
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        tail = tail * 10 + (uint64_t)(*p - '0');
+    }
+    return digits == 0 || shift_in(value, digits, tail);
+}
+
+bool amount_parse(const char *text, size_t length, int scale, AmountUnits *units) {
+    if (!text || scale < 0 || scale > 36) {
+        return false;
+    }
+
+    const char *p = text;
+    const char *end = text + length;
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        p++;
+    }
+
+    const char *point = memchr(p, '.', (size_t)(end - p));
+    const char *integer_end = point ? point : end;
+    const char *fraction = point ? point + 1 : end;
+    if (integer_end == p || (point && fraction == end)) {
+        return false;
+    }
+
+    // Fraction digits past the scale must all be zero
+    const char *fraction_end = end;
+    if (end - fraction > scale) {
+        fraction_end = fraction + scale;
+        for (const char *q = fraction_end; q < end; q++) {
+            if (*q != '0') {
+                return false;
+            }
+        }
+    }
+
+    AmountMagnitude magnitude = 0;
+    if (!shift_in_digits(&magnitude, p, integer_end) ||
+        !shift_in_digits(&magnitude, fraction, fraction_end)) {
+        return false;
+    }
+
+    // Pad the fraction out to the scale
+    for (int missing = scale - (int)(fraction_end - fraction); missing > 0; missing -= 19) {
+        if (!shift_in(&magnitude, missing < 19 ? missing : 19, 0)) {
+            return false;
+        }
+    }
+
+    *units = negative ? -(AmountUnits)magnitude : (AmountUnits)magnitude;
+    return true;
+}
+
+size_t amount_format(AmountUnits units, int scale, char *out) {
+    AmountMagnitude magnitude = units < 0 ? -(AmountMagnitude)units : (AmountMagnitude)units;
+
+    // Digits from the right, 19 at a time so the divisions stay 64-bit where possible
+    char digits[AMOUNT_FORMAT_SIZE];
+    int count = 0;
+    do {
+        uint64_t part = (uint64_t)(magnitude % powers_of_ten[19]);
+        magnitude /= powers_of_ten[19];
+        for (int i = 0; i < 19 && (part > 0 || magnitude > 0); i++) {
+            digits[count++] = (char)('0' + part % 10);
+            part /= 10;
+        }
+    } while (magnitude > 0);
+
+    // At least one integer digit
+    while (count <= scale) {
+        digits[count++] = '0';
+    }
+
+    // Trailing zeros of the fraction are dropped, and with them the point
+    int fraction_start = 0;
+    while (fraction_start < scale && digits[fraction_start] == '0') {
+        fraction_start++;
+    }
+
+    size_t length = 0;
+    if (units < 0) {
+        out[length++] = '-';
+    }
+    for (int i = count - 1; i >= scale; i--) {
+        out[length++] = digits[i];
+    }
+    if (fraction_start < scale) {
+        out[length++] = '.';
+        for (int i = scale - 1; i >= fraction_start; i--) {
+            out[length++] = digits[i];
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
@@ -0,0 +1,27 @@
+#ifndef AMOUNT_H
+#define AMOUNT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Exact decimal amounts as signed 128-bit counts of an asset's smallest
+// unit: "0.020126058226553" ETH at 18 decimals is 20126058226553000 units.
+// Sums of units never lose precision the way doubles do.
+__extension__ typedef __int128 AmountUnits;
+
+#define AMOUNT_DEFAULT_SCALE 18     // Decimals assumed for assets not in the table
+#define AMOUNT_FORMAT_SIZE 48       // Enough for any AmountUnits with its sign and point
+
+// Decimals of an asset's smallest unit (USDC 6, BTC 8, ETH 18, ...)
+int amount_scale_for_asset(const char *asset);
+
+// Parse a plain decimal such as "12", "-0.5" or "0.020126058226553" into
+// units at scale decimals. Fails on anything else, on overflow, and on
+// non-zero digits beyond scale, so a parsed amount is always exact.
+bool amount_parse(const char *text, size_t length, int scale, AmountUnits *units);
+
+// Write units back as a decimal with trailing fraction zeros trimmed;
+// returns the length, out must hold AMOUNT_FORMAT_SIZE bytes
+size_t amount_format(AmountUnits units, int scale, char *out);
+
+#endif // AMOUNT_H
@@ -1,7 +1,17 @@
 #include "arg_parser.h"
+#include "string_hash.h"
 #include <stdlib.h>
 #include <string.h>
 
+// Slot holding name, or the empty slot where it would go
+static int *find_slot(CommandArgs *args, const char *name) {
+    size_t slot = (size_t)string_hash(name) & args->index_mask;
+    while (args->index[slot] && strcmp(args->args[args->index[slot] - 1].name, name) != 0) {
+        slot = (slot + 1) & args->index_mask;
+    }
+    return &args->index[slot];
+}
+
 CommandArgs *parse_command_args(int argc, char **argv) {
     CommandArgs *args = malloc(sizeof(CommandArgs));
     if (!args) return NULL;
@@ -19,8 +29,8 @@ CommandArgs *parse_command_args(int argc, char **argv) {
             // This is a named argument
             const char *name = argv[i] + 2;  // Skip the '--'
             
-            // Check if there's a value following
-            if (i + 1 < argc && argv[i + 1][0] != '-') {
+            // Check if there's a value following; a lone "-" is a value (stdin)
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || strcmp(argv[i + 1], "-") == 0)) {
                 args->args[args->count].name = name;
                 args->args[args->count].value = argv[i + 1];
                 args->count++;
@@ -29,23 +39,40 @@ CommandArgs *parse_command_args(int argc, char **argv) {
         }
     }
 
+    // Index the names once so every lookup is a single probe sequence
+    size_t slots = 8;
+    while (slots < (size_t)args->count * 2) {
+        slots *= 2;
+    }
+    args->index = calloc(slots, sizeof(int));
+    if (!args->index) {
+        free(args->args);
+        free(args);
+        return NULL;
+    }
+    args->index_mask = slots - 1;
+
+    for (int i = 0; i < args->count; i++) {
+        int *slot = find_slot(args, args->args[i].name);
+        // The first occurrence of a repeated name wins, as before
+        if (*slot == 0) {
+            *slot = i + 1;
+        }
+    }
+
     return args;
 }
 
 const char *get_arg_value(CommandArgs *args, const char *name) {
     if (!args || !name) return NULL;
 
-    for (int i = 0; i < args->count; i++) {
-        if (strcmp(args->args[i].name, name) == 0) {
-            return args->args[i].value;
-        }
-    }
-
-    return NULL;
+    int position = *find_slot(args, name);
+    return position ? args->args[position - 1].value : NULL;
 }
 
 void free_command_args(CommandArgs *args) {
     if (!args) return;
+    free(args->index);
     free(args->args);
     free(args);
 } 
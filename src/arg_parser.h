@@ -2,6 +2,7 @@
 #define ARG_PARSER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef struct {
     const char *name;
@@ -11,9 +12,14 @@ typedef struct {
 typedef struct {
     CommandArg *args;
     int count;
+    int *index;                 // Open-addressed by name: position in args + 1, 0 when empty
+    size_t index_mask;
 } CommandArgs;
 
+// Collect the --name value pairs and index them by name
 CommandArgs *parse_command_args(int argc, char **argv);
+
+// Value of the first --name, NULL when absent
 const char *get_arg_value(CommandArgs *args, const char *name);
 void free_command_args(CommandArgs *args);
 
@@ -0,0 +1,227 @@
+#include "batch.h"
+#include "output.h"
+#include "cJSON.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef struct {
+    char **argv;
+    int argc;
+    int capacity;
+    char *storage;              // Owns the strings argv points into, when tokenized in place
+} BatchArgs;
+
+static bool push_arg(BatchArgs *args, char *value) {
+    if (args->argc == args->capacity) {
+        int capacity = args->capacity ? args->capacity * 2 : 16;
+        char **argv = realloc(args->argv, sizeof(char *) * capacity);
+        if (!argv) {
+            return false;
+        }
+        args->argv = argv;
+        args->capacity = capacity;
+    }
+    args->argv[args->argc++] = value;
+    return true;
+}
+
+static void free_batch_args(BatchArgs *args, bool owns_values) {
+    if (owns_values) {
+        for (int i = 0; i < args->argc; i++) {
+            free(args->argv[i]);
+        }
+    }
+    free(args->argv);
+    free(args->storage);
+}
+
+// Split a command line in place on whitespace. Single quotes keep everything
+// literally, double quotes allow \" and \\ escapes.
+static bool tokenize_line(char *line, BatchArgs *args) {
+    char *in = line;
+    while (*in) {
+        while (isspace((unsigned char)*in)) {
+            in++;
+        }
+        if (!*in) {
+            break;
+        }
+
+        char *out = in;
+        char *token = out;
+        char quote = 0;
+        while (*in && (quote || !isspace((unsigned char)*in))) {
+            char c = *in++;
+            if (quote == 0 && (c == '\'' || c == '"')) {
+                quote = c;
+            } else if (c == quote) {
+                quote = 0;
+            } else if (quote == '"' && c == '\\' && (*in == '"' || *in == '\\')) {
+                *out++ = *in++;
+            } else {
+                *out++ = c;
+            }
+        }
+        if (quote) {
+            fprintf(stderr, "Error: Unterminated quote\n");
+            return false;
+        }
+
+        bool more = *in != '\0';
+        *out = '\0';
+        if (more) {
+            in++;
+        }
+        if (!push_arg(args, token)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// {"command": "...", "<name>": "value", ...} becomes command --name value ...
+static bool json_to_args(const char *line, BatchArgs *args) {
+    cJSON *object = cJSON_Parse(line);
+    if (!cJSON_IsObject(object)) {
+        fprintf(stderr, "Error: Invalid JSON command\n");
+        cJSON_Delete(object);
+        return false;
+    }
+
+    cJSON *command = cJSON_GetObjectItemCaseSensitive(object, "command");
+    bool ok = cJSON_IsString(command);
+    if (!ok) {
+        fprintf(stderr, "Error: JSON command needs a \"command\" string\n");
+    } else {
+        char *value = strdup(command->valuestring);
+        ok = value && push_arg(args, value);
+        if (!ok) {
+            free(value);
+        }
+    }
+
+    cJSON *item;
+    cJSON_ArrayForEach(item, object) {
+        if (!ok || item == command) {
+            continue;
+        }
+
+        // Values are passed through as written, so numbers such as amounts
+        // must be quoted rather than round-tripped through a double
+        if (!cJSON_IsString(item)) {
+            fprintf(stderr, "Error: Argument %s must be a string\n", item->string);
+            ok = false;
+            continue;
+        }
+
+        size_t name_length = strlen(item->string) + 3;
+        char *name = malloc(name_length);
+        if (name) {
+            snprintf(name, name_length, "--%s", item->string);
+        }
+        ok = name && push_arg(args, name);
+        if (!ok) {
+            free(name);
+            continue;
+        }
+        char *value = strdup(item->valuestring);
+        ok = value && push_arg(args, value);
+        if (!ok) {
+            free(value);
+        }
+    }
+
+    cJSON_Delete(object);
+    return ok;
+}
+
+static bool run_line(Layer1Client *client, char *line, const char **command_name) {
+    BatchArgs args = {0};
+    bool ok;
+
+    // JSON arguments are copied out of the parsed object, command lines are split in place
+    bool json_args = line[0] == '{';
+    if (json_args) {
+        ok = json_to_args(line, &args);
+    } else {
+        args.storage = strdup(line);
+        ok = args.storage && tokenize_line(args.storage, &args);
+    }
+
+    Command *command = NULL;
+    if (ok && args.argc > 0) {
+        command = get_command(args.argv[0]);
+        *command_name = command ? command->name : NULL;
+        if (!command) {
+            fprintf(stderr, "Error: Unknown command '%s'\n", args.argv[0]);
+        }
+    }
+
+    ok = command != NULL;
+    if (ok && args.argc > 1 && strcmp(args.argv[1], "--help") == 0) {
+        command->help();
+    } else if (ok && output_format() == OUTPUT_RAW && !command->raw_output) {
+        fprintf(stderr, "Error: --raw is not supported by %s\n", command->name);
+        ok = false;
+    } else if (ok) {
+        ok = command->execute(client, args.argc, args.argv);
+    }
+
+    free_batch_args(&args, json_args);
+    return ok;
+}
+
+static const char *const result_columns[] = { "line", "command", "ok" };
+static const OutputSchema result_schema = { result_columns, 3 };
+
+bool run_command_batch(Layer1Client *client, FILE *input) {
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t length;
+    long line_number = 0;
+    bool all_ok = true;
+
+    while ((length = getline(&line, &line_capacity, input)) != -1) {
+        line_number++;
+
+        // Trim the line ending and surrounding blanks
+        while (length > 0 && isspace((unsigned char)line[length - 1])) {
+            line[--length] = '\0';
+        }
+        char *start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+
+        const char *command_name = NULL;
+        bool ok = run_line(client, start, &command_name);
+        all_ok = all_ok && ok;
+
+        // The record follows the command's own output, so flush both together
+        if (output_format() == OUTPUT_TEXT) {
+            printf("{\"line\":%ld,\"command\":", line_number);
+            if (command_name) {
+                printf("\"%s\"", command_name);
+            } else {
+                printf("null");
+            }
+            printf(",\"ok\":%s}\n", ok ? "true" : "false");
+        } else {
+            char line_text[24];
+            snprintf(line_text, sizeof(line_text), "%ld", line_number);
+            output_begin_record(&result_schema);
+            output_literal(line_text);
+            output_string(command_name);
+            output_literal(ok ? "true" : "false");
+            output_end_record();
+        }
+        output_flush();
+    }
+
+    free(line);
+    return all_ok;
+}
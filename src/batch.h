@@ -0,0 +1,18 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "layer1_client.h"
+#include <stdio.h>
+
+// Run one command per input line through a single client, in order. A line
+// is either a command line as it would follow the global options
+// (create-address --asset-pool-id p1 ...) or a JSON object naming the
+// command and its arguments ({"command": "create-address", "asset-pool-id":
+// "p1", ...}). Blank lines and lines starting with # are skipped. After each
+// command a result record is written to stdout:
+//   {"line":3,"command":"create-address","ok":true}
+// With a machine-readable --format the record goes through the output
+// writer like any other. Returns true when every command succeeded.
+bool run_command_batch(Layer1Client *client, FILE *input);
+
+#endif // BATCH_H
@@ -0,0 +1,161 @@
+#include "layer1_client.h"
+#include <string.h>
+
+// Define LAYER1_NO_SIMD to force the scalar decoder
+#if defined(__SSE2__) && !defined(LAYER1_NO_SIMD)
+#define BINARY_ID_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static const char hex_digits[] = "0123456789abcdef";
+
+// Value of one hex digit, or 0xFF. Uppercase letters count only with fold_case.
+static inline uint8_t hex_value(unsigned char c, bool fold_case) {
+    if ((unsigned)(c - '0') < 10) {
+        return (uint8_t)(c - '0');
+    }
+    if (fold_case) {
+        c |= 0x20;
+    }
+    if ((unsigned)(c - 'a') < 6) {
+        return (uint8_t)(c - 'a' + 10);
+    }
+    return 0xFF;
+}
+
+#if defined(BINARY_ID_SSE2)
+// Decode 16 hex digits into 8 bytes; false if any character is not a digit.
+// Characters of 0x80 and up compare as negative and fail both range checks.
+static inline bool decode_hex16(const char *text, uint8_t *out, bool fold_case) {
+    __m128i chars = _mm_loadu_si128((const __m128i *)text);
+    __m128i folded = fold_case ? _mm_or_si128(chars, _mm_set1_epi8(0x20)) : chars;
+
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                     _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(folded, _mm_set1_epi8('f' + 1)));
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+        return false;
+    }
+
+    __m128i nibbles = _mm_or_si128(
+        _mm_and_si128(is_digit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))),
+        _mm_andnot_si128(is_digit, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10))));
+
+    // Each 16-bit lane holds the high nibble in its low byte and the low
+    // nibble in its high byte; combine them and pack the lanes to bytes
+    __m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+    __m128i low = _mm_srli_epi16(nibbles, 8);
+    _mm_storel_epi64((__m128i *)out, _mm_packus_epi16(_mm_or_si128(high, low), _mm_setzero_si128()));
+    return true;
+}
+#endif
+
+// Decode length hex digits (even) into length / 2 bytes
+static bool decode_hex(const char *text, size_t length, uint8_t *out, bool fold_case) {
+    size_t i = 0;
+#if defined(BINARY_ID_SSE2)
+    if (length >= 16) {
+        for (; i + 16 <= length; i += 16) {
+            if (!decode_hex16(text + i, out + i / 2, fold_case)) {
+                return false;
+            }
+        }
+        // Finish with one block that overlaps bytes already written
+        if (i < length) {
+            return decode_hex16(text + length - 16, out + (length - 16) / 2, fold_case);
+        }
+        return true;
+    }
+#endif
+    unsigned bad = 0;
+    for (; i < length; i += 2) {
+        uint8_t high = hex_value((unsigned char)text[i], fold_case);
+        uint8_t low = hex_value((unsigned char)text[i + 1], fold_case);
+        bad |= (high | low) & 0xF0;
+        out[i / 2] = (uint8_t)(high << 4 | low);
+    }
+    return bad == 0;
+}
+
+static void encode_hex(const uint8_t *bytes, size_t count, char *out) {
+    for (size_t i = 0; i < count; i++) {
+        out[2 * i] = hex_digits[bytes[i] >> 4];
+        out[2 * i + 1] = hex_digits[bytes[i] & 0x0F];
+    }
+}
+
+bool layer1_uuid_parse(const char *text, size_t length, Layer1Uuid *id) {
+    // 8-4-4-4-12 digits; gather them without the dashes, then decode at once
+    if (length != LAYER1_UUID_TEXT_SIZE - 1 ||
+        text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-') {
+        return false;
+    }
+
+    char digits[32];
+    memcpy(digits, text, 8);
+    memcpy(digits + 8, text + 9, 4);
+    memcpy(digits + 12, text + 14, 4);
+    memcpy(digits + 16, text + 19, 4);
+    memcpy(digits + 20, text + 24, 12);
+    return decode_hex(digits, sizeof(digits), id->bytes, true);
+}
+
+void layer1_uuid_format(const Layer1Uuid *id, char out[LAYER1_UUID_TEXT_SIZE]) {
+    encode_hex(id->bytes, 4, out);
+    out[8] = '-';
+    encode_hex(id->bytes + 4, 2, out + 9);
+    out[13] = '-';
+    encode_hex(id->bytes + 6, 2, out + 14);
+    out[18] = '-';
+    encode_hex(id->bytes + 8, 2, out + 19);
+    out[23] = '-';
+    encode_hex(id->bytes + 10, 6, out + 24);
+    out[36] = '\0';
+}
+
+bool layer1_transaction_id_parse(const char *text, size_t length, Layer1TransactionId *id) {
+    if (length != LAYER1_TRANSACTION_ID_TEXT_SIZE - 1) {
+        return false;
+    }
+    return decode_hex(text, length, id->bytes, true);
+}
+
+bool layer1_transaction_id_parse_canonical(const char *text, size_t length, Layer1TransactionId *id) {
+    if (length != LAYER1_TRANSACTION_ID_TEXT_SIZE - 1) {
+        return false;
+    }
+    return decode_hex(text, length, id->bytes, false);
+}
+
+void layer1_transaction_id_format(const Layer1TransactionId *id, char out[LAYER1_TRANSACTION_ID_TEXT_SIZE]) {
+    encode_hex(id->bytes, sizeof(id->bytes), out);
+    out[LAYER1_TRANSACTION_ID_TEXT_SIZE - 1] = '\0';
+}
+
+// Ids share long time-ordered prefixes, so every word goes into the hash
+static uint64_t hash_words(const uint8_t *bytes, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    }
+    if (i < length) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, length - i);
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    }
+    return hash;
+}
+
+uint64_t layer1_uuid_hash(const Layer1Uuid *id) {
+    return hash_words(id->bytes, sizeof(id->bytes));
+}
+
+uint64_t layer1_transaction_id_hash(const Layer1TransactionId *id) {
+    return hash_words(id->bytes, sizeof(id->bytes));
+}
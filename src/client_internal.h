@@ -0,0 +1,38 @@
+#ifndef CLIENT_INTERNAL_H
+#define CLIENT_INTERNAL_H
+
+#include "layer1_client.h"
+#include "handle_pool.h"
+#include "request_body.h"
+
+// Request plumbing shared by the blocking API in layer1_client.c and the
+// event-driven API in layer1_async.c. Not part of the public interface.
+
+// Ask for compressed responses when the client was configured to
+void layer1_apply_compression(Layer1Client *client, CURL *curl);
+
+// Publish the size of a finished transfer to last_transfer and the observer
+void layer1_record_transfer(Layer1Client *client, CURL *curl, const char *method, const char *url,
+                            size_t decoded_bytes);
+
+// Return a handle to the client's pool, trimming an oversized response buffer
+void layer1_release_handle(Layer1Client *client, PooledHandle *handle);
+
+struct curl_slist *layer1_add_common_headers(struct curl_slist *headers, bool include_content_type);
+
+// Sign a POST carrying body and attach the body to curl
+bool layer1_attach_signed_body(HttpSigner *signer, CURL *curl, const char *url,
+                               RequestBody *body, struct curl_slist **headers);
+
+void layer1_build_addresses_url(char *url, size_t url_size, Layer1Client *client,
+                                const char *asset_pool_id, const char *reference);
+// False, with an error printed, when the URL does not fit in url_size
+bool layer1_build_transactions_url(char *url, size_t url_size, Layer1Client *client,
+                                   const char *asset_pool_id, const char *query);
+
+// Called after a successful create: drop the cached lists the new record
+// belongs in, and keep fetches already in flight from caching theirs
+void layer1_forget_address_list(Layer1Client *client, const char *asset_pool_id, const char *reference);
+void layer1_forget_transaction_lists(Layer1Client *client, const char *asset_pool_id);
+
+#endif // CLIENT_INTERNAL_H
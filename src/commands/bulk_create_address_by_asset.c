@@ -0,0 +1,221 @@
+#include "commands/bulk_create_address_by_asset.h"
+#include "arg_parser.h"
+#include "task_executor.h"
+#include "output.h"
+#include "reference_list.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#define DEFAULT_CONCURRENCY 16
+#define DEFAULT_POLL_DELAY_MS 1000
+
+static Command bulk_create_address_by_asset_command = {
+    .name = "bulk-create-address-by-asset",
+    .description = "Create addresses by asset for a list of references",
+    .execute = execute_bulk_create_address_by_asset_command,
+    .help = bulk_create_address_by_asset_help
+};
+
+void register_bulk_create_address_by_asset_command(void) {
+    register_command(&bulk_create_address_by_asset_command);
+}
+
+typedef struct BulkRun BulkRun;
+
+// One reference moving through create -> wait -> list
+typedef struct {
+    BulkRun *run;
+    char *reference;
+    AddressListResponse *addresses;
+    const char *error;
+} ReferenceJob;
+
+struct BulkRun {
+    Layer1Client *client;
+    const char *asset_pool_id;
+    const char *asset;
+    unsigned int poll_delay_ms;
+    ReferenceJob *jobs;
+    int job_count;
+};
+
+static void list_addresses_task(TaskExecutor *executor, void *arg) {
+    ReferenceJob *job = (ReferenceJob *)arg;
+    BulkRun *run = job->run;
+
+    job->addresses = layer1_list_addresses(run->client, run->asset_pool_id, job->reference);
+    if (!job->addresses) {
+        job->error = "Failed to list addresses";
+    }
+}
+
+static void create_address_task(TaskExecutor *executor, void *arg) {
+    ReferenceJob *job = (ReferenceJob *)arg;
+    BulkRun *run = job->run;
+
+    AddressResponse *response = layer1_create_address_by_asset(run->client, run->asset_pool_id,
+                                                               run->asset, job->reference);
+    if (!response) {
+        job->error = "Failed to create address";
+        return;
+    }
+    layer1_free_address_response(response);
+
+    // The wait sits in the executor's timer queue, so the worker moves on
+    // to other references instead of sleeping
+    if (!task_executor_submit_after(executor, run->poll_delay_ms, list_addresses_task, job)) {
+        job->error = "Failed to schedule address listing";
+    }
+}
+
+// Give every reference in the file its own job
+static bool read_references(const char *path, BulkRun *run) {
+    ReferenceList references = {0};
+    bool ok = reference_list_read(path, &references);
+
+    run->jobs = ok ? calloc((size_t)references.count + 1, sizeof(ReferenceJob)) : NULL;
+    for (int i = 0; run->jobs && i < references.count; i++) {
+        run->jobs[i].run = run;
+        run->jobs[i].reference = references.items[i];
+        references.items[i] = NULL;
+        run->job_count++;
+    }
+
+    ok = ok && run->jobs;
+    reference_list_free(&references);
+    return ok;
+}
+
+static void free_run(BulkRun *run) {
+    for (int i = 0; i < run->job_count; i++) {
+        free(run->jobs[i].reference);
+        layer1_free_address_list_response(run->jobs[i].addresses);
+    }
+    free(run->jobs);
+}
+
+bool execute_bulk_create_address_by_asset_command(Layer1Client *client, int argc, char **argv) {
+    CommandArgs *args = parse_command_args(argc, argv);
+    if (!args) {
+        fprintf(stderr, "Error: Failed to parse arguments\n");
+        return false;
+    }
+
+    const char *asset_pool_id = get_arg_value(args, "asset-pool-id");
+    const char *asset = get_arg_value(args, "asset");
+    const char *references_file = get_arg_value(args, "references-file");
+    const char *concurrency_arg = get_arg_value(args, "concurrency");
+    const char *poll_delay_arg = get_arg_value(args, "poll-delay-ms");
+
+    if (!asset_pool_id || !asset || !references_file) {
+        fprintf(stderr, "Error: Missing required arguments\n");
+        bulk_create_address_by_asset_help();
+        free_command_args(args);
+        return false;
+    }
+
+    int concurrency = concurrency_arg ? atoi(concurrency_arg) : DEFAULT_CONCURRENCY;
+    if (concurrency <= 0) {
+        fprintf(stderr, "Error: --concurrency must be a positive number\n");
+        free_command_args(args);
+        return false;
+    }
+
+    BulkRun run = {
+        .client = client,
+        .asset_pool_id = asset_pool_id,
+        .asset = asset,
+        .poll_delay_ms = poll_delay_arg ? (unsigned int)strtoul(poll_delay_arg, NULL, 10) : DEFAULT_POLL_DELAY_MS
+    };
+
+    if (!read_references(references_file, &run)) {
+        fprintf(stderr, "Error: Failed to read references\n");
+        free_run(&run);
+        free_command_args(args);
+        return false;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Requests block a worker, so concurrency bounds the requests in flight
+    TaskExecutor *executor = task_executor_create(concurrency);
+    if (!executor) {
+        fprintf(stderr, "Error: Failed to start workers\n");
+        free_run(&run);
+        free_command_args(args);
+        return false;
+    }
+
+    for (int i = 0; i < run.job_count; i++) {
+        if (!task_executor_submit(executor, create_address_task, &run.jobs[i])) {
+            run.jobs[i].error = "Failed to schedule address creation";
+        }
+    }
+
+    task_executor_wait(executor);
+    task_executor_destroy(executor);
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    // Print the results in input order. Machine-readable formats get only the
+    // address records on stdout; errors and the summary go to stderr.
+    bool text = output_format() == OUTPUT_TEXT;
+    int failed = 0;
+    for (int i = 0; i < run.job_count; i++) {
+        ReferenceJob *job = &run.jobs[i];
+        if (text) {
+            printf("\nReference: %s\n", job->reference);
+        }
+
+        if (job->error) {
+            if (text) {
+                printf("Error: %s\n", job->error);
+            } else {
+                fprintf(stderr, "Error for %s: %s\n", job->reference, job->error);
+            }
+            failed++;
+            continue;
+        }
+
+        if (!text) {
+            for (int j = 0; j < job->addresses->contentCount; j++) {
+                output_address(job->addresses->content[j]);
+            }
+            continue;
+        }
+
+        for (int j = 0; j < job->addresses->contentCount; j++) {
+            AddressResponse *addr = job->addresses->content[j];
+            printf("Network: %-10s Address: %s\n",
+                   addr->network ? addr->network : "PENDING",
+                   addr->address ? addr->address : "PENDING");
+        }
+    }
+
+    fprintf(text ? stdout : stderr, "\n%d references, %d failed, %.2f seconds with %d workers\n",
+            run.job_count, failed, elapsed, concurrency);
+
+    // Clean up
+    free_run(&run);
+    free_command_args(args);
+    return failed == 0;
+}
+
+void bulk_create_address_by_asset_help(void) {
+    printf("Usage: bulk-create-address-by-asset --asset-pool-id <id> --asset <asset> --references-file <path> [--concurrency <n>] [--poll-delay-ms <ms>]\n\n");
+    printf("Create addresses for all supported networks of an asset, for every reference in a file.\n");
+    printf("Creates and listings of different references run concurrently; the wait before\n");
+    printf("listing does not hold a worker.\n\n");
+    printf("Required arguments:\n");
+    printf("  --asset-pool-id <id>       The ID of the asset pool\n");
+    printf("  --asset <asset>            The asset (e.g. USDC, USDT)\n");
+    printf("  --references-file <path>   File with one reference per line, - for stdin\n\n");
+    printf("Optional arguments:\n");
+    printf("  --concurrency <n>          Requests in flight at once (default: %d)\n", DEFAULT_CONCURRENCY);
+    printf("  --poll-delay-ms <ms>       Wait between creating and listing (default: %d)\n", DEFAULT_POLL_DELAY_MS);
+}
@@ -1,5 +1,6 @@
 #include "commands/create_address.h"
 #include "arg_parser.h"
+#include "output.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -49,6 +50,13 @@ bool execute_create_address_command(Layer1Client *client, int argc, char **argv)
     }
 
     // Print the response
+    if (output_format() != OUTPUT_TEXT) {
+        output_address(response);
+        layer1_free_address_response(response);
+        free_command_args(args);
+        return true;
+    }
+
     printf("Address created successfully:\n");
     printf("  ID: %s\n", response->id);
     printf("  Address: %s\n", response->address);
@@ -1,5 +1,6 @@
 #include "commands/create_address_by_asset.h"
 #include "arg_parser.h"
+#include "output.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -48,11 +49,17 @@ bool execute_create_address_by_asset_command(Layer1Client *client, int argc, cha
         return false;
     }
 
-    printf("Address creation initiated...\n");
+    // Progress messages would break a machine-readable stream
+    bool text = output_format() == OUTPUT_TEXT;
+    if (text) {
+        printf("Address creation initiated...\n");
+    }
     layer1_free_address_response(create_response);
 
     // Step 2: Poll for 1 second using list addresses API
-    printf("Waiting for addresses to be created...\n");
+    if (text) {
+        printf("Waiting for addresses to be created...\n");
+    }
     sleep(1);  // Wait for 1 second
 
     // Step 3: List addresses and display network + address
@@ -69,9 +76,15 @@ bool execute_create_address_by_asset_command(Layer1Client *client, int argc, cha
     }
 
     // Print the addresses
-    printf("\nAddresses created:\n");
+    if (text) {
+        printf("\nAddresses created:\n");
+    }
     for (int i = 0; i < list_response->contentCount; i++) {
         AddressResponse *addr = list_response->content[i];
+        if (!text) {
+            output_address(addr);
+            continue;
+        }
         printf("Network: %-10s Address: %s\n", 
                addr->network ? addr->network : "PENDING",
                addr->address ? addr->address : "PENDING");
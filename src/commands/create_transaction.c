@@ -1,5 +1,6 @@
 #include "commands/create_transaction.h"
 #include "arg_parser.h"
+#include "output.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -54,6 +55,13 @@ bool execute_create_transaction_command(Layer1Client *client, int argc, char **a
     }
 
     // Print the response
+    if (output_format() != OUTPUT_TEXT) {
+        output_transaction_request(response);
+        layer1_free_transaction_response(response);
+        free_command_args(args);
+        return true;
+    }
+
     printf("Transaction created successfully:\n");
     printf("  ID: %s\n", response->id);
     printf("  Status: %s\n", response->status);
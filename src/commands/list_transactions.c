@@ -1,6 +1,10 @@
 #include "commands/list_transactions.h"
 #include "layer1_client.h"
 #include "arg_parser.h"
+#include "output.h"
+#include "reference_list.h"
+#include "radix_sort.h"
+#include "timestamp.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -9,13 +13,170 @@ static Command list_transactions_command = {
     .name = "list-transactions",
     .description = "List transactions by reference",
     .execute = execute_list_transactions_command,
-    .help = list_transactions_help
+    .help = list_transactions_help,
+    .raw_output = true
 };
 
 void register_list_transactions_command(void) {
     register_command(&list_transactions_command);
 }
 
+static bool write_body(const char *data, size_t length, void *user_data) {
+    return output_raw(data, length);
+}
+
+typedef struct {
+    int count;
+    unsigned int fields;        // Fields requested with --fields
+    bool text;
+    bool header_printed;        // "Transactions found:" goes out with the first response
+    bool filtered;              // --since or --until given
+    int64_t since;              // Inclusive
+    int64_t until;              // Exclusive
+} ListState;
+
+static bool in_range(const ListState *state, const Transaction *tx) {
+    return !state->filtered ||
+           (tx->createdAtMs != LAYER1_TIME_NONE && tx->createdAtMs >= state->since && tx->createdAtMs < state->until);
+}
+
+static void print_field(const ListState *state, unsigned int field, const char *label, const char *value) {
+    if (state->fields & field) {
+        printf("  %s: %s\n", label, value ? value : "");
+    }
+}
+
+static void print_transaction(ListState *state, const Transaction *tx) {
+    printf("\nTransaction %d:\n", ++state->count);
+    print_field(state, TRANSACTION_FIELD_ID, "ID", tx->id);
+    print_field(state, TRANSACTION_FIELD_STATUS, "Status", tx->status);
+    print_field(state, TRANSACTION_FIELD_NETWORK, "Network", tx->network);
+    print_field(state, TRANSACTION_FIELD_ASSET, "Asset", tx->asset);
+    print_field(state, TRANSACTION_FIELD_REFERENCE, "Reference", tx->reference);
+    print_field(state, TRANSACTION_FIELD_CREATED_AT, "Created At", tx->createdAt);
+    print_field(state, TRANSACTION_FIELD_AMOUNT, "Amount", tx->amount);
+}
+
+static void print_header(ListState *state) {
+    if (state->text && !state->header_printed) {
+        printf("Transactions found:\n");
+        state->header_printed = true;
+    }
+}
+
+static void emit_transaction(ListState *state, const Transaction *tx) {
+    print_header(state);
+    if (state->text) {
+        print_transaction(state, tx);
+    } else {
+        output_transaction_fields(tx, state->fields);
+    }
+}
+
+// Print a whole page, ordered by createdAt when sorted. The response may be
+// shared with other callers, so an index is sorted instead of the records.
+static bool emit_list(ListState *state, const TransactionListResponse *list, bool sorted) {
+    if (!sorted) {
+        for (int i = 0; i < list->count; i++) {
+            if (in_range(state, &list->transactions[i])) {
+                emit_transaction(state, &list->transactions[i]);
+            }
+        }
+        return true;
+    }
+
+    RadixItem *items = malloc(sizeof(RadixItem) * ((size_t)list->count + 1));
+    if (!items) {
+        return false;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (in_range(state, &list->transactions[i])) {
+            items[count].key = list->transactions[i].createdAtMs;
+            items[count].row = (uint32_t)i;
+            count++;
+        }
+    }
+
+    // Records without a timestamp sort first
+    bool ok = radix_sort(items, count);
+    for (size_t i = 0; ok && i < count; i++) {
+        emit_transaction(state, &list->transactions[items[i].row]);
+    }
+
+    free(items);
+    return ok;
+}
+
+// Fetch every page of one reference's transactions, then print them
+static bool list_reference(Layer1Client *client, const char *asset_pool_id, const char *reference,
+                           unsigned int decode_fields, bool sorted, ListState *state) {
+    TransactionListResponse *list = NULL;
+    if (!layer1_list_transactions_by_references(client, asset_pool_id, &reference, 1,
+                                                "type:(deposit+withdrawal)", decode_fields, &list)) {
+        return false;
+    }
+
+    print_header(state);
+    bool ok = emit_list(state, list, sorted);
+    layer1_free_transaction_list_response(list);
+    return ok;
+}
+
+// Fetch the transactions of every reference in a file with a few batched
+// queries, then print them reference by reference
+static bool list_by_references(Layer1Client *client, const char *asset_pool_id, const char *path,
+                               unsigned int decode_fields, bool sorted, ListState *state) {
+    ReferenceList reference_list = {0};
+    bool ok = reference_list_read(path, &reference_list);
+    char **references = reference_list.items;
+    int count = reference_list.count;
+
+    TransactionListResponse **lists = ok ? calloc((size_t)count + 1, sizeof(TransactionListResponse *)) : NULL;
+    if (lists) {
+        layer1_list_transactions_by_references(client, asset_pool_id, (const char *const *)references, count,
+                                               "type:(deposit+withdrawal)", decode_fields, lists);
+    } else {
+        ok = false;
+    }
+
+    for (int i = 0; lists && i < count; i++) {
+        if (!lists[i]) {
+            fprintf(stderr, "Error for %s: Failed to list transactions\n", references[i]);
+            ok = false;
+            continue;
+        }
+        print_header(state);
+        if (state->text) {
+            printf("\nReference: %s\n", references[i]);
+        }
+        ok = emit_list(state, lists[i], sorted) && ok;
+        layer1_free_transaction_list_response(lists[i]);
+    }
+
+    reference_list_free(&reference_list);
+    free(lists);
+    return ok;
+}
+
+// An epoch in milliseconds, a date (midnight UTC) or a full ISO-8601 timestamp
+static bool parse_time_arg(const char *text, int64_t *ms) {
+    char *end;
+    long long value = strtoll(text, &end, 10);
+    if (*text != '\0' && *end == '\0') {
+        *ms = value;
+        return true;
+    }
+
+    if (strlen(text) == 10) {
+        char timestamp[32];
+        snprintf(timestamp, sizeof(timestamp), "%sT00:00:00Z", text);
+        return timestamp_parse_ms(timestamp, strlen(timestamp), ms);
+    }
+    return timestamp_parse_ms(text, strlen(text), ms);
+}
+
 bool execute_list_transactions_command(Layer1Client *client, int argc, char **argv) {
     CommandArgs *args = parse_command_args(argc, argv);
     if (!args) {
@@ -25,55 +186,102 @@ bool execute_list_transactions_command(Layer1Client *client, int argc, char **ar
 
     const char *asset_pool_id = get_arg_value(args, "asset-pool-id");
     const char *reference = get_arg_value(args, "reference");
+    const char *references_file = get_arg_value(args, "references-file");
+    const char *field_names = get_arg_value(args, "fields");
+    const char *since = get_arg_value(args, "since");
+    const char *until = get_arg_value(args, "until");
+    const char *sort = get_arg_value(args, "sort");
 
-    if (!asset_pool_id || !reference) {
+    if (!asset_pool_id || !reference == !references_file) {
         fprintf(stderr, "Error: Missing required arguments\n");
         list_transactions_help();
         free_command_args(args);
         return false;
     }
 
+    ListState state = { 0, TRANSACTION_FIELDS_ALL, output_format() == OUTPUT_TEXT, false, since || until, INT64_MIN, INT64_MAX };
+    if (field_names && !layer1_parse_transaction_fields(field_names, &state.fields)) {
+        fprintf(stderr, "Error: Invalid --fields\n");
+        free_command_args(args);
+        return false;
+    }
+
+    if ((since && !parse_time_arg(since, &state.since)) || (until && !parse_time_arg(until, &state.until))) {
+        fprintf(stderr, "Error: --since and --until take epoch milliseconds, YYYY-MM-DD or an ISO-8601 timestamp\n");
+        free_command_args(args);
+        return false;
+    }
+
+    if (sort && strcmp(sort, "created") != 0) {
+        fprintf(stderr, "Error: --sort only supports created\n");
+        free_command_args(args);
+        return false;
+    }
+
+    if (output_format() == OUTPUT_RAW && (state.filtered || sort || references_file)) {
+        fprintf(stderr, "Error: --since, --until, --sort and --references-file need decoded output, not --raw\n");
+        free_command_args(args);
+        return false;
+    }
+
+    // Filtering and sorting need createdAt even when it is not printed
+    unsigned int decode_fields = state.fields;
+    if (state.filtered || sort) {
+        decode_fields |= TRANSACTION_FIELD_CREATED_AT;
+    }
+
+    if (references_file) {
+        bool ok = list_by_references(client, asset_pool_id, references_file, decode_fields, sort != NULL, &state);
+        free_command_args(args);
+        return ok;
+    }
+
     // Prepare the query parameter in the format reference:REF-12a1
-    char query[256];
-    snprintf(query, sizeof(query), "reference:%s+type:(deposit+withdrawal)", reference);
+    char query[LAYER1_QUERY_SIZE];
+    if (!layer1_build_reference_query(query, sizeof(query), reference, "type:(deposit+withdrawal)")) {
+        fprintf(stderr, "Error: --reference is too long\n");
+        free_command_args(args);
+        return false;
+    }
 
-    // Call the Layer1 client API
-    TransactionListResponse *response = layer1_list_transactions(
-        client,
-        asset_pool_id,
-        query
-    );
+    // With --raw the first page's body passes through undecoded; otherwise
+    // every page is read, as with --references-file, before printing
+    bool ok;
+    if (output_format() == OUTPUT_RAW) {
+        ok = layer1_stream_transactions_raw(client, asset_pool_id, query, write_body, NULL);
+    } else {
+        ok = list_reference(client, asset_pool_id, reference, decode_fields, sort != NULL, &state);
+    }
 
-    if (!response) {
+    if (!ok) {
         fprintf(stderr, "Error: Failed to list transactions\n");
         free_command_args(args);
         return false;
     }
 
-    // Print the response
-    printf("Transactions found:\n");
-    for (int i = 0; i < response->count; i++) {
-        Transaction *tx = &response->transactions[i];
-        printf("\nTransaction %d:\n", i + 1);
-        printf("  ID: %s\n", tx->id);
-        printf("  Status: %s\n", tx->status);
-        printf("  Network: %s\n", tx->network);
-        printf("  Asset: %s\n", tx->asset);
-        printf("  Reference: %s\n", tx->reference);
-        printf("  Created At: %s\n", tx->createdAt);
-        printf("  Amount: %s\n", tx->amount);
-    }
+    // An empty page still gets its header
+    print_header(&state);
 
     // Clean up
-    layer1_free_transaction_list_response(response);
     free_command_args(args);
     return true;
 }
 
 void list_transactions_help(void) {
-    printf("Usage: list-transactions --asset-pool-id <id> --reference <reference>\n\n");
+    printf("Usage: list-transactions --asset-pool-id <id> (--reference <reference> | --references-file <path>)\n");
+    printf("                         [--fields <names>] [--since <time>] [--until <time>] [--sort created]\n\n");
     printf("List transactions by reference.\n\n");
     printf("Required arguments:\n");
     printf("  --asset-pool-id <id>    The ID of the asset pool\n");
     printf("  --reference <reference>  The reference to search for\n");
-} 
+    printf("  --references-file <path> Or a file with one reference per line, - for stdin. The\n");
+    printf("                          references are packed into as few queries as the URL\n");
+    printf("                          length allows and printed one reference at a time.\n");
+    printf("\nOptional arguments:\n");
+    printf("  --fields <names>        Comma-separated fields to decode and print: id, status,\n");
+    printf("                          network, asset, reference, createdAt, amount (default: all)\n");
+    printf("  --since <time>          Only transactions created at or after time\n");
+    printf("  --until <time>          Only transactions created before time\n");
+    printf("                          Times are epoch milliseconds, YYYY-MM-DD (UTC) or ISO-8601\n");
+    printf("  --sort created          Print oldest first\n");
+}
@@ -0,0 +1,764 @@
+#include "commands/reconcile.h"
+#include "commands/reconcile_join.h"
+#include "arg_parser.h"
+#include "amount.h"
+#include "output.h"
+#include "string_hash.h"
+#include "task_executor.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <time.h>
+
+#define DEFAULT_CONCURRENCY 16
+#define MAX_CHUNK_REFERENCES 1024  // References one worker lists before others get theirs
+#define MAX_LEDGER_COLUMNS 32
+
+#define RECONCILE_FIELDS (TRANSACTION_FIELD_ID | TRANSACTION_FIELD_STATUS | TRANSACTION_FIELD_ASSET | \
+                          TRANSACTION_FIELD_REFERENCE | TRANSACTION_FIELD_AMOUNT)
+
+static Command reconcile_command = {
+    .name = "reconcile",
+    .description = "Match a ledger export against API transactions",
+    .execute = execute_reconcile_command,
+    .help = reconcile_help
+};
+
+void register_reconcile_command(void) {
+    register_command(&reconcile_command);
+}
+
+static const char *const result_names[RESULT_COUNT] = {
+    "matched", "amount-mismatch", "missing", "extra", "not-settled"
+};
+
+// Key of a listed transaction, parsed once for both join passes
+typedef struct {
+    AmountUnits units;
+    Layer1TransactionId id;
+    uint16_t asset;
+    bool has_id;
+    bool exact;
+} TransactionKey;
+
+// Hash chains over the transactions of one group; chains keep list order
+typedef struct {
+    int *heads;
+    int *next;
+    size_t mask;
+} ChainIndex;
+
+static uint64_t amount_hash(uint16_t asset, AmountUnits units) {
+    uint64_t hash = (uint64_t)units ^ ((uint64_t)(units >> 64) * 0x9E3779B97F4A7C15ull);
+    hash = (hash ^ asset) * 0xBF58476D1CE4E5B9ull;
+    return hash ^ (hash >> 31);
+}
+
+static bool chain_index_init(ChainIndex *index, int count) {
+    size_t buckets = 2;
+    while (buckets < (size_t)count * 2) {
+        buckets *= 2;
+    }
+    index->mask = buckets - 1;
+    index->heads = malloc(sizeof(int) * buckets);
+    index->next = malloc(sizeof(int) * ((size_t)count + 1));
+    if (!index->heads || !index->next) {
+        return false;
+    }
+    memset(index->heads, 0xFF, sizeof(int) * buckets);
+    return true;
+}
+
+static void chain_index_insert(ChainIndex *index, int transaction, uint64_t hash) {
+    int *head = &index->heads[hash & index->mask];
+    index->next[transaction] = *head;
+    *head = transaction;
+}
+
+static void chain_index_free(ChainIndex *index) {
+    free(index->heads);
+    free(index->next);
+}
+
+// Split one CSV line in place, undoing quotes; -1 on an unterminated quote
+static int split_csv(char *line, char **fields, int max_fields) {
+    int count = 0;
+    char *p = line;
+    for (;;) {
+        char *field = p;
+        char *out = p;
+        if (*p == '"') {
+            p++;
+            for (;;) {
+                if (*p == '\0') {
+                    return -1;
+                }
+                if (*p == '"' && p[1] == '"') {
+                    *out++ = '"';
+                    p += 2;
+                } else if (*p == '"') {
+                    p++;
+                    break;
+                } else {
+                    *out++ = *p++;
+                }
+            }
+            while (*p && *p != ',') {
+                p++;
+            }
+        } else {
+            while (*p && *p != ',') {
+                p++;
+            }
+            out = p;
+        }
+
+        char separator = *p;
+        *out = '\0';
+        if (count < max_fields) {
+            fields[count] = field;
+        }
+        count++;
+        if (separator == '\0') {
+            return count;
+        }
+        p++;
+    }
+}
+
+static char *trim(char *value) {
+    while (*value == ' ' || *value == '\t') {
+        value++;
+    }
+    size_t length = strlen(value);
+    while (length > 0 && (value[length - 1] == ' ' || value[length - 1] == '\t')) {
+        value[--length] = '\0';
+    }
+    return value;
+}
+
+static bool grow_group_slots(Reconciliation *run) {
+    size_t buckets = run->group_mask ? (run->group_mask + 1) * 2 : 1024;
+    uint32_t *slots = calloc(buckets, sizeof(uint32_t));
+    if (!slots) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < run->group_count; i++) {
+        size_t slot = string_hash(run->groups[i].reference) & (buckets - 1);
+        while (slots[slot]) {
+            slot = (slot + 1) & (buckets - 1);
+        }
+        slots[slot] = i + 1;
+    }
+
+    free(run->group_slots);
+    run->group_slots = slots;
+    run->group_mask = buckets - 1;
+    return true;
+}
+
+// Index of the reference's group, adding it on first sight
+static bool find_group(Reconciliation *run, const char *reference, uint32_t *group) {
+    // Keep the map at most half full
+    if ((run->group_count + 1) * 2 > run->group_mask + 1 && !grow_group_slots(run)) {
+        return false;
+    }
+
+    size_t slot = string_hash(reference) & run->group_mask;
+    while (run->group_slots[slot]) {
+        uint32_t index = run->group_slots[slot] - 1;
+        if (strcmp(run->groups[index].reference, reference) == 0) {
+            *group = index;
+            return true;
+        }
+        slot = (slot + 1) & run->group_mask;
+    }
+
+    if (run->group_count == run->group_capacity) {
+        uint32_t capacity = run->group_capacity ? run->group_capacity * 2 : 1024;
+        ReferenceGroup *groups = realloc(run->groups, sizeof(ReferenceGroup) * capacity);
+        if (!groups) {
+            return false;
+        }
+        run->groups = groups;
+        run->group_capacity = capacity;
+    }
+
+    ReferenceGroup *added = &run->groups[run->group_count];
+    memset(added, 0, sizeof(ReferenceGroup));
+    added->run = run;
+    added->reference = strdup(reference);
+    if (!added->reference) {
+        return false;
+    }
+    run->group_slots[slot] = run->group_count + 1;
+    *group = run->group_count++;
+    return true;
+}
+
+static uint16_t lookup_asset(const Reconciliation *run, const char *asset) {
+    for (uint16_t i = 0; i < run->asset_count; i++) {
+        if (strcmp(run->assets[i], asset) == 0) {
+            return i;
+        }
+    }
+    return NO_ASSET;
+}
+
+// Few distinct assets are expected, so a linear search is enough
+static bool intern_asset(Reconciliation *run, const char *asset, uint16_t *code) {
+    *code = lookup_asset(run, asset);
+    if (*code != NO_ASSET) {
+        return true;
+    }
+    if (run->asset_count == NO_ASSET) {
+        return false;
+    }
+
+    char **assets = realloc(run->assets, sizeof(char *) * (run->asset_count + 1u));
+    if (assets) {
+        run->assets = assets;
+    }
+    int *scales = assets ? realloc(run->scales, sizeof(int) * (run->asset_count + 1u)) : NULL;
+    if (scales) {
+        run->scales = scales;
+    }
+    char *copy = scales ? strdup(asset) : NULL;
+    if (!copy) {
+        return false;
+    }
+
+    run->assets[run->asset_count] = copy;
+    run->scales[run->asset_count] = amount_scale_for_asset(copy);
+    *code = run->asset_count++;
+    return true;
+}
+
+typedef struct {
+    int reference;
+    int amount;
+    int asset;
+    int id;                     // -1 when the ledger has no id column
+} LedgerColumns;
+
+// A header row names its columns; without one they are reference, amount, asset, id
+static bool read_header(char **fields, int count, LedgerColumns *columns) {
+    LedgerColumns named = { -1, -1, -1, -1 };
+    for (int i = 0; i < count && i < MAX_LEDGER_COLUMNS; i++) {
+        const char *name = trim(fields[i]);
+        if (strcasecmp(name, "reference") == 0) named.reference = i;
+        else if (strcasecmp(name, "amount") == 0) named.amount = i;
+        else if (strcasecmp(name, "asset") == 0) named.asset = i;
+        else if (strcasecmp(name, "id") == 0) named.id = i;
+    }
+
+    if (named.reference < 0) {
+        *columns = (LedgerColumns){ 0, 1, 2, 3 };
+        return false;
+    }
+    *columns = named;
+    return true;
+}
+
+static bool add_line(Reconciliation *run, char **fields, int count, const LedgerColumns *columns,
+                     unsigned long line_number) {
+    if (columns->reference >= count || columns->amount >= count || columns->asset < 0 ||
+        columns->amount < 0 || columns->asset >= count) {
+        fprintf(stderr, "Error: ledger line %lu: expected reference, amount and asset\n", line_number);
+        return false;
+    }
+
+    if (run->line_count == run->line_capacity) {
+        if (run->line_capacity > UINT32_MAX / 2) {
+            fprintf(stderr, "Error: ledger has too many lines\n");
+            return false;
+        }
+        uint32_t capacity = run->line_capacity ? run->line_capacity * 2 : 4096;
+        LedgerLine *lines = realloc(run->lines, sizeof(LedgerLine) * capacity);
+        if (!lines) {
+            return false;
+        }
+        run->lines = lines;
+        run->line_capacity = capacity;
+    }
+
+    LedgerLine *line = &run->lines[run->line_count];
+    memset(line, 0, sizeof(LedgerLine));
+    line->match = NO_MATCH;
+
+    const char *reference = trim(fields[columns->reference]);
+    const char *amount = trim(fields[columns->amount]);
+    const char *asset = trim(fields[columns->asset]);
+    if (!*reference || !*asset) {
+        fprintf(stderr, "Error: ledger line %lu: empty reference or asset\n", line_number);
+        return false;
+    }
+
+    if (!intern_asset(run, asset, &line->asset) || !find_group(run, reference, &line->group)) {
+        fprintf(stderr, "Error: ledger line %lu: out of memory\n", line_number);
+        return false;
+    }
+
+    if (!amount_parse(amount, strlen(amount), run->scales[line->asset], &line->units)) {
+        fprintf(stderr, "Error: ledger line %lu: %s is not an exact %s amount\n", line_number, amount, asset);
+        return false;
+    }
+
+    const char *id = columns->id >= 0 && columns->id < count ? trim(fields[columns->id]) : "";
+    if (*id) {
+        if (!layer1_transaction_id_parse(id, strlen(id), &line->id)) {
+            fprintf(stderr, "Error: ledger line %lu: %s is not a transaction id\n", line_number, id);
+            return false;
+        }
+        line->has_id = true;
+    }
+
+    run->groups[line->group].count++;
+    run->line_count++;
+    return true;
+}
+
+// Read the ledger CSV; "-" reads stdin
+static bool read_ledger(const char *path, Reconciliation *run) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open %s\n", path);
+        return false;
+    }
+
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t length;
+    unsigned long line_number = 0;
+    bool first = true;
+    bool ok = true;
+    LedgerColumns columns;
+    char *fields[MAX_LEDGER_COLUMNS];
+
+    while (ok && (length = getline(&line, &line_size, file)) >= 0) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+
+        int count = split_csv(line, fields, MAX_LEDGER_COLUMNS);
+        if (count < 0) {
+            fprintf(stderr, "Error: ledger line %lu: unterminated quote\n", line_number);
+            ok = false;
+            break;
+        }
+        if (count > MAX_LEDGER_COLUMNS) {
+            count = MAX_LEDGER_COLUMNS;
+        }
+
+        if (first) {
+            first = false;
+            if (read_header(fields, count, &columns)) {
+                continue;
+            }
+        }
+        ok = add_line(run, fields, count, &columns, line_number);
+    }
+
+    free(line);
+    if (file != stdin) {
+        fclose(file);
+    }
+    return ok;
+}
+
+// Lay the lines out group by group, keeping file order within each
+static bool group_lines(Reconciliation *run) {
+    run->order = malloc(sizeof(uint32_t) * ((size_t)run->line_count + 1));
+    if (!run->order) {
+        return false;
+    }
+
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < run->group_count; i++) {
+        run->groups[i].first = start;
+        start += run->groups[i].count;
+        run->groups[i].count = 0;
+    }
+    for (uint32_t i = 0; i < run->line_count; i++) {
+        ReferenceGroup *group = &run->groups[run->lines[i].group];
+        run->order[group->first + group->count++] = i;
+    }
+    return true;
+}
+
+static void pair(LedgerLine *line, uint8_t *states, int transaction, ReconcileResult result) {
+    states[transaction] = TRANSACTION_PAIRED;
+    line->match = transaction;
+    line->result = (uint8_t)result;
+}
+
+bool reconcile_join_group(ReferenceGroup *group) {
+    Reconciliation *run = group->run;
+    Transaction *transactions = group->transactions->transactions;
+    int count = group->transactions->count;
+
+    TransactionKey *keys = malloc(sizeof(TransactionKey) * ((size_t)count + 1));
+    int *cursors = malloc(sizeof(int) * (run->asset_count + 1u));
+    group->states = calloc((size_t)count + 1, 1);
+    ChainIndex by_id = { NULL, NULL, 0 };
+    ChainIndex by_amount = { NULL, NULL, 0 };
+    bool ok = keys && cursors && group->states &&
+              chain_index_init(&by_id, count) && chain_index_init(&by_amount, count);
+
+    // Inserting back to front keeps every chain in list order
+    for (int i = count - 1; ok && i >= 0; i--) {
+        Transaction *tx = &transactions[i];
+        TransactionKey *key = &keys[i];
+        if (!tx->reference || strcmp(tx->reference, group->reference) != 0) {
+            group->states[i] = TRANSACTION_OTHER_REFERENCE;
+            continue;
+        }
+
+        if (!tx->status || strcmp(tx->status, "SUCCESS") != 0) {
+            group->states[i] = TRANSACTION_NOT_SETTLED;
+        }
+        key->asset = tx->asset ? lookup_asset(run, tx->asset) : NO_ASSET;
+        key->has_id = tx->id && layer1_transaction_id_parse(tx->id, strlen(tx->id), &key->id);
+        key->exact = key->asset != NO_ASSET && tx->amount &&
+                     amount_parse(tx->amount, strlen(tx->amount), run->scales[key->asset], &key->units);
+        if (key->has_id) {
+            chain_index_insert(&by_id, i, layer1_transaction_id_hash(&key->id));
+        }
+        if (key->exact) {
+            chain_index_insert(&by_amount, i, amount_hash(key->asset, key->units));
+        }
+    }
+
+    for (uint32_t i = 0; ok && i < group->count; i++) {
+        LedgerLine *line = &run->lines[run->order[group->first + i]];
+        line->result = RESULT_MISSING;
+        if (!line->has_id) {
+            continue;
+        }
+        int t = by_id.heads[layer1_transaction_id_hash(&line->id) & by_id.mask];
+        for (; t >= 0; t = by_id.next[t]) {
+            if (group->states[t] == TRANSACTION_OPEN && memcmp(&keys[t].id, &line->id, sizeof(line->id)) == 0) {
+                bool same = keys[t].exact && keys[t].asset == line->asset && keys[t].units == line->units;
+                pair(line, group->states, t, same ? RESULT_MATCHED : RESULT_AMOUNT_MISMATCH);
+                break;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; ok && i < group->count; i++) {
+        LedgerLine *line = &run->lines[run->order[group->first + i]];
+        if (line->has_id) {
+            continue;
+        }
+        int t = by_amount.heads[amount_hash(line->asset, line->units) & by_amount.mask];
+        for (; t >= 0; t = by_amount.next[t]) {
+            if (group->states[t] == TRANSACTION_OPEN && keys[t].asset == line->asset && keys[t].units == line->units) {
+                pair(line, group->states, t, RESULT_MATCHED);
+                break;
+            }
+        }
+    }
+
+    // A line without a settled match may be explained by one that never settled
+    for (uint32_t i = 0; ok && i < group->count; i++) {
+        LedgerLine *line = &run->lines[run->order[group->first + i]];
+        if (line->match != NO_MATCH) {
+            continue;
+        }
+        int t = line->has_id ? by_id.heads[layer1_transaction_id_hash(&line->id) & by_id.mask]
+                             : by_amount.heads[amount_hash(line->asset, line->units) & by_amount.mask];
+        for (; t >= 0; t = line->has_id ? by_id.next[t] : by_amount.next[t]) {
+            if (group->states[t] != TRANSACTION_NOT_SETTLED) {
+                continue;
+            }
+            bool same = line->has_id ? memcmp(&keys[t].id, &line->id, sizeof(line->id)) == 0
+                                     : keys[t].asset == line->asset && keys[t].units == line->units;
+            if (same) {
+                pair(line, group->states, t, RESULT_NOT_SETTLED);
+                break;
+            }
+        }
+    }
+
+    // What is left pairs in list order per asset, so each asset is walked once
+    if (ok) {
+        memset(cursors, 0, sizeof(int) * (run->asset_count + 1u));
+    }
+    for (uint32_t i = 0; ok && i < group->count; i++) {
+        LedgerLine *line = &run->lines[run->order[group->first + i]];
+        if (line->has_id || line->match != NO_MATCH) {
+            continue;
+        }
+        int *cursor = &cursors[line->asset];
+        while (*cursor < count && (group->states[*cursor] != TRANSACTION_OPEN || keys[*cursor].asset != line->asset)) {
+            (*cursor)++;
+        }
+        if (*cursor < count) {
+            pair(line, group->states, *cursor, RESULT_AMOUNT_MISMATCH);
+        }
+    }
+
+    chain_index_free(&by_id);
+    chain_index_free(&by_amount);
+    free(cursors);
+    free(keys);
+    return ok;
+}
+
+// A run of consecutive groups listed together by one worker
+typedef struct {
+    Reconciliation *run;
+    uint32_t first;
+    uint32_t count;
+} GroupChunk;
+
+static void fail_chunk(GroupChunk *chunk, const char *error) {
+    for (uint32_t i = 0; i < chunk->count; i++) {
+        chunk->run->groups[chunk->first + i].error = error;
+    }
+}
+
+// List the chunk's references with batched queries, then join each group
+static void reconcile_chunk_task(TaskExecutor *executor, void *arg) {
+    GroupChunk *chunk = (GroupChunk *)arg;
+    Reconciliation *run = chunk->run;
+    ReferenceGroup *groups = &run->groups[chunk->first];
+
+    const char **references = malloc(sizeof(char *) * chunk->count);
+    TransactionListResponse **lists = malloc(sizeof(TransactionListResponse *) * chunk->count);
+    if (!references || !lists) {
+        fail_chunk(chunk, "Out of memory");
+        free(references);
+        free(lists);
+        return;
+    }
+
+    for (uint32_t i = 0; i < chunk->count; i++) {
+        references[i] = groups[i].reference;
+    }
+    layer1_list_transactions_by_references(run->client, run->asset_pool_id, references, (int)chunk->count,
+                                           "type:(deposit+withdrawal)", RECONCILE_FIELDS, lists);
+
+    for (uint32_t i = 0; i < chunk->count; i++) {
+        groups[i].transactions = lists[i];
+        if (!lists[i]) {
+            groups[i].error = "Failed to list transactions";
+        } else if (!reconcile_join_group(&groups[i])) {
+            groups[i].error = "Out of memory";
+        }
+    }
+
+    free(references);
+    free(lists);
+}
+
+static const char *const reconcile_columns[] = {
+    "result", "reference", "asset", "ledgerAmount", "amount", "id", "status"
+};
+static const OutputSchema reconcile_schema = { reconcile_columns, 7 };
+
+static void print_row(ReconcileResult result, const char *reference, const char *asset,
+                      const char *ledger_amount, const Transaction *tx) {
+    const char *amount = tx ? tx->amount : NULL;
+    const char *id = tx ? tx->id : NULL;
+    const char *status = tx ? tx->status : NULL;
+
+    if (output_format() == OUTPUT_TEXT) {
+        printf("%-15s %-24s %-6s %-22s %-22s %-8s %s\n", result_names[result], reference,
+               asset ? asset : "-", ledger_amount ? ledger_amount : "-", amount ? amount : "-",
+               status ? status : "-", id ? id : "-");
+        return;
+    }
+
+    output_begin_record(&reconcile_schema);
+    output_string(result_names[result]);
+    output_string(reference);
+    output_string(asset);
+    output_string(ledger_amount);
+    output_string(amount);
+    output_string(id);
+    output_string(status);
+    output_end_record();
+}
+
+// Print a group's rows in ledger order, then its unpaired transactions, and
+// release its transactions
+static void print_group(Reconciliation *run, ReferenceGroup *group, uint64_t *totals) {
+    for (uint32_t i = 0; i < group->count; i++) {
+        const LedgerLine *line = &run->lines[run->order[group->first + i]];
+        char ledger_amount[AMOUNT_FORMAT_SIZE];
+        amount_format(line->units, run->scales[line->asset], ledger_amount);
+
+        const Transaction *tx = line->match == NO_MATCH ? NULL : &group->transactions->transactions[line->match];
+        print_row((ReconcileResult)line->result, group->reference, run->assets[line->asset], ledger_amount, tx);
+        totals[line->result]++;
+    }
+
+    for (int t = 0; t < group->transactions->count; t++) {
+        uint8_t state = group->states[t];
+        if (state == TRANSACTION_OPEN || state == TRANSACTION_NOT_SETTLED) {
+            const Transaction *tx = &group->transactions->transactions[t];
+            ReconcileResult result = state == TRANSACTION_OPEN ? RESULT_EXTRA : RESULT_NOT_SETTLED;
+            print_row(result, group->reference, tx->asset, NULL, tx);
+            totals[result]++;
+        }
+    }
+
+    layer1_free_transaction_list_response(group->transactions);
+    group->transactions = NULL;
+}
+
+static void free_run(Reconciliation *run) {
+    for (uint32_t i = 0; i < run->group_count; i++) {
+        free(run->groups[i].reference);
+        free(run->groups[i].states);
+        layer1_free_transaction_list_response(run->groups[i].transactions);
+    }
+    for (uint16_t i = 0; i < run->asset_count; i++) {
+        free(run->assets[i]);
+    }
+    free(run->groups);
+    free(run->group_slots);
+    free(run->lines);
+    free(run->order);
+    free(run->assets);
+    free(run->scales);
+}
+
+bool execute_reconcile_command(Layer1Client *client, int argc, char **argv) {
+    CommandArgs *args = parse_command_args(argc, argv);
+    if (!args) {
+        fprintf(stderr, "Error: Failed to parse arguments\n");
+        return false;
+    }
+
+    const char *asset_pool_id = get_arg_value(args, "asset-pool-id");
+    const char *ledger = get_arg_value(args, "ledger");
+    const char *concurrency_arg = get_arg_value(args, "concurrency");
+
+    if (!asset_pool_id || !ledger) {
+        fprintf(stderr, "Error: Missing required arguments\n");
+        reconcile_help();
+        free_command_args(args);
+        return false;
+    }
+
+    int concurrency = concurrency_arg ? atoi(concurrency_arg) : DEFAULT_CONCURRENCY;
+    if (concurrency <= 0) {
+        fprintf(stderr, "Error: --concurrency must be a positive number\n");
+        free_command_args(args);
+        return false;
+    }
+
+    Reconciliation run = {
+        .client = client,
+        .asset_pool_id = asset_pool_id
+    };
+
+    if (!read_ledger(ledger, &run) || !group_lines(&run)) {
+        fprintf(stderr, "Error: Failed to read ledger\n");
+        free_run(&run);
+        free_command_args(args);
+        return false;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Requests block a worker, so concurrency bounds the requests in flight.
+    // Each worker joins its references as soon as their transactions arrive.
+    TaskExecutor *executor = task_executor_create(concurrency);
+    if (!executor) {
+        fprintf(stderr, "Error: Failed to start workers\n");
+        free_run(&run);
+        free_command_args(args);
+        return false;
+    }
+
+    // Spread the references evenly over the workers; each packs its share
+    // into as few queries as the URL length allows
+    uint32_t per_chunk = (run.group_count + (uint32_t)concurrency - 1) / (uint32_t)concurrency;
+    if (per_chunk > MAX_CHUNK_REFERENCES) {
+        per_chunk = MAX_CHUNK_REFERENCES;
+    }
+    uint32_t chunk_count = per_chunk ? (run.group_count + per_chunk - 1) / per_chunk : 0;
+    GroupChunk *chunks = calloc((size_t)chunk_count + 1, sizeof(GroupChunk));
+    if (!chunks) {
+        GroupChunk all = { &run, 0, run.group_count };
+        fail_chunk(&all, "Out of memory");
+        chunk_count = 0;
+    }
+    for (uint32_t i = 0; i < chunk_count; i++) {
+        GroupChunk *chunk = &chunks[i];
+        chunk->run = &run;
+        chunk->first = i * per_chunk;
+        chunk->count = run.group_count - chunk->first < per_chunk ? run.group_count - chunk->first : per_chunk;
+        if (!task_executor_submit(executor, reconcile_chunk_task, chunk)) {
+            fail_chunk(chunk, "Failed to schedule transaction listing");
+        }
+    }
+
+    task_executor_wait(executor);
+    task_executor_destroy(executor);
+    free(chunks);
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    // Groups print in order of first appearance in the ledger
+    bool text = output_format() == OUTPUT_TEXT;
+    if (text) {
+        printf("%-15s %-24s %-6s %-22s %-22s %-8s %s\n",
+               "Result", "Reference", "Asset", "Ledger amount", "Amount", "Status", "ID");
+    }
+
+    uint64_t totals[RESULT_COUNT] = { 0 };
+    int failed = 0;
+    for (uint32_t i = 0; i < run.group_count; i++) {
+        ReferenceGroup *group = &run.groups[i];
+        if (group->error) {
+            fprintf(stderr, "Error for %s: %s\n", group->reference, group->error);
+            failed++;
+            continue;
+        }
+        print_group(&run, group, totals);
+    }
+
+    fprintf(text ? stdout : stderr,
+            "\n%u ledger lines, %u references: %llu matched, %llu amount-mismatch, %llu missing, %llu extra, "
+            "%llu not-settled; %d references failed, %.2f seconds\n",
+            run.line_count, run.group_count, (unsigned long long)totals[RESULT_MATCHED],
+            (unsigned long long)totals[RESULT_AMOUNT_MISMATCH], (unsigned long long)totals[RESULT_MISSING],
+            (unsigned long long)totals[RESULT_EXTRA], (unsigned long long)totals[RESULT_NOT_SETTLED],
+            failed, elapsed);
+
+    // Clean up
+    free_run(&run);
+    free_command_args(args);
+    return failed == 0;
+}
+
+void reconcile_help(void) {
+    printf("Usage: reconcile --asset-pool-id <id> --ledger <path> [--concurrency <n>]\n\n");
+    printf("Match ledger lines against the transactions listed for their references.\n");
+    printf("References are packed into batched queries run concurrently, and joined in memory:\n");
+    printf("  - a line with an id pairs with that transaction,\n");
+    printf("  - other lines pair with a transaction of the same asset and amount,\n");
+    printf("  - then with a pending or failed transaction of that id or amount,\n");
+    printf("  - then with any remaining transaction of the same asset.\n");
+    printf("Only SUCCESS transactions pair as matched or amount-mismatch. Rows are\n");
+    printf("matched, amount-mismatch, missing (no transaction), extra (a transaction\n");
+    printf("without a ledger line) or not-settled (a pending or failed transaction,\n");
+    printf("with its ledger line if any). Amounts compare exactly.\n\n");
+    printf("Required arguments:\n");
+    printf("  --asset-pool-id <id>     The ID of the asset pool\n");
+    printf("  --ledger <path>          CSV of reference, amount, asset and optionally id, - for stdin.\n");
+    printf("                           A header row naming these columns may reorder them.\n\n");
+    printf("Optional arguments:\n");
+    printf("  --concurrency <n>        Requests in flight at once (default: %d)\n", DEFAULT_CONCURRENCY);
+}
@@ -0,0 +1,81 @@
+#ifndef RECONCILE_JOIN_H
+#define RECONCILE_JOIN_H
+
+#include "layer1_client.h"
+#include "amount.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// The reconcile command's ledger model and its per-reference join, shared
+// with the join's test. Not part of the public interface.
+
+#define NO_ASSET UINT16_MAX
+#define NO_MATCH (-1)
+
+typedef enum {
+    RESULT_MATCHED,
+    RESULT_AMOUNT_MISMATCH,
+    RESULT_MISSING,             // Ledger line without a transaction
+    RESULT_EXTRA,               // Transaction without a ledger line
+    RESULT_NOT_SETTLED,         // Transaction that has not succeeded, with its ledger line if any
+    RESULT_COUNT
+} ReconcileResult;
+
+// Where a listed transaction stands in the join
+enum {
+    TRANSACTION_OPEN,
+    TRANSACTION_PAIRED,
+    TRANSACTION_OTHER_REFERENCE,    // Returned by the query, but not for this reference
+    TRANSACTION_NOT_SETTLED         // Pending or failed: never matched, only explains a line
+};
+
+typedef struct {
+    AmountUnits units;
+    Layer1TransactionId id;
+    uint32_t group;             // Index of the line's reference
+    uint16_t asset;             // Index into the ledger's assets
+    bool has_id;
+    uint8_t result;
+    int match;                  // Transaction of the group it was paired with, or NO_MATCH
+} LedgerLine;
+
+typedef struct Reconciliation Reconciliation;
+
+// All ledger lines of one reference and the transactions listed for it
+typedef struct {
+    Reconciliation *run;
+    char *reference;
+    uint32_t first;             // Start of the group's lines in run->order
+    uint32_t count;
+    TransactionListResponse *transactions;
+    uint8_t *states;            // TRANSACTION_* per listed transaction
+    const char *error;
+} ReferenceGroup;
+
+struct Reconciliation {
+    Layer1Client *client;
+    const char *asset_pool_id;
+    LedgerLine *lines;
+    uint32_t line_count;
+    uint32_t line_capacity;
+    uint32_t *order;            // Line indexes grouped by reference, in file order within a group
+    ReferenceGroup *groups;
+    uint32_t group_count;
+    uint32_t group_capacity;
+    uint32_t *group_slots;      // Open-addressed by reference: group index + 1, 0 when empty
+    size_t group_mask;
+    char **assets;              // Distinct ledger assets
+    int *scales;                // Decimals of each ledger asset
+    uint16_t asset_count;
+};
+
+// Join the group's ledger lines with its transactions. Lines with an id
+// pair with that transaction; the rest pair with an open transaction of the
+// same asset and amount. Only settled (SUCCESS) transactions pair that way;
+// a line left over may still pair with a pending or failed one by id or
+// exact amount, and is then not-settled. What remains pairs with any open
+// transaction of the same asset. Sets each line's result and match and the
+// group's states; false when out of memory.
+bool reconcile_join_group(ReferenceGroup *group);
+
+#endif /* RECONCILE_JOIN_H */
@@ -0,0 +1,417 @@
+#include "commands/summarize_transactions.h"
+#include "arg_parser.h"
+#include "amount.h"
+#include "output.h"
+#include "task_executor.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define GROUPABLE_FIELDS (TRANSACTION_FIELD_NETWORK | TRANSACTION_FIELD_ASSET | TRANSACTION_FIELD_STATUS)
+#define PARALLEL_MIN_ROWS 65536     // Smaller tables are summed on the calling thread
+#define ROWS_PER_SLICE 16384
+
+static Command summarize_transactions_command = {
+    .name = "summarize-transactions",
+    .description = "Count and sum transactions by network, asset and status",
+    .execute = execute_summarize_transactions_command,
+    .help = summarize_transactions_help
+};
+
+void register_summarize_transactions_command(void) {
+    register_command(&summarize_transactions_command);
+}
+
+// Totals of one network/asset/status combination, keyed by the three
+// interned codes
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+    uint64_t inexact;           // Rows whose amount is missing, not exact at the asset's scale, or overflowed
+    AmountUnits sum;
+    bool used;
+} Group;
+
+typedef struct {
+    Group *slots;
+    size_t mask;
+    size_t count;
+} GroupMap;
+
+// One contiguous range of rows, reduced into its own map
+typedef struct {
+    const TransactionTable *table;
+    const int *scales;          // Decimals per asset code
+    unsigned int group_by;
+    int begin;
+    int end;
+    GroupMap groups;
+    bool failed;
+} Slice;
+
+static uint64_t group_key(uint16_t network, uint16_t asset, uint16_t status) {
+    return ((uint64_t)network << 32) | ((uint64_t)asset << 16) | status;
+}
+
+static bool group_map_init(GroupMap *map) {
+    map->mask = 15;
+    map->count = 0;
+    map->slots = calloc(map->mask + 1, sizeof(Group));
+    return map->slots != NULL;
+}
+
+static Group *find_group(GroupMap *map, uint64_t key);
+
+static bool grow_group_map(GroupMap *map) {
+    GroupMap grown = { calloc((map->mask + 1) * 2, sizeof(Group)), map->mask * 2 + 1, 0 };
+    if (!grown.slots) {
+        return false;
+    }
+
+    for (size_t i = 0; i <= map->mask; i++) {
+        if (map->slots[i].used) {
+            Group *group = find_group(&grown, map->slots[i].key);
+            *group = map->slots[i];
+            grown.count++;
+        }
+    }
+
+    free(map->slots);
+    *map = grown;
+    return true;
+}
+
+// Slot holding key, or the empty slot where it belongs
+static Group *find_group(GroupMap *map, uint64_t key) {
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & map->mask;
+    while (map->slots[slot].used && map->slots[slot].key != key) {
+        slot = (slot + 1) & map->mask;
+    }
+    return &map->slots[slot];
+}
+
+static Group *get_group(GroupMap *map, uint64_t key) {
+    Group *group = find_group(map, key);
+    if (group->used) {
+        return group;
+    }
+
+    // Keep the map at most half full
+    if ((map->count + 1) * 2 > map->mask + 1) {
+        if (!grow_group_map(map)) {
+            return NULL;
+        }
+        group = find_group(map, key);
+    }
+
+    group->used = true;
+    group->key = key;
+    map->count++;
+    return group;
+}
+
+static void add_amount(Group *group, bool exact, AmountUnits units) {
+    AmountUnits sum;
+    group->count++;
+    if (!exact || __builtin_add_overflow(group->sum, units, &sum)) {
+        group->inexact++;
+        return;
+    }
+    group->sum = sum;
+}
+
+static void summarize_slice(Slice *slice) {
+    const TransactionTable *table = slice->table;
+    uint16_t no_code = TRANSACTION_TABLE_NO_CODE;
+    bool by_network = slice->group_by & TRANSACTION_FIELD_NETWORK;
+    bool by_status = slice->group_by & TRANSACTION_FIELD_STATUS;
+
+    for (int row = slice->begin; row < slice->end; row++) {
+        uint16_t asset = table->asset[row];
+        uint64_t key = group_key(by_network ? table->network[row] : no_code, asset,
+                                 by_status ? table->status[row] : no_code);
+        Group *group = get_group(&slice->groups, key);
+        if (!group) {
+            slice->failed = true;
+            return;
+        }
+
+        // Every amount is parsed exactly once, at its asset's scale
+        uint32_t offset = table->amount[row];
+        int scale = asset == no_code ? AMOUNT_DEFAULT_SCALE : slice->scales[asset];
+        AmountUnits units = 0;
+        bool exact = offset != TRANSACTION_TABLE_NO_OFFSET &&
+                     amount_parse(table->arena + offset, strlen(table->arena + offset), scale, &units);
+        add_amount(group, exact, units);
+    }
+}
+
+static void summarize_slice_task(TaskExecutor *executor, void *arg) {
+    summarize_slice((Slice *)arg);
+}
+
+static bool merge_groups(GroupMap *into, const GroupMap *from) {
+    for (size_t i = 0; i <= from->mask; i++) {
+        const Group *source = &from->slots[i];
+        if (!source->used) {
+            continue;
+        }
+
+        Group *group = get_group(into, source->key);
+        if (!group) {
+            return false;
+        }
+        AmountUnits sum;
+        group->count += source->count;
+        group->inexact += source->inexact;
+        if (__builtin_add_overflow(group->sum, source->sum, &sum)) {
+            group->inexact += source->count - source->inexact;
+        } else {
+            group->sum = sum;
+        }
+    }
+    return true;
+}
+
+// Split the rows over threads workers, then fold every slice into the first
+static bool summarize_table(const TransactionTable *table, const int *scales, unsigned int group_by,
+                            int threads, GroupMap *groups) {
+    int slice_count = 1;
+    if (threads > 1 && table->count >= PARALLEL_MIN_ROWS) {
+        slice_count = (table->count + ROWS_PER_SLICE - 1) / ROWS_PER_SLICE;
+    }
+
+    Slice *slices = calloc((size_t)slice_count, sizeof(Slice));
+    if (!slices) {
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < slice_count; i++) {
+        slices[i].table = table;
+        slices[i].scales = scales;
+        slices[i].group_by = group_by;
+        slices[i].begin = (int)((long)table->count * i / slice_count);
+        slices[i].end = (int)((long)table->count * (i + 1) / slice_count);
+        ok = ok && group_map_init(&slices[i].groups);
+    }
+
+    if (ok && slice_count == 1) {
+        summarize_slice(&slices[0]);
+    } else if (ok) {
+        // Slices are small enough for idle workers to even out the load
+        TaskExecutor *executor = task_executor_create(threads);
+        for (int i = 0; executor && i < slice_count; i++) {
+            if (!task_executor_submit(executor, summarize_slice_task, &slices[i])) {
+                summarize_slice(&slices[i]);
+            }
+        }
+        if (executor) {
+            task_executor_wait(executor);
+            task_executor_destroy(executor);
+        } else {
+            for (int i = 0; i < slice_count; i++) {
+                summarize_slice(&slices[i]);
+            }
+        }
+    }
+
+    for (int i = 0; i < slice_count; i++) {
+        ok = ok && !slices[i].failed;
+        if (i > 0 && ok) {
+            ok = merge_groups(&slices[0].groups, &slices[i].groups);
+        }
+        if (i > 0) {
+            free(slices[i].groups.slots);
+        }
+    }
+
+    *groups = slices[0].groups;
+    free(slices);
+    if (!ok) {
+        free(groups->slots);
+        groups->slots = NULL;
+    }
+    return ok;
+}
+
+typedef struct {
+    const Group *group;
+    const char *network;
+    const char *asset;
+    const char *status;
+} SummaryRow;
+
+static const char *dictionary_value(const TransactionTable *table, const TransactionDictionary *dictionary,
+                                    uint16_t code) {
+    return code == TRANSACTION_TABLE_NO_CODE ? NULL : table->arena + dictionary->values[code];
+}
+
+static int compare_text(const char *a, const char *b) {
+    if (!a || !b) {
+        return (a != NULL) - (b != NULL);
+    }
+    return strcmp(a, b);
+}
+
+static int compare_rows(const void *a, const void *b) {
+    const SummaryRow *left = (const SummaryRow *)a;
+    const SummaryRow *right = (const SummaryRow *)b;
+    int order = compare_text(left->network, right->network);
+    if (order == 0) {
+        order = compare_text(left->asset, right->asset);
+    }
+    if (order == 0) {
+        order = compare_text(left->status, right->status);
+    }
+    return order;
+}
+
+static const char *const summary_columns[] = { "network", "asset", "status", "count", "sum" };
+static const OutputSchema summary_schema = { summary_columns, 5 };
+
+static void print_summary(const SummaryRow *rows, size_t count, const TransactionTable *table) {
+    bool text = output_format() == OUTPUT_TEXT;
+    if (text) {
+        printf("%-12s %-8s %-10s %10s  %s\n", "Network", "Asset", "Status", "Count", "Sum");
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const SummaryRow *row = &rows[i];
+        char sum[AMOUNT_FORMAT_SIZE];
+        amount_format(row->group->sum, amount_scale_for_asset(row->asset), sum);
+
+        if (text) {
+            printf("%-12s %-8s %-10s %10llu  %s\n",
+                   row->network ? row->network : "-", row->asset ? row->asset : "-",
+                   row->status ? row->status : "-", (unsigned long long)row->group->count, sum);
+            continue;
+        }
+
+        // The sum stays a string so JSON readers do not round it through a double
+        char count_text[24];
+        snprintf(count_text, sizeof(count_text), "%llu", (unsigned long long)row->group->count);
+        output_begin_record(&summary_schema);
+        output_string(row->network);
+        output_string(row->asset);
+        output_string(row->status);
+        output_literal(count_text);
+        output_string(sum);
+        output_end_record();
+    }
+}
+
+bool execute_summarize_transactions_command(Layer1Client *client, int argc, char **argv) {
+    CommandArgs *args = parse_command_args(argc, argv);
+    if (!args) {
+        fprintf(stderr, "Error: Failed to parse arguments\n");
+        return false;
+    }
+
+    const char *asset_pool_id = get_arg_value(args, "asset-pool-id");
+    const char *reference = get_arg_value(args, "reference");
+    const char *by = get_arg_value(args, "by");
+    const char *threads_arg = get_arg_value(args, "threads");
+
+    if (!asset_pool_id || !reference) {
+        fprintf(stderr, "Error: Missing required arguments\n");
+        summarize_transactions_help();
+        free_command_args(args);
+        return false;
+    }
+
+    // Sums only make sense within one asset, so the asset is always grouped on
+    unsigned int group_by = GROUPABLE_FIELDS;
+    if (by && (!layer1_parse_transaction_fields(by, &group_by) || (group_by & ~GROUPABLE_FIELDS))) {
+        fprintf(stderr, "Error: --by takes network, asset and status\n");
+        free_command_args(args);
+        return false;
+    }
+    group_by |= TRANSACTION_FIELD_ASSET;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = threads_arg ? atoi(threads_arg) : (int)(cpus > 0 ? cpus : 1);
+    if (threads <= 0) {
+        fprintf(stderr, "Error: --threads must be a positive number\n");
+        free_command_args(args);
+        return false;
+    }
+
+    char query[LAYER1_QUERY_SIZE];
+    if (!layer1_build_reference_query(query, sizeof(query), reference, "type:(deposit+withdrawal)")) {
+        fprintf(stderr, "Error: --reference is too long\n");
+        free_command_args(args);
+        return false;
+    }
+
+    TransactionTable *table = layer1_list_transactions_table(client, asset_pool_id, query,
+                                                             group_by | TRANSACTION_FIELD_AMOUNT);
+    if (!table) {
+        fprintf(stderr, "Error: Failed to list transactions\n");
+        free_command_args(args);
+        return false;
+    }
+
+    // Decimals are looked up once per distinct asset, not once per row
+    int *scales = malloc(sizeof(int) * (table->assets.count + 1u));
+    GroupMap groups = { NULL, 0, 0 };
+    bool ok = scales != NULL;
+    for (uint16_t i = 0; ok && i < table->assets.count; i++) {
+        scales[i] = amount_scale_for_asset(table->arena + table->assets.values[i]);
+    }
+    ok = ok && summarize_table(table, scales, group_by, threads, &groups);
+
+    SummaryRow *rows = ok ? malloc(sizeof(SummaryRow) * (groups.count + 1)) : NULL;
+    if (!rows) {
+        fprintf(stderr, "Error: Failed to summarize transactions\n");
+        free(groups.slots);
+        free(scales);
+        layer1_free_transaction_table(table);
+        free_command_args(args);
+        return false;
+    }
+
+    size_t count = 0;
+    uint64_t inexact = 0;
+    for (size_t i = 0; i <= groups.mask; i++) {
+        const Group *group = &groups.slots[i];
+        if (!group->used) {
+            continue;
+        }
+        rows[count].group = group;
+        rows[count].network = dictionary_value(table, &table->networks, (uint16_t)(group->key >> 32));
+        rows[count].asset = dictionary_value(table, &table->assets, (uint16_t)(group->key >> 16));
+        rows[count].status = dictionary_value(table, &table->statuses, (uint16_t)group->key);
+        inexact += group->inexact;
+        count++;
+    }
+    qsort(rows, count, sizeof(SummaryRow), compare_rows);
+    print_summary(rows, count, table);
+
+    if (inexact > 0) {
+        fprintf(stderr, "Warning: %llu amounts were missing or not exact and are left out of the sums\n",
+                (unsigned long long)inexact);
+    }
+
+    // Clean up
+    free(rows);
+    free(groups.slots);
+    free(scales);
+    layer1_free_transaction_table(table);
+    free_command_args(args);
+    return true;
+}
+
+void summarize_transactions_help(void) {
+    printf("Usage: summarize-transactions --asset-pool-id <id> --reference <reference> [--by <columns>] [--threads <n>]\n\n");
+    printf("Count transactions and sum their amounts exactly, per network, asset and status.\n");
+    printf("Amounts are parsed once into fixed-point integers at each asset's decimals.\n\n");
+    printf("Required arguments:\n");
+    printf("  --asset-pool-id <id>     The ID of the asset pool\n");
+    printf("  --reference <reference>  The reference to search for\n\n");
+    printf("Optional arguments:\n");
+    printf("  --by <columns>           Comma-separated network, asset, status (default: all three).\n");
+    printf("                           Sums are always kept per asset.\n");
+    printf("  --threads <n>            Threads summing %d transactions or more (default: CPUs)\n", PARALLEL_MIN_ROWS);
+}
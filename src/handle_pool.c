@@ -0,0 +1,129 @@
+#include "handle_pool.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+struct HandlePool {
+    pthread_mutex_t lock;
+    PooledHandle *idle;
+    CURLSH *share;
+    pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+};
+
+static void lock_share(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
+    HandlePool *pool = (HandlePool *)userptr;
+    pthread_mutex_lock(&pool->share_locks[data]);
+}
+
+static void unlock_share(CURL *handle, curl_lock_data data, void *userptr) {
+    HandlePool *pool = (HandlePool *)userptr;
+    pthread_mutex_unlock(&pool->share_locks[data]);
+}
+
+HandlePool *handle_pool_create(void) {
+    HandlePool *pool = calloc(1, sizeof(HandlePool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->share = curl_share_init();
+    if (!pool->share) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&pool->share_locks[i], NULL);
+    }
+
+    // DNS results and TLS sessions are shared across threads. libcurl does
+    // not support sharing live connections between concurrent threads, so
+    // each handle keeps its own and reuses them on its next request.
+    curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, lock_share);
+    curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+    curl_share_setopt(pool->share, CURLSHOPT_USERDATA, pool);
+    curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    return pool;
+}
+
+static void free_handle(PooledHandle *handle) {
+    if (handle->curl) {
+        curl_easy_cleanup(handle->curl);
+    }
+    request_body_destroy(handle->request_body);
+    free(handle->response.memory);
+    free(handle);
+}
+
+void handle_pool_destroy(HandlePool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    // Easy handles have to let go of the share before it can be cleaned up
+    PooledHandle *handle = pool->idle;
+    while (handle) {
+        PooledHandle *next = handle->next;
+        free_handle(handle);
+        handle = next;
+    }
+
+    curl_share_cleanup(pool->share);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&pool->share_locks[i]);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+static PooledHandle *create_handle(void) {
+    PooledHandle *handle = calloc(1, sizeof(PooledHandle));
+    if (!handle) {
+        return NULL;
+    }
+
+    handle->curl = curl_easy_init();
+    handle->request_body = request_body_create(512);
+    if (!handle->curl || !handle->request_body) {
+        fprintf(stderr, "Failed to initialize a request handle\n");
+        free_handle(handle);
+        return NULL;
+    }
+
+    return handle;
+}
+
+PooledHandle *handle_pool_acquire(HandlePool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    PooledHandle *handle = pool->idle;
+    if (handle) {
+        pool->idle = handle->next;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!handle) {
+        handle = create_handle();
+        if (!handle) {
+            return NULL;
+        }
+    }
+
+    handle->next = NULL;
+    curl_easy_reset(handle->curl);
+    curl_easy_setopt(handle->curl, CURLOPT_SHARE, pool->share);
+    return handle;
+}
+
+void handle_pool_release(HandlePool *pool, PooledHandle *handle) {
+    if (!handle) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    handle->next = pool->idle;
+    pool->idle = handle;
+    pthread_mutex_unlock(&pool->lock);
+}
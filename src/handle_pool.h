@@ -0,0 +1,31 @@
+#ifndef HANDLE_POOL_H
+#define HANDLE_POOL_H
+
+#include "layer1_client.h"
+#include "request_body.h"
+
+// Everything one request mutates. A handle is used by one thread at a time,
+// between handle_pool_acquire and handle_pool_release.
+typedef struct PooledHandle {
+    CURL *curl;                 // Keeps its own connections alive between requests
+    RequestBody *request_body;
+    MemoryStruct response;
+    struct PooledHandle *next;  // Idle list link
+} PooledHandle;
+
+typedef struct HandlePool HandlePool;
+
+// Create an empty pool; handles are created on demand
+HandlePool *handle_pool_create(void);
+
+// Free the pool and every idle handle. No handle may still be checked out.
+void handle_pool_destroy(HandlePool *pool);
+
+// Take an idle handle, or create one when all of them are in use. The easy
+// handle is reset and attached to the pool's DNS and TLS session cache.
+PooledHandle *handle_pool_acquire(HandlePool *pool);
+
+// Return a handle for reuse by any thread
+void handle_pool_release(HandlePool *pool, PooledHandle *handle);
+
+#endif // HANDLE_POOL_H
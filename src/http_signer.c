@@ -11,6 +11,8 @@
 #include <openssl/err.h>
 #include <openssl/core_names.h>
 #include <openssl/decoder.h>
+#include <openssl/ec.h>
+#include <openssl/bn.h>
 
 // Base64 encoding function
 static char *base64_encode(const unsigned char *input, int length) {
@@ -39,6 +41,44 @@ static char *base64_encode(const unsigned char *input, int length) {
     return result;
 }
 
+// Map the loaded key to the signature algorithm used for it
+static bool detect_signature_algorithm(EVP_PKEY *key, SignatureAlgorithm *algorithm) {
+    if (EVP_PKEY_is_a(key, "RSA")) {
+        *algorithm = SIGNATURE_ALG_RSA_V1_5_SHA256;
+        return true;
+    }
+
+    if (EVP_PKEY_is_a(key, "ED25519")) {
+        *algorithm = SIGNATURE_ALG_ED25519;
+        return true;
+    }
+
+    if (EVP_PKEY_is_a(key, "EC")) {
+        char group[64];
+        size_t group_len = 0;
+        if (EVP_PKEY_get_utf8_string_param(key, OSSL_PKEY_PARAM_GROUP_NAME,
+                                           group, sizeof(group), &group_len) == 1 &&
+            (strcmp(group, "prime256v1") == 0 || strcmp(group, "P-256") == 0)) {
+            *algorithm = SIGNATURE_ALG_ECDSA_P256_SHA256;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char *signature_algorithm_name(SignatureAlgorithm algorithm) {
+    switch (algorithm) {
+        case SIGNATURE_ALG_ECDSA_P256_SHA256:
+            return "ecdsa-p256-sha256";
+        case SIGNATURE_ALG_ED25519:
+            return "ed25519";
+        case SIGNATURE_ALG_RSA_V1_5_SHA256:
+        default:
+            return "rsa-v1_5-sha256";
+    }
+}
+
 HttpSigner *http_signer_create(const char *private_key, const char *client_id) {
     if (!private_key || !client_id) {
         return NULL;
@@ -52,6 +92,7 @@ HttpSigner *http_signer_create(const char *private_key, const char *client_id) {
     // Initialize with NULL values
     signer->signing_key = NULL;
     signer->client_id = NULL;
+    signer->algorithm = SIGNATURE_ALG_RSA_V1_5_SHA256;
 
     // Prepare the private key
     char *prepared_key = prepare_key(private_key);
@@ -82,7 +123,7 @@ HttpSigner *http_signer_create(const char *private_key, const char *client_id) {
         OSSL_DECODER_CTX *dctx = OSSL_DECODER_CTX_new_for_pkey(&signer->signing_key,
                                                               "PEM",   // Input format
                                                               NULL,    // Input type
-                                                              "RSA",   // Key type
+                                                              NULL,    // Key type
                                                               OSSL_KEYMGMT_SELECT_PRIVATE_KEY,
                                                               NULL,    // Selection criteria
                                                               NULL);   // Library context
@@ -107,6 +148,14 @@ HttpSigner *http_signer_create(const char *private_key, const char *client_id) {
     
     free(prepared_key);
 
+    // Pick the signature algorithm matching the key type
+    if (!detect_signature_algorithm(signer->signing_key, &signer->algorithm)) {
+        fprintf(stderr, "Unsupported private key type: expected RSA, Ed25519 or ECDSA P-256\n");
+        EVP_PKEY_free(signer->signing_key);
+        free(signer);
+        return NULL;
+    }
+
     // Copy client ID
     signer->client_id = strdup(client_id);
     if (!signer->client_id) {
@@ -118,6 +167,27 @@ HttpSigner *http_signer_create(const char *private_key, const char *client_id) {
     return signer;
 }
 
+HttpSigner *http_signer_dup(const HttpSigner *signer) {
+    if (!signer) {
+        return NULL;
+    }
+
+    HttpSigner *copy = (HttpSigner *)malloc(sizeof(HttpSigner));
+    if (!copy) {
+        return NULL;
+    }
+
+    copy->algorithm = signer->algorithm;
+    copy->signing_key = EVP_PKEY_dup(signer->signing_key);
+    copy->client_id = strdup(signer->client_id);
+    if (!copy->signing_key || !copy->client_id) {
+        http_signer_destroy(copy);
+        return NULL;
+    }
+
+    return copy;
+}
+
 void http_signer_destroy(HttpSigner *signer) {
     if (!signer) {
         return;
@@ -160,7 +230,15 @@ char *create_digest(const char *algorithm, const char *data) {
     
     EVP_MD_CTX_free(mdctx);
 
-    char *base64_hash = base64_encode(hash, SHA256_DIGEST_LENGTH);
+    return format_digest(algorithm, hash, SHA256_DIGEST_LENGTH);
+}
+
+char *format_digest(const char *algorithm, const unsigned char *hash, size_t hash_len) {
+    if (!algorithm || !hash) {
+        return NULL;
+    }
+
+    char *base64_hash = base64_encode(hash, (int)hash_len);
     if (!base64_hash) {
         return NULL;
     }
@@ -178,66 +256,99 @@ char *create_digest(const char *algorithm, const char *data) {
     return result;
 }
 
-char *create_signature_parameters(const char *client_id, const char *content_digest) {
+char *create_signature_parameters(const char *client_id, const char *content_digest, SignatureAlgorithm algorithm) {
     time_t now = time(NULL);
-    
-    // Format: ("@method" "@target-uri" "content-digest");created=timestamp;keyid="client_id";alg="rsa-v1_5-sha256"
-    size_t result_len = 100 + (content_digest ? 20 : 0) + strlen(client_id);
+    const char *alg = signature_algorithm_name(algorithm);
+
+    // Format: ("@method" "@target-uri" "content-digest");created=timestamp;keyid="client_id";alg="<alg>"
+    // where <alg> follows the loaded key type (rsa-v1_5-sha256, ecdsa-p256-sha256 or ed25519)
+    size_t result_len = 100 + (content_digest ? 20 : 0) + strlen(client_id) + strlen(alg);
     char *result = (char *)malloc(result_len);
     if (!result) {
         return NULL;
     }
 
     if (content_digest) {
-        snprintf(result, result_len, "(\"@method\" \"@target-uri\" \"content-digest\");created=%ld;keyid=\"%s\";alg=\"rsa-v1_5-sha256\"", 
-                 now, client_id);
+        snprintf(result, result_len, "(\"@method\" \"@target-uri\" \"content-digest\");created=%ld;keyid=\"%s\";alg=\"%s\"", 
+                 now, client_id, alg);
     } else {
-        snprintf(result, result_len, "(\"@method\" \"@target-uri\");created=%ld;keyid=\"%s\";alg=\"rsa-v1_5-sha256\"", 
-                 now, client_id);
+        snprintf(result, result_len, "(\"@method\" \"@target-uri\");created=%ld;keyid=\"%s\";alg=\"%s\"", 
+                 now, client_id, alg);
     }
 
     return result;
 }
 
-char *sign_request(EVP_PKEY *private_key, const char *signature_base) {
-    if (!private_key || !signature_base) {
-        return NULL;
+// ECDSA signatures come out of OpenSSL DER encoded, HTTP message signatures
+// expect the fixed-size r || s concatenation instead
+static bool ecdsa_der_to_raw(const unsigned char *der, size_t der_len, unsigned char *raw, size_t coord_len) {
+    const unsigned char *p = der;
+    ECDSA_SIG *ecdsa_sig = d2i_ECDSA_SIG(NULL, &p, (long)der_len);
+    if (!ecdsa_sig) {
+        return false;
     }
 
+    const BIGNUM *r = NULL;
+    const BIGNUM *s = NULL;
+    ECDSA_SIG_get0(ecdsa_sig, &r, &s);
+
+    bool ok = BN_bn2binpad(r, raw, (int)coord_len) == (int)coord_len &&
+              BN_bn2binpad(s, raw + coord_len, (int)coord_len) == (int)coord_len;
+
+    ECDSA_SIG_free(ecdsa_sig);
+    return ok;
+}
+
+char *sign_request(EVP_PKEY *private_key, SignatureAlgorithm algorithm, const char *signature_base) {
     EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
     if (!md_ctx) {
         return NULL;
     }
 
-    if (EVP_DigestSignInit(md_ctx, NULL, EVP_sha256(), NULL, private_key) != 1) {
-        EVP_MD_CTX_free(md_ctx);
+    char *signature = sign_request_with_ctx(md_ctx, private_key, algorithm, signature_base);
+    EVP_MD_CTX_free(md_ctx);
+    return signature;
+}
+
+char *sign_request_with_ctx(EVP_MD_CTX *md_ctx, EVP_PKEY *private_key, SignatureAlgorithm algorithm, const char *signature_base) {
+    if (!md_ctx || !private_key || !signature_base) {
         return NULL;
     }
 
-    if (EVP_DigestSignUpdate(md_ctx, signature_base, strlen(signature_base)) != 1) {
-        EVP_MD_CTX_free(md_ctx);
+    // The context may carry state from a previous signature
+    EVP_MD_CTX_reset(md_ctx);
+
+    // Ed25519 hashes internally and must not be given a digest
+    const EVP_MD *md = algorithm == SIGNATURE_ALG_ED25519 ? NULL : EVP_sha256();
+    if (EVP_DigestSignInit(md_ctx, NULL, md, NULL, private_key) != 1) {
         return NULL;
     }
 
+    size_t base_len = strlen(signature_base);
     size_t sig_len = 0;
-    if (EVP_DigestSignFinal(md_ctx, NULL, &sig_len) != 1) {
-        EVP_MD_CTX_free(md_ctx);
+    if (EVP_DigestSign(md_ctx, NULL, &sig_len, (const unsigned char *)signature_base, base_len) != 1) {
         return NULL;
     }
 
     unsigned char *sig = (unsigned char *)malloc(sig_len);
     if (!sig) {
-        EVP_MD_CTX_free(md_ctx);
         return NULL;
     }
 
-    if (EVP_DigestSignFinal(md_ctx, sig, &sig_len) != 1) {
+    if (EVP_DigestSign(md_ctx, sig, &sig_len, (const unsigned char *)signature_base, base_len) != 1) {
         free(sig);
-        EVP_MD_CTX_free(md_ctx);
         return NULL;
     }
 
-    EVP_MD_CTX_free(md_ctx);
+    if (algorithm == SIGNATURE_ALG_ECDSA_P256_SHA256) {
+        unsigned char raw[64];
+        if (!ecdsa_der_to_raw(sig, sig_len, raw, 32)) {
+            free(sig);
+            return NULL;
+        }
+        free(sig);
+        return base64_encode(raw, sizeof(raw));
+    }
 
     char *base64_sig = base64_encode(sig, sig_len);
     free(sig);
@@ -257,26 +368,45 @@ char *prepare_key(const char *raw_key) {
 bool http_signer_add_headers(HttpSigner *signer, CURL *curl, const char *url, 
                             const char *payload, const char *method, 
                             struct curl_slist **headers) {
-    if (!signer || !curl || !url || !method || !headers) {
+    if (!curl) {
         return false;
     }
 
+    return http_signer_add_headers_with_ctx(signer, NULL, url, payload, method, headers);
+}
+
+bool http_signer_add_headers_with_ctx(HttpSigner *signer, EVP_MD_CTX *md_ctx, const char *url,
+                                      const char *payload, const char *method,
+                                      struct curl_slist **headers) {
     char *content_digest = NULL;
     if (payload && strlen(payload) > 0) {
         content_digest = create_digest("sha-256", payload);
         if (!content_digest) {
             return false;
         }
-        
+    }
+
+    bool result = http_signer_add_headers_for_digest(signer, md_ctx, url, content_digest, method, headers);
+    free(content_digest);
+    return result;
+}
+
+bool http_signer_add_headers_for_digest(HttpSigner *signer, EVP_MD_CTX *md_ctx, const char *url,
+                                        const char *content_digest, const char *method,
+                                        struct curl_slist **headers) {
+    if (!signer || !url || !method || !headers) {
+        return false;
+    }
+
+    if (content_digest) {
         char digest_header[1024];
         snprintf(digest_header, sizeof(digest_header), "Content-Digest: %s", content_digest);
         *headers = curl_slist_append(*headers, digest_header);
     }
 
     // Create signature parameters
-    char *sig_params = create_signature_parameters(signer->client_id, content_digest);
+    char *sig_params = create_signature_parameters(signer->client_id, content_digest, signer->algorithm);
     if (!sig_params) {
-        free(content_digest);
         return false;
     }
 
@@ -291,7 +421,6 @@ bool http_signer_add_headers(HttpSigner *signer, CURL *curl, const char *url,
         size_t sig_base_len = strlen(method) + strlen(url) + strlen(content_digest) + strlen(sig_params) + 100;
         signature_base = (char *)malloc(sig_base_len);
         if (!signature_base) {
-            free(content_digest);
             free(sig_params);
             return false;
         }
@@ -311,9 +440,10 @@ bool http_signer_add_headers(HttpSigner *signer, CURL *curl, const char *url,
     }
 
     // Sign the request
-    char *signature = sign_request(signer->signing_key, signature_base);
+    char *signature = md_ctx
+        ? sign_request_with_ctx(md_ctx, signer->signing_key, signer->algorithm, signature_base)
+        : sign_request(signer->signing_key, signer->algorithm, signature_base);
     if (!signature) {
-        free(content_digest);
         free(sig_params);
         free(signature_base);
         return false;
@@ -325,7 +455,6 @@ bool http_signer_add_headers(HttpSigner *signer, CURL *curl, const char *url,
     *headers = curl_slist_append(*headers, sig_header);
 
     // Clean up
-    free(content_digest);
     free(sig_params);
     free(signature_base);
     free(signature);
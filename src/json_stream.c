@@ -0,0 +1,416 @@
+#include "json_stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_ARRAY_END,
+    EXPECT_KEY,
+    EXPECT_KEY_OR_OBJECT_END,
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_END,
+    EXPECT_DONE
+};
+
+enum {
+    TOKEN_NONE,
+    TOKEN_KEY,
+    TOKEN_STRING,
+    TOKEN_NUMBER,
+    TOKEN_LITERAL
+};
+
+void json_stream_init(JsonStream *stream, JsonEventHandler handler, void *user_data) {
+    memset(stream, 0, sizeof(JsonStream));
+    stream->handler = handler;
+    stream->user_data = user_data;
+    stream->expect = EXPECT_VALUE;
+    stream->token = TOKEN_NONE;
+}
+
+void json_stream_free(JsonStream *stream) {
+    if (!stream) {
+        return;
+    }
+
+    free(stream->scratch);
+    stream->scratch = NULL;
+    stream->scratch_length = 0;
+    stream->scratch_capacity = 0;
+}
+
+static bool is_whitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static bool is_literal_char(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+static bool parse_hex4(const char *p, unsigned int *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char ch = p[i];
+        *value <<= 4;
+        if (ch >= '0' && ch <= '9') {
+            *value |= (unsigned int)(ch - '0');
+        } else if (ch >= 'a' && ch <= 'f') {
+            *value |= (unsigned int)(ch - 'a' + 10);
+        } else if (ch >= 'A' && ch <= 'F') {
+            *value |= (unsigned int)(ch - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t encode_utf8(unsigned long codepoint, char *out) {
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char)(0xC0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char)(0xE0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (codepoint >> 18));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+// Decode the escapes in [p, end) in place; the output is never longer
+static bool unescape_in_place(char *p, size_t *length) {
+    const char *in = p;
+    const char *end = p + *length;
+    char *out = p;
+
+    while (in < end) {
+        if (*in != '\\') {
+            *out++ = *in++;
+            continue;
+        }
+
+        if (in + 1 >= end) {
+            return false;
+        }
+
+        switch (in[1]) {
+            case '"':  *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/':  *out++ = '/'; break;
+            case 'b':  *out++ = '\b'; break;
+            case 'f':  *out++ = '\f'; break;
+            case 'n':  *out++ = '\n'; break;
+            case 'r':  *out++ = '\r'; break;
+            case 't':  *out++ = '\t'; break;
+            case 'u': {
+                unsigned int first;
+                if (end - in < 6 || !parse_hex4(in + 2, &first)) {
+                    return false;
+                }
+                unsigned long codepoint = first;
+                in += 6;
+
+                if (first >= 0xD800 && first <= 0xDBFF) {
+                    unsigned int second;
+                    if (end - in < 6 || in[0] != '\\' || in[1] != 'u' ||
+                        !parse_hex4(in + 2, &second) || second < 0xDC00 || second > 0xDFFF) {
+                        return false;
+                    }
+                    codepoint = 0x10000 + (((unsigned long)(first & 0x3FF) << 10) | (second & 0x3FF));
+                    in += 6;
+                } else if (first >= 0xDC00 && first <= 0xDFFF) {
+                    return false;
+                }
+
+                out += encode_utf8(codepoint, out);
+                continue;
+            }
+            default:
+                return false;
+        }
+        in += 2;
+    }
+
+    *length = (size_t)(out - p);
+    return true;
+}
+
+static bool append_scratch(JsonStream *stream, const char *data, size_t length) {
+    if (stream->scratch_length + length > stream->scratch_capacity) {
+        size_t capacity = stream->scratch_capacity ? stream->scratch_capacity * 2 : 256;
+        while (capacity < stream->scratch_length + length) {
+            capacity *= 2;
+        }
+
+        char *scratch = realloc(stream->scratch, capacity);
+        if (!scratch) {
+            stream->error = true;
+            return false;
+        }
+        stream->scratch = scratch;
+        stream->scratch_capacity = capacity;
+    }
+
+    memcpy(stream->scratch + stream->scratch_length, data, length);
+    stream->scratch_length += length;
+    return true;
+}
+
+static void emit(JsonStream *stream, JsonEventType type, const char *value, size_t length) {
+    if (!stream->handler(stream->user_data, type, value, length)) {
+        stream->error = true;
+    }
+}
+
+static void value_done(JsonStream *stream) {
+    stream->expect = stream->depth == 0 ? EXPECT_DONE : EXPECT_COMMA_OR_END;
+}
+
+static void open_container(JsonStream *stream, char open) {
+    if (stream->depth >= JSON_STREAM_MAX_DEPTH) {
+        stream->error = true;
+        return;
+    }
+
+    stream->stack[stream->depth++] = open;
+    if (open == '{') {
+        stream->expect = EXPECT_KEY_OR_OBJECT_END;
+        emit(stream, JSON_EVENT_OBJECT_START, NULL, 0);
+    } else {
+        stream->expect = EXPECT_VALUE_OR_ARRAY_END;
+        emit(stream, JSON_EVENT_ARRAY_START, NULL, 0);
+    }
+}
+
+static void close_container(JsonStream *stream, char close) {
+    char open = close == '}' ? '{' : '[';
+    if (stream->depth == 0 || stream->stack[stream->depth - 1] != open) {
+        stream->error = true;
+        return;
+    }
+
+    stream->depth--;
+    emit(stream, close == '}' ? JSON_EVENT_OBJECT_END : JSON_EVENT_ARRAY_END, NULL, 0);
+    value_done(stream);
+}
+
+// Finish the current token from [start, stop) plus whatever earlier chunks left in scratch
+static void complete_token(JsonStream *stream, const char *start, const char *stop) {
+    const char *value = start;
+    size_t length = (size_t)(stop - start);
+    bool is_text = stream->token == TOKEN_KEY || stream->token == TOKEN_STRING;
+
+    if (stream->scratch_length > 0 || (is_text && stream->token_escaped)) {
+        if (!append_scratch(stream, start, length)) {
+            return;
+        }
+        value = stream->scratch;
+        length = stream->scratch_length;
+
+        if (is_text && stream->token_escaped && !unescape_in_place(stream->scratch, &length)) {
+            stream->error = true;
+            return;
+        }
+    }
+
+    int token = stream->token;
+    stream->token = TOKEN_NONE;
+    stream->token_escaped = false;
+    stream->scratch_length = 0;
+
+    switch (token) {
+        case TOKEN_KEY:
+            emit(stream, JSON_EVENT_KEY, value, length);
+            stream->expect = EXPECT_COLON;
+            return;
+        case TOKEN_STRING:
+            emit(stream, JSON_EVENT_STRING, value, length);
+            break;
+        case TOKEN_NUMBER:
+            emit(stream, JSON_EVENT_NUMBER, value, length);
+            break;
+        case TOKEN_LITERAL:
+            if (length == 4 && memcmp(value, "true", 4) == 0) {
+                emit(stream, JSON_EVENT_TRUE, NULL, 0);
+            } else if (length == 5 && memcmp(value, "false", 5) == 0) {
+                emit(stream, JSON_EVENT_FALSE, NULL, 0);
+            } else if (length == 4 && memcmp(value, "null", 4) == 0) {
+                emit(stream, JSON_EVENT_NULL, NULL, 0);
+            } else {
+                stream->error = true;
+                return;
+            }
+            break;
+        default:
+            stream->error = true;
+            return;
+    }
+
+    value_done(stream);
+}
+
+// Scan the token in progress; returns where structural parsing resumes
+static const char *continue_token(JsonStream *stream, const char *p, const char *end) {
+    const char *start = p;
+
+    if (stream->token == TOKEN_KEY || stream->token == TOKEN_STRING) {
+        if (stream->escape_pending) {
+            stream->escape_pending = false;
+            p++;
+        }
+
+        while (p < end) {
+            char c = *p;
+            if (c == '"') {
+                complete_token(stream, start, p);
+                return p + 1;
+            }
+            if (c == '\\') {
+                stream->token_escaped = true;
+                if (p + 1 >= end) {
+                    stream->escape_pending = true;
+                    break;
+                }
+                p += 2;
+                continue;
+            }
+            p++;
+        }
+
+        append_scratch(stream, start, (size_t)(end - start));
+        return end;
+    }
+
+    bool (*accepts)(char) = stream->token == TOKEN_NUMBER ? is_number_char : is_literal_char;
+    while (p < end && accepts(*p)) {
+        p++;
+    }
+
+    if (p < end) {
+        // The terminating byte is structural and is handled by the caller
+        complete_token(stream, start, p);
+        return p;
+    }
+
+    append_scratch(stream, start, (size_t)(end - start));
+    return end;
+}
+
+static void begin_value(JsonStream *stream, char c) {
+    if (c == '{' || c == '[') {
+        open_container(stream, c);
+    } else if (c == '"') {
+        stream->token = TOKEN_STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        stream->token = TOKEN_NUMBER;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        stream->token = TOKEN_LITERAL;
+    } else {
+        stream->error = true;
+    }
+}
+
+bool json_stream_feed(JsonStream *stream, const char *data, size_t length) {
+    if (!stream || stream->error) {
+        return false;
+    }
+
+    const char *p = data;
+    const char *end = data + length;
+
+    while (p < end && !stream->error) {
+        if (stream->token != TOKEN_NONE) {
+            p = continue_token(stream, p, end);
+            continue;
+        }
+
+        char c = *p;
+        if (is_whitespace(c)) {
+            p++;
+            continue;
+        }
+
+        switch (stream->expect) {
+            case EXPECT_VALUE_OR_ARRAY_END:
+                if (c == ']') {
+                    close_container(stream, c);
+                    p++;
+                    break;
+                }
+                // fall through
+            case EXPECT_VALUE:
+                begin_value(stream, c);
+                // Numbers and literals are scanned from their first byte
+                if (stream->token != TOKEN_NUMBER && stream->token != TOKEN_LITERAL) {
+                    p++;
+                }
+                break;
+            case EXPECT_KEY_OR_OBJECT_END:
+                if (c == '}') {
+                    close_container(stream, c);
+                    p++;
+                    break;
+                }
+                // fall through
+            case EXPECT_KEY:
+                if (c == '"') {
+                    stream->token = TOKEN_KEY;
+                } else {
+                    stream->error = true;
+                }
+                p++;
+                break;
+            case EXPECT_COLON:
+                if (c == ':') {
+                    stream->expect = EXPECT_VALUE;
+                } else {
+                    stream->error = true;
+                }
+                p++;
+                break;
+            case EXPECT_COMMA_OR_END:
+                if (c == ',') {
+                    stream->expect = stream->stack[stream->depth - 1] == '{' ? EXPECT_KEY : EXPECT_VALUE;
+                } else if (c == '}' || c == ']') {
+                    close_container(stream, c);
+                } else {
+                    stream->error = true;
+                }
+                p++;
+                break;
+            default:
+                stream->error = true;
+                break;
+        }
+    }
+
+    return !stream->error;
+}
+
+bool json_stream_finish(JsonStream *stream) {
+    if (!stream || stream->error) {
+        return false;
+    }
+
+    // A bare top-level number or literal has no terminator of its own
+    if ((stream->token == TOKEN_NUMBER || stream->token == TOKEN_LITERAL) && stream->depth == 0) {
+        complete_token(stream, stream->scratch + stream->scratch_length, stream->scratch + stream->scratch_length);
+    }
+
+    return !stream->error && stream->token == TOKEN_NONE && stream->expect == EXPECT_DONE;
+}
@@ -0,0 +1,55 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define JSON_STREAM_MAX_DEPTH 64
+
+typedef enum {
+    JSON_EVENT_OBJECT_START,
+    JSON_EVENT_OBJECT_END,
+    JSON_EVENT_ARRAY_START,
+    JSON_EVENT_ARRAY_END,
+    JSON_EVENT_KEY,
+    JSON_EVENT_STRING,
+    JSON_EVENT_NUMBER,
+    JSON_EVENT_TRUE,
+    JSON_EVENT_FALSE,
+    JSON_EVENT_NULL
+} JsonEventType;
+
+// Receives each token as soon as it is complete. Key and string values are
+// unescaped, numbers are passed as their source text. Values are not NUL
+// terminated and are only valid during the call. Return false to abort.
+typedef bool (*JsonEventHandler)(void *user_data, JsonEventType type, const char *value, size_t length);
+
+// Incremental, resumable JSON tokenizer. Input may be split at any byte.
+typedef struct {
+    JsonEventHandler handler;
+    void *user_data;
+
+    char stack[JSON_STREAM_MAX_DEPTH];  // '{' or '[' per open container
+    int depth;
+    int expect;
+
+    int token;                  // Token being scanned, carried across chunks
+    bool token_escaped;         // Token contains escape sequences
+    bool escape_pending;        // Previous chunk ended on a backslash
+    char *scratch;              // Holds a token split over several chunks
+    size_t scratch_length;
+    size_t scratch_capacity;
+
+    bool error;
+} JsonStream;
+
+void json_stream_init(JsonStream *stream, JsonEventHandler handler, void *user_data);
+void json_stream_free(JsonStream *stream);
+
+// Consume the next piece of input, false once the input is known to be invalid
+bool json_stream_feed(JsonStream *stream, const char *data, size_t length);
+
+// True when exactly one complete top-level value has been consumed
+bool json_stream_finish(JsonStream *stream);
+
+#endif // JSON_STREAM_H
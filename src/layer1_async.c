@@ -0,0 +1,613 @@
+#include "layer1_async.h"
+#include "client_internal.h"
+#include "request_encoder.h"
+#include "response_decoder.h"
+#include "signing_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef enum {
+    ASYNC_ADDRESS,
+    ASYNC_ADDRESS_LIST,
+    ASYNC_TRANSACTION,
+    ASYNC_TRANSACTION_LIST
+} AsyncKind;
+
+typedef enum {
+    ASYNC_SIGNING,              // Owned by a signing worker until it is queued as ready
+    ASYNC_READY,                // Signed, waiting for the loop thread to drain the pipe
+    ASYNC_TRANSFER              // Added to the multi handle
+} AsyncState;
+
+// One request in flight. Each event moves it one step further:
+// signing -> transfer (bodies of list responses are decoded as they arrive)
+// -> completion, where a create response is decoded from the handle's buffer.
+typedef struct AsyncRequest {
+    Layer1Async *async;
+    AsyncKind kind;
+    AsyncState state;
+    bool is_post;
+    PooledHandle *handle;
+    struct curl_slist *headers;
+    char url[2048];
+
+    SigningJob job;
+    char *content_digest;
+
+    char *asset_pool_id;        // Creates only: where a success makes cached lists stale
+    char *reference;
+
+    ResponseDecoder decoder;    // List requests only
+    void *list;                 // AddressListResponse or TransactionListResponse being filled
+
+    union {
+        Layer1AddressCallback address;
+        Layer1AddressListCallback address_list;
+        Layer1TransactionCallback transaction;
+        Layer1TransactionListCallback transaction_list;
+    } on_done;
+    void *user_data;
+
+    struct AsyncRequest *prev;  // All unfinished requests
+    struct AsyncRequest *next;
+    struct AsyncRequest *ready_next;
+} AsyncRequest;
+
+struct Layer1Async {
+    Layer1Client *client;
+    CURLM *multi;
+    Layer1SocketCallback on_socket;
+    Layer1TimerCallback on_timer;
+    void *user_data;
+
+    SigningPool *signers;
+    int wake_pipe[2];           // Written by signing workers when a request became ready
+    pthread_mutex_t ready_lock;
+    AsyncRequest *ready;        // Guarded by ready_lock
+
+    AsyncRequest *requests;
+    int in_flight;
+};
+
+static int forward_socket(CURL *easy, curl_socket_t fd, int what, void *userp, void *socketp) {
+    Layer1Async *async = (Layer1Async *)userp;
+    async->on_socket(async, fd, what, async->user_data, socketp);
+    return 0;
+}
+
+static int forward_timer(CURLM *multi, long timeout_ms, void *userp) {
+    Layer1Async *async = (Layer1Async *)userp;
+    async->on_timer(async, timeout_ms, async->user_data);
+    return 0;
+}
+
+Layer1Async *layer1_async_create(Layer1Client *client, int signing_workers,
+                                 Layer1SocketCallback on_socket, Layer1TimerCallback on_timer,
+                                 void *user_data) {
+    if (!client || !on_socket || !on_timer) {
+        return NULL;
+    }
+
+    Layer1Async *async = calloc(1, sizeof(Layer1Async));
+    if (!async) {
+        fprintf(stderr, "Failed to allocate memory for Layer1Async\n");
+        return NULL;
+    }
+
+    async->client = client;
+    async->on_socket = on_socket;
+    async->on_timer = on_timer;
+    async->user_data = user_data;
+    async->wake_pipe[0] = -1;
+    async->wake_pipe[1] = -1;
+    pthread_mutex_init(&async->ready_lock, NULL);
+
+    async->multi = curl_multi_init();
+    if (!async->multi) {
+        fprintf(stderr, "Failed to initialize curl multi handle\n");
+        layer1_async_destroy(async);
+        return NULL;
+    }
+    curl_multi_setopt(async->multi, CURLMOPT_SOCKETFUNCTION, forward_socket);
+    curl_multi_setopt(async->multi, CURLMOPT_SOCKETDATA, async);
+    curl_multi_setopt(async->multi, CURLMOPT_TIMERFUNCTION, forward_timer);
+    curl_multi_setopt(async->multi, CURLMOPT_TIMERDATA, async);
+
+    if (signing_workers > 0) {
+        if (pipe(async->wake_pipe) != 0) {
+            fprintf(stderr, "Failed to create signing wake-up pipe\n");
+            layer1_async_destroy(async);
+            return NULL;
+        }
+        for (int i = 0; i < 2; i++) {
+            fcntl(async->wake_pipe[i], F_SETFL, fcntl(async->wake_pipe[i], F_GETFL) | O_NONBLOCK);
+            fcntl(async->wake_pipe[i], F_SETFD, FD_CLOEXEC);
+        }
+
+        async->signers = signing_pool_create(client->signer, signing_workers);
+        if (!async->signers) {
+            layer1_async_destroy(async);
+            return NULL;
+        }
+        on_socket(async, async->wake_pipe[0], CURL_POLL_IN, user_data, NULL);
+    }
+
+    return async;
+}
+
+static void unlink_request(AsyncRequest *request) {
+    Layer1Async *async = request->async;
+    if (request->prev) {
+        request->prev->next = request->next;
+    } else {
+        async->requests = request->next;
+    }
+    if (request->next) {
+        request->next->prev = request->prev;
+    }
+    async->in_flight--;
+}
+
+// Release everything the request holds, then report result (NULL on failure)
+static void complete_request(AsyncRequest *request, void *result) {
+    Layer1Async *async = request->async;
+
+    if (request->state == ASYNC_TRANSFER) {
+        curl_multi_remove_handle(async->multi, request->handle->curl);
+    }
+    curl_slist_free_all(request->headers);
+    free(request->content_digest);
+    free(request->asset_pool_id);
+    free(request->reference);
+    if (!request->is_post) {
+        response_decoder_free(&request->decoder);
+    }
+    layer1_release_handle(async->client, request->handle);
+    unlink_request(request);
+
+    // The callback may start new requests, so it runs once this one is gone
+    switch (request->kind) {
+        case ASYNC_ADDRESS:
+            request->on_done.address((AddressResponse *)result, request->user_data);
+            break;
+        case ASYNC_ADDRESS_LIST:
+            request->on_done.address_list((AddressListResponse *)result, request->user_data);
+            break;
+        case ASYNC_TRANSACTION:
+            request->on_done.transaction((TransactionResponse *)result, request->user_data);
+            break;
+        case ASYNC_TRANSACTION_LIST:
+            request->on_done.transaction_list((TransactionListResponse *)result, request->user_data);
+            break;
+    }
+    free(request);
+}
+
+static void free_partial_list(AsyncRequest *request) {
+    if (request->kind == ASYNC_ADDRESS_LIST) {
+        layer1_free_address_list_response((AddressListResponse *)request->list);
+    } else if (request->kind == ASYNC_TRANSACTION_LIST) {
+        layer1_free_transaction_list_response((TransactionListResponse *)request->list);
+    }
+    request->list = NULL;
+}
+
+static void fail_request(AsyncRequest *request) {
+    free_partial_list(request);
+    complete_request(request, NULL);
+}
+
+// Turn a finished transfer into its response
+static void finish_transfer(AsyncRequest *request, CURLcode res) {
+    CURL *curl = request->handle->curl;
+
+    if (res != CURLE_OK) {
+        fprintf(stderr, "Async request failed: %s\n", curl_easy_strerror(res));
+        fail_request(request);
+        return;
+    }
+
+    if (request->is_post) {
+        MemoryStruct *chunk = &request->handle->response;
+        layer1_record_transfer(request->async->client, curl, "POST", request->url, chunk->size);
+        void *result = request->kind == ASYNC_ADDRESS
+            ? (void *)decode_address_response(chunk->memory, chunk->size)
+            : (void *)decode_transaction_response(chunk->memory, chunk->size);
+        if (result && request->kind == ASYNC_ADDRESS) {
+            layer1_forget_address_list(request->async->client, request->asset_pool_id, request->reference);
+        } else if (result) {
+            layer1_forget_transaction_lists(request->async->client, request->asset_pool_id);
+        }
+        complete_request(request, result);
+        return;
+    }
+
+    layer1_record_transfer(request->async->client, curl, "GET", request->url, request->decoder.bytes_fed);
+    if (!response_decoder_finish(&request->decoder)) {
+        fprintf(stderr, "Invalid response format: expected a page with a content array\n");
+        fail_request(request);
+        return;
+    }
+
+    if (request->kind == ASYNC_ADDRESS_LIST) {
+        AddressListResponse *list = (AddressListResponse *)request->list;
+        list->pageNumber = request->decoder.page_number;
+        list->pageSize = request->decoder.page_size;
+        list->totalElements = request->decoder.total_elements;
+    }
+
+    // Ownership of the list passes to the callback
+    void *result = request->list;
+    request->list = NULL;
+    complete_request(request, result);
+}
+
+static void process_completions(Layer1Async *async) {
+    CURLMsg *message;
+    int remaining;
+    while ((message = curl_multi_info_read(async->multi, &remaining))) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        AsyncRequest *request = NULL;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char **)&request);
+        finish_transfer(request, message->data.result);
+    }
+}
+
+// Signed: attach the signature headers and the body and hand the transfer to curl
+static void start_transfer(AsyncRequest *request) {
+    CURL *curl = request->handle->curl;
+
+    if (request->is_post) {
+        RequestBody *body = request->handle->request_body;
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)body->length);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body->data);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request->headers);
+
+    if (curl_multi_add_handle(request->async->multi, curl) != CURLM_OK) {
+        fail_request(request);
+        return;
+    }
+    request->state = ASYNC_TRANSFER;
+}
+
+// Runs on a signing worker; the loop thread picks the request up from the pipe
+static void on_request_signed(SigningJob *job, void *user_data) {
+    AsyncRequest *request = (AsyncRequest *)user_data;
+    Layer1Async *async = request->async;
+
+    pthread_mutex_lock(&async->ready_lock);
+    request->state = ASYNC_READY;
+    request->ready_next = async->ready;
+    async->ready = request;
+    pthread_mutex_unlock(&async->ready_lock);
+
+    // A full pipe already guarantees a wake-up
+    char wake = 1;
+    ssize_t written = write(async->wake_pipe[1], &wake, 1);
+    (void)written;
+}
+
+static void drain_ready(Layer1Async *async) {
+    char buffer[256];
+    while (read(async->wake_pipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+
+    pthread_mutex_lock(&async->ready_lock);
+    AsyncRequest *ready = async->ready;
+    async->ready = NULL;
+    pthread_mutex_unlock(&async->ready_lock);
+
+    while (ready) {
+        AsyncRequest *request = ready;
+        ready = request->ready_next;
+
+        request->headers = request->job.headers;
+        if (request->job.success) {
+            start_transfer(request);
+        } else {
+            fprintf(stderr, "Failed to sign async request\n");
+            fail_request(request);
+        }
+    }
+}
+
+void layer1_async_socket_action(Layer1Async *async, curl_socket_t fd, int events) {
+    if (!async) {
+        return;
+    }
+
+    if (async->signers && fd == async->wake_pipe[0]) {
+        drain_ready(async);
+        return;
+    }
+
+    int running;
+    curl_multi_socket_action(async->multi, fd, events, &running);
+    process_completions(async);
+}
+
+void layer1_async_timeout(Layer1Async *async) {
+    if (!async) {
+        return;
+    }
+
+    int running;
+    curl_multi_socket_action(async->multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    process_completions(async);
+}
+
+bool layer1_async_assign(Layer1Async *async, curl_socket_t fd, void *socket_data) {
+    return async && curl_multi_assign(async->multi, fd, socket_data) == CURLM_OK;
+}
+
+int layer1_async_in_flight(Layer1Async *async) {
+    return async ? async->in_flight : 0;
+}
+
+void layer1_async_destroy(Layer1Async *async) {
+    if (!async) {
+        return;
+    }
+
+    // Let the workers finish what they hold so every request is back with us
+    signing_pool_destroy(async->signers);
+    async->signers = NULL;
+
+    pthread_mutex_lock(&async->ready_lock);
+    async->ready = NULL;
+    pthread_mutex_unlock(&async->ready_lock);
+
+    while (async->requests) {
+        AsyncRequest *request = async->requests;
+        if (request->state == ASYNC_READY) {
+            request->headers = request->job.headers;
+        }
+        fail_request(request);
+    }
+
+    if (async->wake_pipe[0] >= 0) {
+        async->on_socket(async, async->wake_pipe[0], CURL_POLL_REMOVE, async->user_data, NULL);
+        close(async->wake_pipe[0]);
+        close(async->wake_pipe[1]);
+    }
+
+    curl_multi_cleanup(async->multi);
+    pthread_mutex_destroy(&async->ready_lock);
+    free(async);
+}
+
+// Check out a handle and point its output at the handle's buffer (create
+// requests) or at a streaming decoder (list requests)
+static AsyncRequest *begin_request(Layer1Async *async, AsyncKind kind) {
+    AsyncRequest *request = calloc(1, sizeof(AsyncRequest));
+    if (!request) {
+        return NULL;
+    }
+
+    request->handle = handle_pool_acquire(async->client->handles);
+    if (!request->handle) {
+        free(request);
+        return NULL;
+    }
+
+    request->async = async;
+    request->kind = kind;
+    request->is_post = kind == ASYNC_ADDRESS || kind == ASYNC_TRANSACTION;
+
+    CURL *curl = request->handle->curl;
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)request);
+    layer1_apply_compression(async->client, curl);
+
+    if (request->is_post) {
+        MemoryStruct *chunk = &request->handle->response;
+        chunk->size = 0;
+        chunk->curl = curl;
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)chunk);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, response_decoder_write_callback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&request->decoder);
+    }
+
+    // Track it from here on so destroy can always find it
+    request->next = async->requests;
+    if (async->requests) {
+        async->requests->prev = request;
+    }
+    async->requests = request;
+    async->in_flight++;
+
+    return request;
+}
+
+// Drop a request that never got as far as signing; its callback is not called
+static void abandon_request(AsyncRequest *request) {
+    curl_slist_free_all(request->headers);
+    free(request->content_digest);
+    free(request->asset_pool_id);
+    free(request->reference);
+    free_partial_list(request);
+    if (!request->is_post) {
+        response_decoder_free(&request->decoder);
+    }
+    layer1_release_handle(request->async->client, request->handle);
+    unlink_request(request);
+    free(request);
+}
+
+// Sign on the loop thread, or hand the request to a signing worker
+static bool submit_request(AsyncRequest *request) {
+    Layer1Async *async = request->async;
+    CURL *curl = request->handle->curl;
+    const char *method = request->is_post ? "POST" : "GET";
+
+    curl_easy_setopt(curl, CURLOPT_URL, request->url);
+    request->headers = layer1_add_common_headers(NULL, request->is_post || request->kind == ASYNC_TRANSACTION_LIST);
+
+    if (!async->signers) {
+        bool signed_ok = request->is_post
+            ? layer1_attach_signed_body(async->client->signer, curl, request->url,
+                                        request->handle->request_body, &request->headers)
+            : http_signer_add_headers(async->client->signer, curl, request->url, NULL, method,
+                                      &request->headers);
+        if (!signed_ok) {
+            abandon_request(request);
+            return false;
+        }
+        start_transfer(request);
+        return true;
+    }
+
+    // Only the signature moves to the worker; the body was hashed while it was written
+    if (request->is_post) {
+        request->content_digest = request_body_finish_digest(request->handle->request_body);
+        if (!request->content_digest) {
+            abandon_request(request);
+            return false;
+        }
+    }
+
+    request->state = ASYNC_SIGNING;
+    request->job.url = request->url;
+    request->job.content_digest = request->content_digest;
+    request->job.method = method;
+    request->job.headers = request->headers;
+    request->job.on_signed = on_request_signed;
+    request->job.user_data = request;
+    request->headers = NULL;
+
+    if (!signing_pool_submit(async->signers, &request->job)) {
+        request->headers = request->job.headers;
+        abandon_request(request);
+        return false;
+    }
+    return true;
+}
+
+static bool start_create_address(Layer1Async *async, const char *asset_pool_id, const char *network,
+                                 const char *asset, const char *reference,
+                                 Layer1AddressCallback on_done, void *user_data) {
+    AsyncRequest *request = begin_request(async, ASYNC_ADDRESS);
+    if (!request) {
+        return false;
+    }
+
+    request->on_done.address = on_done;
+    request->user_data = user_data;
+    snprintf(request->url, sizeof(request->url), "%s/digital/v1/addresses", async->client->base_url);
+    request->asset_pool_id = strdup(asset_pool_id);
+    request->reference = strdup(reference);
+
+    if (!request->asset_pool_id || !request->reference ||
+        !encode_address_request(request->handle->request_body, asset_pool_id, network, asset, reference)) {
+        abandon_request(request);
+        return false;
+    }
+    return submit_request(request);
+}
+
+bool layer1_async_create_address(Layer1Async *async, const char *asset_pool_id, const char *network,
+                                 const char *asset, const char *reference,
+                                 Layer1AddressCallback on_done, void *user_data) {
+    if (!async || !asset_pool_id || (!network && !asset) || !reference || !on_done) {
+        return false;
+    }
+    return start_create_address(async, asset_pool_id, network, asset, reference, on_done, user_data);
+}
+
+bool layer1_async_create_address_by_asset(Layer1Async *async, const char *asset_pool_id, const char *asset,
+                                          const char *reference, Layer1AddressCallback on_done, void *user_data) {
+    if (!async || !asset_pool_id || !asset || !reference || !on_done) {
+        return false;
+    }
+    return start_create_address(async, asset_pool_id, NULL, asset, reference, on_done, user_data);
+}
+
+bool layer1_async_list_addresses(Layer1Async *async, const char *asset_pool_id, const char *reference,
+                                 Layer1AddressListCallback on_done, void *user_data) {
+    if (!async || !asset_pool_id || !reference || !on_done) {
+        return false;
+    }
+
+    AsyncRequest *request = begin_request(async, ASYNC_ADDRESS_LIST);
+    if (!request) {
+        return false;
+    }
+
+    request->on_done.address_list = on_done;
+    request->user_data = user_data;
+    layer1_build_addresses_url(request->url, sizeof(request->url), async->client, asset_pool_id, reference);
+
+    request->list = calloc(1, sizeof(AddressListResponse));
+    if (!request->list) {
+        abandon_request(request);
+        return false;
+    }
+    response_decoder_init(&request->decoder, RECORD_ADDRESS, true, collect_address_record, request->list);
+
+    return submit_request(request);
+}
+
+bool layer1_async_create_transaction(Layer1Async *async, const char *asset_pool_id, const char *network,
+                                     const char *asset, const char *to_address, const char *amount,
+                                     const char *reference, Layer1TransactionCallback on_done, void *user_data) {
+    if (!async || !asset_pool_id || !network || !asset || !to_address || !amount || !on_done) {
+        return false;
+    }
+
+    AsyncRequest *request = begin_request(async, ASYNC_TRANSACTION);
+    if (!request) {
+        return false;
+    }
+
+    request->on_done.transaction = on_done;
+    request->user_data = user_data;
+    snprintf(request->url, sizeof(request->url), "%s/digital/v1/transaction-requests", async->client->base_url);
+    request->asset_pool_id = strdup(asset_pool_id);
+
+    if (!request->asset_pool_id ||
+        !encode_transaction_request(request->handle->request_body, asset_pool_id, network, asset,
+                                    to_address, amount, reference)) {
+        abandon_request(request);
+        return false;
+    }
+    return submit_request(request);
+}
+
+bool layer1_async_list_transactions(Layer1Async *async, const char *asset_pool_id, const char *query,
+                                    Layer1TransactionListCallback on_done, void *user_data) {
+    if (!async || !asset_pool_id || !query || !on_done) {
+        return false;
+    }
+
+    AsyncRequest *request = begin_request(async, ASYNC_TRANSACTION_LIST);
+    if (!request) {
+        return false;
+    }
+
+    request->on_done.transaction_list = on_done;
+    request->user_data = user_data;
+    if (!layer1_build_transactions_url(request->url, sizeof(request->url), async->client, asset_pool_id, query)) {
+        abandon_request(request);
+        return false;
+    }
+
+    request->list = calloc(1, sizeof(TransactionListResponse));
+    if (!request->list) {
+        abandon_request(request);
+        return false;
+    }
+    response_decoder_init(&request->decoder, RECORD_TRANSACTION, true, collect_transaction_record, request->list);
+
+    return submit_request(request);
+}
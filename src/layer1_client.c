@@ -1,14 +1,31 @@
 #include "layer1_client.h"
 #include "http_signer.h"
+#include "request_body.h"
+#include "request_encoder.h"
+#include "handle_pool.h"
+#include "client_internal.h"
+#include "single_flight.h"
+#include "response_cache.h"
+#include "string_hash.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include "../lib/cJSON/cJSON.h"
+#include "response_decoder.h"
 
-#define MAX_COMMANDS 10
+// Response buffer sizing: first allocation, largest Content-Length trusted
+// for an up-front reservation, and the default high-water mark
+#define RESPONSE_BUFFER_INITIAL_CAPACITY 4096
+#define RESPONSE_BUFFER_MAX_RESERVE (64 * 1024 * 1024)
+#define RESPONSE_BUFFER_DEFAULT_HIGH_WATER (1024 * 1024)
 
-static Command *commands[MAX_COMMANDS];
-static int command_count = 0;
+// Longest transaction list URL, which bounds how many references one query packs
+#define TRANSACTIONS_URL_SIZE 2048
+
+// Command registry: open addressing on the command name, kept at most half
+// full and doubled as commands are registered
+static Command **command_table = NULL;
+static size_t command_capacity = 0;
+static size_t command_count = 0;
 
 Layer1Client *layer1_client_create(const char *base_url, const char *client_id, const char *private_key_path) {
     Layer1Client *client = (Layer1Client *)malloc(sizeof(Layer1Client));
@@ -21,7 +38,19 @@ Layer1Client *layer1_client_create(const char *base_url, const char *client_id,
     client->base_url = NULL;
     client->client_id = NULL;
     client->private_key = NULL;
-    client->curl = NULL;
+    client->signer = NULL;
+    client->handles = NULL;
+    pthread_mutex_init(&client->stats_lock, NULL);
+    client->response_high_water = RESPONSE_BUFFER_DEFAULT_HIGH_WATER;
+    client->accept_encoding = NULL;
+    client->last_transfer = (Layer1TransferStats){0};
+    client->transfer_observer = NULL;
+    client->transfer_observer_data = NULL;
+    client->list_flights = NULL;
+    client->list_cache = NULL;
+    client->settled_ttl_ms = 0;
+    client->pending_ttl_ms = 0;
+    atomic_init(&client->cache_generation, 0);
 
     // Copy base URL
     if (base_url) {
@@ -53,9 +82,16 @@ Layer1Client *layer1_client_create(const char *base_url, const char *client_id,
         }
     }
 
-    // Initialize curl
-    client->curl = curl_easy_init();
-    if (!client->curl) {
+    // Parse the key once; the signer is only read from then on
+    client->signer = http_signer_create(client->private_key, client->client_id);
+    if (!client->signer) {
+        layer1_client_destroy(client);
+        return NULL;
+    }
+
+    // CURL handles and request buffers, handed out one per in-flight request
+    client->handles = handle_pool_create();
+    if (!client->handles) {
         fprintf(stderr, "Failed to initialize curl\n");
         layer1_client_destroy(client);
         return NULL;
@@ -73,28 +109,65 @@ void layer1_client_destroy(Layer1Client *client) {
     free(client->client_id);
     free(client->private_key);
     
-    if (client->curl) {
-        curl_easy_cleanup(client->curl);
-    }
+    handle_pool_destroy(client->handles);
+    http_signer_destroy(client->signer);
+    free(client->accept_encoding);
+    single_flight_destroy(client->list_flights);
+    response_cache_destroy(client->list_cache);
+    pthread_mutex_destroy(&client->stats_lock);
     
     free(client);
 }
 
+static Command **find_command_slot(Command **table, size_t capacity, const char *name) {
+    size_t mask = capacity - 1;
+    size_t slot = (size_t)string_hash(name) & mask;
+    while (table[slot] && strcmp(table[slot]->name, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return &table[slot];
+}
+
+static bool grow_command_table(void) {
+    size_t capacity = command_capacity ? command_capacity * 2 : 16;
+    Command **table = calloc(capacity, sizeof(Command *));
+    if (!table) {
+        return false;
+    }
+
+    for (size_t i = 0; i < command_capacity; i++) {
+        if (command_table[i]) {
+            *find_command_slot(table, capacity, command_table[i]->name) = command_table[i];
+        }
+    }
+
+    free(command_table);
+    command_table = table;
+    command_capacity = capacity;
+    return true;
+}
+
 void register_command(Command *command) {
-    if (command_count < MAX_COMMANDS) {
-        commands[command_count++] = command;
-    } else {
-        fprintf(stderr, "Maximum number of commands reached\n");
+    if ((command_count + 1) * 2 > command_capacity && !grow_command_table()) {
+        fprintf(stderr, "Failed to allocate memory for command %s\n", command->name);
+        return;
+    }
+
+    Command **slot = find_command_slot(command_table, command_capacity, command->name);
+    if (*slot) {
+        fprintf(stderr, "Command %s is already registered\n", command->name);
+        return;
     }
+
+    *slot = command;
+    command_count++;
 }
 
 Command *get_command(const char *name) {
-    for (int i = 0; i < command_count; i++) {
-        if (strcmp(commands[i]->name, name) == 0) {
-            return commands[i];
-        }
+    if (!name || command_count == 0) {
+        return NULL;
     }
-    return NULL;
+    return *find_command_slot(command_table, command_capacity, name);
 }
 
 char *read_file_to_string(const char *filename) {
@@ -132,17 +205,49 @@ char *read_file_to_string(const char *filename) {
     return buffer;
 }
 
+// Make room for needed bytes plus the terminating NUL. Growth doubles the
+// capacity unless the exact size is already known.
+static bool reserve_response_buffer(MemoryStruct *mem, size_t needed, bool exact) {
+    if (needed < mem->capacity) {
+        return true;
+    }
+
+    size_t capacity = needed + 1;
+    if (!exact) {
+        capacity = mem->capacity ? mem->capacity : RESPONSE_BUFFER_INITIAL_CAPACITY;
+        while (capacity <= needed) {
+            capacity *= 2;
+        }
+    }
+
+    char *ptr = realloc(mem->memory, capacity);
+    if (!ptr) {
+        return false;
+    }
+
+    mem->memory = ptr;
+    mem->capacity = capacity;
+    return true;
+}
+
 size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
     size_t realsize = size * nmemb;
     MemoryStruct *mem = (MemoryStruct *)userp;
 
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
+    // Reserve the whole body up front when the server announced its length
+    if (mem->size == 0 && mem->curl) {
+        curl_off_t content_length = -1;
+        if (curl_easy_getinfo(mem->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length) == CURLE_OK &&
+            content_length > 0 && content_length <= RESPONSE_BUFFER_MAX_RESERVE) {
+            reserve_response_buffer(mem, (size_t)content_length, true);
+        }
+    }
+
+    if (!reserve_response_buffer(mem, mem->size + realsize, false)) {
         fprintf(stderr, "Failed to allocate memory in write_callback\n");
         return 0;
     }
 
-    mem->memory = ptr;
     memcpy(&(mem->memory[mem->size]), contents, realsize);
     mem->size += realsize;
     mem->memory[mem->size] = 0;
@@ -150,189 +255,191 @@ size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
     return realsize;
 }
 
-static struct curl_slist *add_common_headers(struct curl_slist *headers, bool include_content_type) {
-    if (include_content_type) {
-        headers = curl_slist_append(headers, "Content-Type: application/json");
+void layer1_client_set_response_high_water(Layer1Client *client, size_t bytes) {
+    if (client) {
+        client->response_high_water = bytes;
     }
-    headers = curl_slist_append(headers, "Accept: application/json");
-    return headers;
 }
 
-static AddressResponse *parse_address_response(const char *json_str) {
-    if (!json_str) {
-        return NULL;
-    }
-
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
-        return NULL;
+bool layer1_client_set_compression(Layer1Client *client, const char *encodings) {
+    if (!client) {
+        return false;
     }
 
-    AddressResponse *response = calloc(1, sizeof(AddressResponse));
-    if (!response) {
-        cJSON_Delete(root);
-        return NULL;
+    char *copy = NULL;
+    if (encodings) {
+        copy = strdup(encodings);
+        if (!copy) {
+            return false;
+        }
     }
 
-    // Extract fields from JSON
-    cJSON *address = cJSON_GetObjectItem(root, "address");
-    cJSON *network = cJSON_GetObjectItem(root, "network");
-    cJSON *asset = cJSON_GetObjectItem(root, "asset");
-    cJSON *reference = cJSON_GetObjectItem(root, "reference");
-    cJSON *assetPoolId = cJSON_GetObjectItem(root, "assetPoolId");
-    cJSON *id = cJSON_GetObjectItem(root, "id");
-    cJSON *status = cJSON_GetObjectItem(root, "status");
-    cJSON *createdAt = cJSON_GetObjectItem(root, "createdAt");
-
-    // Copy values if they exist
-    if (cJSON_IsString(address)) response->address = strdup(address->valuestring);
-    if (cJSON_IsString(network)) response->network = strdup(network->valuestring);
-    if (cJSON_IsString(asset)) response->asset = strdup(asset->valuestring);
-    if (cJSON_IsString(reference)) response->reference = strdup(reference->valuestring);
-    if (cJSON_IsString(assetPoolId)) response->assetPoolId = strdup(assetPoolId->valuestring);
-    if (cJSON_IsString(id)) response->id = strdup(id->valuestring);
-    if (cJSON_IsString(status)) response->status = strdup(status->valuestring);
-    if (cJSON_IsString(createdAt)) response->createdAt = strdup(createdAt->valuestring);
-
-    cJSON_Delete(root);
-    return response;
+    free(client->accept_encoding);
+    client->accept_encoding = copy;
+    return true;
 }
 
-static AddressListResponse *parse_address_list_response(const char *json_str) {
-    if (!json_str) {
-        return NULL;
+Layer1TransferStats layer1_client_last_transfer(Layer1Client *client) {
+    Layer1TransferStats stats = {0};
+    if (client) {
+        pthread_mutex_lock(&client->stats_lock);
+        stats = client->last_transfer;
+        pthread_mutex_unlock(&client->stats_lock);
     }
+    return stats;
+}
 
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
-        return NULL;
+void layer1_client_set_transfer_observer(Layer1Client *client, TransferObserver observer, void *user_data) {
+    if (client) {
+        client->transfer_observer = observer;
+        client->transfer_observer_data = user_data;
     }
+}
 
-    AddressListResponse *response = calloc(1, sizeof(AddressListResponse));
-    if (!response) {
-        cJSON_Delete(root);
-        return NULL;
+bool layer1_client_set_coalescing(Layer1Client *client, bool enabled) {
+    if (!client) {
+        return false;
     }
 
-    // Extract pagination info
-    cJSON *pageNumber = cJSON_GetObjectItem(root, "pageNumber");
-    cJSON *pageSize = cJSON_GetObjectItem(root, "pageSize");
-    cJSON *totalElements = cJSON_GetObjectItem(root, "totalElements");
-    cJSON *content = cJSON_GetObjectItem(root, "content");
+    if (enabled && !client->list_flights) {
+        client->list_flights = single_flight_create();
+        return client->list_flights != NULL;
+    }
+    if (!enabled) {
+        single_flight_destroy(client->list_flights);
+        client->list_flights = NULL;
+    }
+    return true;
+}
 
-    if (cJSON_IsNumber(pageNumber)) response->pageNumber = pageNumber->valueint;
-    if (cJSON_IsNumber(pageSize)) response->pageSize = pageSize->valueint;
-    if (cJSON_IsNumber(totalElements)) response->totalElements = totalElements->valueint;
+uint64_t layer1_client_coalesced_requests(Layer1Client *client) {
+    return client && client->list_flights ? single_flight_joined(client->list_flights) : 0;
+}
 
-    if (content && cJSON_IsArray(content)) {
-        int contentSize = cJSON_GetArraySize(content);
-        response->content = calloc(contentSize, sizeof(AddressResponse*));
-        if (!response->content) {
-            cJSON_Delete(root);
-            free(response);
-            return NULL;
-        }
+bool layer1_client_set_cache(Layer1Client *client, size_t max_entries,
+                             unsigned int settled_ttl_ms, unsigned int pending_ttl_ms) {
+    if (!client) {
+        return false;
+    }
 
-        for (int i = 0; i < contentSize; i++) {
-            cJSON *item = cJSON_GetArrayItem(content, i);
-            char *item_str = cJSON_Print(item);
-            if (item_str) {
-                response->content[response->contentCount] = parse_address_response(item_str);
-                if (response->content[response->contentCount]) {
-                    response->contentCount++;
-                }
-                free(item_str);
-            }
+    ResponseCache *cache = NULL;
+    if (max_entries > 0) {
+        cache = response_cache_create(max_entries);
+        if (!cache) {
+            return false;
         }
     }
 
-    cJSON_Delete(root);
-    return response;
+    response_cache_destroy(client->list_cache);
+    client->list_cache = cache;
+    client->settled_ttl_ms = settled_ttl_ms;
+    client->pending_ttl_ms = pending_ttl_ms;
+    return true;
 }
 
-void layer1_free_address_response(AddressResponse *response) {
-    if (!response) {
-        return;
-    }
+Layer1CacheStats layer1_client_cache_stats(Layer1Client *client) {
+    Layer1CacheStats stats = {0};
+    if (client && client->list_cache) {
+        ResponseCacheStats cache_stats;
+        response_cache_get_stats(client->list_cache, &cache_stats);
+        stats.hits = cache_stats.hits;
+        stats.misses = cache_stats.misses;
+        stats.evictions = cache_stats.evictions;
+        stats.expirations = cache_stats.expirations;
+        stats.entries = cache_stats.entries;
+    }
+    return stats;
+}
 
-    free(response->address);
-    free(response->network);
-    free(response->asset);
-    free(response->reference);
-    free(response->assetPoolId);
-    free(response->id);
-    free(response->status);
-    free(response->createdAt);
-    free(response);
+// Offer compressed responses; curl inflates them before the write callback
+// sees the bytes, so decoding overlaps with decompression
+void layer1_apply_compression(Layer1Client *client, CURL *curl) {
+    if (client->accept_encoding) {
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, client->accept_encoding);
+    }
 }
 
-void layer1_free_address_list_response(AddressListResponse *response) {
-    if (!response) {
-        return;
+void layer1_record_transfer(Layer1Client *client, CURL *curl, const char *method, const char *url,
+                            size_t decoded_bytes) {
+    Layer1TransferStats stats = { 0, (curl_off_t)decoded_bytes };
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &stats.wire_bytes);
+
+    pthread_mutex_lock(&client->stats_lock);
+    client->last_transfer = stats;
+    pthread_mutex_unlock(&client->stats_lock);
+
+    if (client->transfer_observer) {
+        client->transfer_observer(method, url, &stats, client->transfer_observer_data);
     }
+}
 
-    if (response->content) {
-        for (int i = 0; i < response->contentCount; i++) {
-            layer1_free_address_response(response->content[i]);
-        }
-        free(response->content);
+// Hand a handle back to the pool, first giving back a response buffer that
+// an unusually large response grew past the high-water mark
+void layer1_release_handle(Layer1Client *client, PooledHandle *handle) {
+    MemoryStruct *mem = &handle->response;
+    mem->size = 0;
+
+    if (mem->capacity > client->response_high_water) {
+        free(mem->memory);
+        mem->memory = NULL;
+        mem->capacity = 0;
     }
 
-    free(response);
+    handle_pool_release(client->handles, handle);
 }
 
-AddressListResponse *layer1_list_addresses(
-    Layer1Client *client,
-    const char *asset_pool_id,
-    const char *reference
-) {
-    if (!client || !asset_pool_id || !reference) {
-        return NULL;
+struct curl_slist *layer1_add_common_headers(struct curl_slist *headers, bool include_content_type) {
+    if (include_content_type) {
+        headers = curl_slist_append(headers, "Content-Type: application/json");
     }
+    headers = curl_slist_append(headers, "Accept: application/json");
+    return headers;
+}
 
-    // Prepare URL with query parameters
-    char url[2048];
-    snprintf(url, sizeof(url), "%s/digital/v1/addresses?assetPoolId=%s&q=reference:%s",
-             client->base_url, asset_pool_id, reference);
+// Sign a request carrying a JSON body and hand the body to curl as-is
+bool layer1_attach_signed_body(HttpSigner *signer, CURL *curl, const char *url,
+                               RequestBody *body, struct curl_slist **headers) {
+    char *content_digest = request_body_finish_digest(body);
+    if (!content_digest) {
+        return false;
+    }
 
-    // Create HTTP signer
-    HttpSigner *signer = http_signer_create(client->private_key, client->client_id);
-    if (!signer) {
-        return NULL;
+    bool signed_ok = http_signer_add_headers_for_digest(signer, NULL, url, content_digest, "POST", headers);
+    free(content_digest);
+    if (!signed_ok) {
+        return false;
     }
 
-    // Set up CURL
-    CURL *curl = client->curl;
-    curl_easy_reset(curl);
-    
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)body->length);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body->data);
+    return true;
+}
+
+// Perform a signed POST of the handle's request body, leaving the response
+// in the handle's buffer until release_handle
+static bool perform_signed_post(Layer1Client *client, PooledHandle *handle, const char *url) {
+    CURL *curl = handle->curl;
+
     // Set URL and method
     curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-    
-    // Set up response buffer
-    MemoryStruct chunk = {
-        .memory = malloc(1),
-        .size = 0
-    };
-    
-    if (!chunk.memory) {
-        http_signer_destroy(signer);
-        return NULL;
-    }
-    
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+
+    // Collect the response in the handle's reusable buffer
+    MemoryStruct *chunk = &handle->response;
+    chunk->size = 0;
+    chunk->curl = curl;
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)chunk);
+    layer1_apply_compression(client, curl);
+
     // Set headers
     struct curl_slist *headers = NULL;
-    headers = add_common_headers(headers, false);
+    headers = layer1_add_common_headers(headers, true);
 
-    // Add signature headers
-    if (!http_signer_add_headers(signer, curl, url, NULL, "GET", &headers)) {
-        http_signer_destroy(signer);
-        free(chunk.memory);
+    // Add signature headers and attach the body
+    if (!layer1_attach_signed_body(client->signer, curl, url, handle->request_body, &headers)) {
         curl_slist_free_all(headers);
-        return NULL;
+        return false;
     }
 
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
@@ -342,91 +449,92 @@ AddressListResponse *layer1_list_addresses(
 
     // Clean up
     curl_slist_free_all(headers);
-    http_signer_destroy(signer);
 
     if (res != CURLE_OK) {
-        free(chunk.memory);
-        return NULL;
+        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
+        return false;
     }
 
-    // Parse response
-    AddressListResponse *response = parse_address_list_response(chunk.memory);
-    free(chunk.memory);
+    layer1_record_transfer(client, curl, "POST", url, chunk->size);
+    return true;
+}
 
-    return response;
+void layer1_free_address_fields(AddressResponse *address) {
+    if (!address) {
+        return;
+    }
+
+    free(address->address);
+    free(address->network);
+    free(address->asset);
+    free(address->reference);
+    free(address->assetPoolId);
+    free(address->id);
+    free(address->status);
+    free(address->createdAt);
 }
 
-AddressResponse *layer1_create_address(
-    Layer1Client *client,
-    const char *asset_pool_id,
-    const char *network,
-    const char *asset,
-    const char *reference
-) {
-    if (!client || !asset_pool_id || (!network && !asset) || !reference) {
-        return NULL;
+void layer1_free_address_response(AddressResponse *response) {
+    if (!response) {
+        return;
     }
 
-    // Create JSON payload
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "assetPoolId", asset_pool_id);
-    cJSON_AddStringToObject(root, "network", network);
-    cJSON_AddStringToObject(root, "asset", asset);
-    cJSON_AddStringToObject(root, "reference", reference);
-    
-    char *payload = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+    layer1_free_address_fields(response);
+    free(response);
+}
 
-    if (!payload) {
-        return NULL;
+void layer1_free_address_list_response(AddressListResponse *response) {
+    if (!response) {
+        return;
     }
 
-    // Create HTTP signer
-    HttpSigner *signer = http_signer_create(client->private_key, client->client_id);
-    if (!signer) {
-        free(payload);
-        return NULL;
+    // A coalesced response is freed by its last holder
+    if (atomic_fetch_sub(&response->shared_refs, 1) > 0) {
+        return;
     }
 
-    // Prepare URL
-    char url[1024];
-    snprintf(url, sizeof(url), "%s/digital/v1/addresses", client->base_url);
+    if (response->content) {
+        for (int i = 0; i < response->contentCount; i++) {
+            layer1_free_address_response(response->content[i]);
+        }
+        free(response->content);
+    }
+
+    free(response);
+}
+
+// Perform a signed GET, handing the body to write_function as curl delivers it.
+// body_bytes is read after the transfer for the transfer stats.
+static bool perform_signed_get(Layer1Client *client, const char *url, bool include_content_type,
+                               size_t (*write_function)(void *, size_t, size_t, void *), void *write_data,
+                               long receive_buffer_size, const size_t *body_bytes) {
+    // Check out a CURL handle for this request
+    PooledHandle *handle = handle_pool_acquire(client->handles);
+    if (!handle) {
+        return false;
+    }
+    CURL *curl = handle->curl;
 
-    // Set up CURL
-    CURL *curl = client->curl;
-    curl_easy_reset(curl);
-    
     // Set URL and method
     curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload);
-    
-    // Set up response buffer
-    MemoryStruct chunk = {
-        .memory = malloc(1),
-        .size = 0
-    };
-    
-    if (!chunk.memory) {
-        http_signer_destroy(signer);
-        free(payload);
-        return NULL;
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_function);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, write_data);
+    if (receive_buffer_size > 0) {
+        curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, receive_buffer_size);
     }
-    
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    
+    layer1_apply_compression(client, curl);
+
     // Set headers
     struct curl_slist *headers = NULL;
-    headers = add_common_headers(headers, true);
+    headers = layer1_add_common_headers(headers, include_content_type);
 
     // Add signature headers
-    if (!http_signer_add_headers(signer, curl, url, payload, "POST", &headers)) {
-        http_signer_destroy(signer);
-        free(payload);
-        free(chunk.memory);
+    if (!http_signer_add_headers(client->signer, curl, url, NULL, "GET", &headers)) {
         curl_slist_free_all(headers);
-        return NULL;
+        layer1_release_handle(client, handle);
+        return false;
     }
 
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
@@ -436,243 +544,412 @@ AddressResponse *layer1_create_address(
 
     // Clean up
     curl_slist_free_all(headers);
-    http_signer_destroy(signer);
-    free(payload);
 
-    if (res != CURLE_OK) {
-        free(chunk.memory);
-        return NULL;
+    if (res == CURLE_OK) {
+        layer1_record_transfer(client, curl, "GET", url, *body_bytes);
     }
+    layer1_release_handle(client, handle);
 
-    // Parse response
-    AddressResponse *response = parse_address_response(chunk.memory);
-    free(chunk.memory);
+    if (res != CURLE_OK) {
+        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
+        return false;
+    }
 
-    return response;
+    return true;
 }
 
-AddressResponse *layer1_create_address_by_asset(
-    Layer1Client *client,
-    const char *asset_pool_id,
-    const char *asset,
-    const char *reference
-) {
-    if (!client || !asset_pool_id || !asset || !reference) {
-        return NULL;
+// Perform a signed GET and feed the body to the decoder as curl delivers it
+static bool perform_decoded_get(Layer1Client *client, const char *url, bool include_content_type,
+                                ResponseDecoder *decoder) {
+    if (!perform_signed_get(client, url, include_content_type, response_decoder_write_callback,
+                            decoder, 0, &decoder->bytes_fed)) {
+        return false;
     }
 
-    // Create JSON payload
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "assetPoolId", asset_pool_id);
-    cJSON_AddStringToObject(root, "asset", asset);
-    cJSON_AddStringToObject(root, "reference", reference);
-    
-    char *payload = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
-
-    if (!payload) {
-        return NULL;
+    if (!response_decoder_finish(decoder)) {
+        fprintf(stderr, "Invalid response format: expected a page with a content array\n");
+        return false;
     }
 
-    // Create HTTP signer
-    HttpSigner *signer = http_signer_create(client->private_key, client->client_id);
-    if (!signer) {
-        free(payload);
-        return NULL;
-    }
+    return true;
+}
 
-    // Prepare URL
-    char url[1024];
-    snprintf(url, sizeof(url), "%s/digital/v1/addresses", client->base_url);
+// Raw bodies are passed on in chunks of up to this size, one handler call each
+#define RAW_RECEIVE_BUFFER_SIZE (512L * 1024)
 
-    // Set up CURL
-    CURL *curl = client->curl;
-    curl_easy_reset(curl);
-    
-    // Set URL and method
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload);
-    
-    // Set up response buffer
-    MemoryStruct chunk = {
-        .memory = malloc(1),
-        .size = 0
-    };
-    
-    if (!chunk.memory) {
-        http_signer_destroy(signer);
-        free(payload);
-        return NULL;
-    }
-    
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    
-    // Set headers
-    struct curl_slist *headers = NULL;
-    headers = add_common_headers(headers, true);
+typedef struct {
+    BodyHandler handler;
+    void *user_data;
+    size_t bytes;
+} RawStream;
 
-    // Add signature headers
-    if (!http_signer_add_headers(signer, curl, url, payload, "POST", &headers)) {
-        http_signer_destroy(signer);
-        free(payload);
-        free(chunk.memory);
-        curl_slist_free_all(headers);
-        return NULL;
+static size_t raw_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    RawStream *stream = (RawStream *)userp;
+    size_t length = size * nmemb;
+
+    // Anything short of length makes curl abort the transfer
+    if (!stream->handler((const char *)contents, length, stream->user_data)) {
+        return 0;
     }
+    stream->bytes += length;
+    return length;
+}
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+static bool perform_raw_get(Layer1Client *client, const char *url, bool include_content_type,
+                            BodyHandler handler, void *user_data) {
+    RawStream stream = { handler, user_data, 0 };
+    return perform_signed_get(client, url, include_content_type, raw_write_callback, &stream,
+                              RAW_RECEIVE_BUFFER_SIZE, &stream.bytes);
+}
 
-    // Perform request
-    CURLcode res = curl_easy_perform(curl);
+typedef struct {
+    AddressHandler handler;
+    void *user_data;
+} AddressStream;
 
-    // Clean up
-    curl_slist_free_all(headers);
-    http_signer_destroy(signer);
-    free(payload);
+static bool forward_address(void *record, void *user_data) {
+    AddressStream *stream = (AddressStream *)user_data;
 
-    if (res != CURLE_OK) {
-        free(chunk.memory);
-        return NULL;
+    AddressResponse *address = malloc(sizeof(AddressResponse));
+    if (!address) {
+        layer1_free_address_response((AddressResponse *)record);
+        return false;
     }
+    memcpy(address, record, sizeof(AddressResponse));
+    return stream->handler(address, stream->user_data);
+}
 
-    // Parse response
-    AddressResponse *response = parse_address_response(chunk.memory);
-    free(chunk.memory);
+typedef struct {
+    TransactionHandler handler;
+    void *user_data;
+} TransactionStream;
 
-    return response;
+static bool forward_transaction(void *record, void *user_data) {
+    TransactionStream *stream = (TransactionStream *)user_data;
+    return stream->handler((Transaction *)record, stream->user_data);
 }
 
-TransactionResponse *layer1_create_transaction(
+void layer1_build_addresses_url(char *url, size_t url_size, Layer1Client *client,
+                                const char *asset_pool_id, const char *reference) {
+    snprintf(url, url_size, "%s/digital/v1/addresses?assetPoolId=%s&q=reference:%s",
+             client->base_url, asset_pool_id, reference);
+}
+
+bool layer1_build_transactions_url(char *url, size_t url_size, Layer1Client *client,
+                                   const char *asset_pool_id, const char *query) {
+    int length = snprintf(url, url_size, "%s/digital/v1/transactions?assetPoolId=%s&q=%s",
+                          client->base_url, asset_pool_id, query);
+    if (length < 0 || (size_t)length >= url_size) {
+        fprintf(stderr, "Transactions URL is too long\n");
+        return false;
+    }
+    return true;
+}
+
+bool layer1_stream_addresses(
     Layer1Client *client,
     const char *asset_pool_id,
-    const char *network,
-    const char *asset,
-    const char *to_address,
-    const char *amount,
-    const char *reference
+    const char *reference,
+    AddressHandler handler,
+    void *user_data
 ) {
-    if (!client || !client->curl || !asset_pool_id || !network || !asset || !to_address || !amount) {
-        return NULL;
+    return layer1_stream_addresses_fields(client, asset_pool_id, reference, ADDRESS_FIELDS_ALL, handler, user_data);
+}
+
+bool layer1_stream_addresses_fields(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *reference,
+    unsigned int fields,
+    AddressHandler handler,
+    void *user_data
+) {
+    if (!client || !asset_pool_id || !reference || !handler) {
+        return false;
     }
 
-    // Build the URL
-    char url[1024];
-    snprintf(url, sizeof(url), "%s/digital/v1/transaction-requests", client->base_url);
+    char url[2048];
+    layer1_build_addresses_url(url, sizeof(url), client, asset_pool_id, reference);
 
-    // Create the JSON request body
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "assetPoolId", asset_pool_id);
-    cJSON_AddStringToObject(json, "network", network);
-    cJSON_AddStringToObject(json, "asset", asset);
-    
-    // Create destinations array with a single destination
-    cJSON *destinations = cJSON_CreateArray();
-    cJSON *destination = cJSON_CreateObject();
-    cJSON_AddStringToObject(destination, "address", to_address);
-    cJSON_AddStringToObject(destination, "amount", amount);
-    cJSON_AddItemToArray(destinations, destination);
-    cJSON_AddItemToObject(json, "destinations", destinations);
-    
-    if (reference) {
-        cJSON_AddStringToObject(json, "reference", reference);
+    AddressStream stream = { handler, user_data };
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_ADDRESS, true, forward_address, &stream);
+    response_decoder_select_fields(&decoder, fields);
+    bool ok = perform_decoded_get(client, url, false, &decoder);
+    response_decoder_free(&decoder);
+
+    return ok;
+}
+
+bool layer1_stream_addresses_raw(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *reference,
+    BodyHandler handler,
+    void *user_data
+) {
+    if (!client || !asset_pool_id || !reference || !handler) {
+        return false;
+    }
+
+    char url[2048];
+    layer1_build_addresses_url(url, sizeof(url), client, asset_pool_id, reference);
+    return perform_raw_get(client, url, false, handler, user_data);
+}
+
+static void share_address_list(void *result, int extra_holders) {
+    atomic_fetch_add(&((AddressListResponse *)result)->shared_refs, extra_holders);
+}
+
+static void retain_address_list(void *value) {
+    share_address_list(value, 1);
+}
+
+static void release_address_list(void *value) {
+    layer1_free_address_list_response((AddressListResponse *)value);
+}
+
+// A list request as handed to the fetch functions below. The key it is shared
+// and cached under is the URL, plus the field mask when that is not complete.
+typedef struct {
+    Layer1Client *client;
+    const char *url;
+    unsigned int fields;
+    uint_fast64_t generation;   // cache_generation before the request went out
+} ListFetch;
+
+// Cache a fetched list, taking over the reference the caller added for the
+// cache, unless a create since the request went out may have made it stale.
+// A create bumps the generation before it flushes the cache, so checking
+// again after the put catches one that slipped in between.
+static void cache_fetched_list(const ListFetch *fetch, const char *key, void *value, unsigned int ttl_ms,
+                               CacheRelease release) {
+    Layer1Client *client = fetch->client;
+    if (atomic_load(&client->cache_generation) != fetch->generation) {
+        release(value);
+        return;
     }
+    response_cache_put(client->list_cache, key, value, ttl_ms, release);
+    if (atomic_load(&client->cache_generation) != fetch->generation) {
+        response_cache_remove(client->list_cache, key);
+    }
+}
+
+static const char *list_key(char *key, size_t key_size, const char *url, unsigned int fields, unsigned int all) {
+    if (fields == all) {
+        return url;
+    }
+    snprintf(key, key_size, "%s#fields=%x", url, fields);
+    return key;
+}
 
-    char *request_body = cJSON_PrintUnformatted(json);
-    cJSON_Delete(json);
+static void *fetch_address_list(void *context, const char *key) {
+    ListFetch *fetch = (ListFetch *)context;
+    Layer1Client *client = fetch->client;
 
-    if (!request_body) {
+    AddressListResponse *response = calloc(1, sizeof(AddressListResponse));
+    if (!response) {
         return NULL;
     }
 
-    // Create HTTP signer
-    HttpSigner *signer = http_signer_create(client->private_key, client->client_id);
-    if (!signer) {
-        free(request_body);
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_ADDRESS, true, collect_address_record, response);
+    response_decoder_select_fields(&decoder, fetch->fields);
+    bool ok = perform_decoded_get(client, fetch->url, false, &decoder);
+    response->pageNumber = decoder.page_number;
+    response->pageSize = decoder.page_size;
+    response->totalElements = decoder.total_elements;
+    response_decoder_free(&decoder);
+
+    if (!ok) {
+        layer1_free_address_list_response(response);
         return NULL;
     }
 
-    // Set up headers
-    struct curl_slist *headers = NULL;
-    headers = add_common_headers(headers, true);
+    // Addresses never change once created, but an empty list may fill up.
+    // Creating an address only invalidates the complete list, so partial
+    // lists are not cached.
+    if (client->list_cache && fetch->fields == ADDRESS_FIELDS_ALL) {
+        atomic_fetch_add(&response->shared_refs, 1);
+        cache_fetched_list(fetch, key, response,
+                           response->contentCount > 0 ? client->settled_ttl_ms : client->pending_ttl_ms,
+                           release_address_list);
+    }
 
-    // Add signature headers
-    if (!http_signer_add_headers(signer, client->curl, url, request_body, "POST", &headers)) {
-        http_signer_destroy(signer);
-        free(request_body);
-        curl_slist_free_all(headers);
+    return response;
+}
+
+AddressListResponse *layer1_list_addresses(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *reference
+) {
+    return layer1_list_addresses_fields(client, asset_pool_id, reference, ADDRESS_FIELDS_ALL);
+}
+
+AddressListResponse *layer1_list_addresses_fields(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *reference,
+    unsigned int fields
+) {
+    if (!client || !asset_pool_id || !reference) {
         return NULL;
     }
 
-    // Set up the request
-    curl_easy_setopt(client->curl, CURLOPT_URL, url);
-    curl_easy_setopt(client->curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(client->curl, CURLOPT_POSTFIELDS, request_body);
-    curl_easy_setopt(client->curl, CURLOPT_WRITEFUNCTION, write_callback);
+    // Prepare URL with query parameters
+    char url[2048];
+    layer1_build_addresses_url(url, sizeof(url), client, asset_pool_id, reference);
 
-    // Prepare response buffer
-    MemoryStruct chunk = {0};
-    chunk.memory = malloc(1);
-    chunk.size = 0;
+    char key_buffer[2048 + 16];
+    const char *key = list_key(key_buffer, sizeof(key_buffer), url, fields, ADDRESS_FIELDS_ALL);
+    ListFetch fetch = { client, url, fields, atomic_load(&client->cache_generation) };
 
-    if (!chunk.memory) {
-        http_signer_destroy(signer);
-        free(request_body);
-        curl_slist_free_all(headers);
+    if (client->list_cache && fields == ADDRESS_FIELDS_ALL) {
+        AddressListResponse *cached = response_cache_get(client->list_cache, key, retain_address_list);
+        if (cached) {
+            return cached;
+        }
+    }
+
+    // Identical calls already in flight are joined rather than repeated
+    if (client->list_flights) {
+        return single_flight_run(client->list_flights, key, fetch_address_list, share_address_list, &fetch);
+    }
+    return fetch_address_list(&fetch, key);
+}
+
+// A newly created address makes the cached list for its reference stale
+void layer1_forget_address_list(Layer1Client *client, const char *asset_pool_id, const char *reference) {
+    atomic_fetch_add(&client->cache_generation, 1);
+    if (client->list_cache) {
+        char url[2048];
+        layer1_build_addresses_url(url, sizeof(url), client, asset_pool_id, reference);
+        response_cache_remove(client->list_cache, url);
+    }
+}
+
+// A new transaction can belong in any query on its pool, so every cached
+// transaction list and table of the pool goes
+void layer1_forget_transaction_lists(Layer1Client *client, const char *asset_pool_id) {
+    atomic_fetch_add(&client->cache_generation, 1);
+    if (client->list_cache) {
+        char prefix[2048];
+        snprintf(prefix, sizeof(prefix), "%s/digital/v1/transactions?assetPoolId=%s&",
+                 client->base_url, asset_pool_id);
+        response_cache_remove_prefix(client->list_cache, prefix);
+    }
+}
+
+AddressResponse *layer1_create_address(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *network,
+    const char *asset,
+    const char *reference
+) {
+    if (!client || !asset_pool_id || (!network && !asset) || !reference) {
         return NULL;
     }
 
-    curl_easy_setopt(client->curl, CURLOPT_WRITEDATA, (void *)&chunk);
+    // Prepare URL
+    char url[1024];
+    snprintf(url, sizeof(url), "%s/digital/v1/addresses", client->base_url);
 
-    // Perform the request
-    CURLcode res = curl_easy_perform(client->curl);
+    // Check out a CURL handle and its buffers for this request
+    PooledHandle *handle = handle_pool_acquire(client->handles);
+    if (!handle) {
+        return NULL;
+    }
 
-    // Clean up request resources
-    curl_slist_free_all(headers);
-    http_signer_destroy(signer);
-    free(request_body);
+    // Write the JSON payload into the handle's reusable body buffer, then send it
+    AddressResponse *response = NULL;
+    if (encode_address_request(handle->request_body, asset_pool_id, network, asset, reference) &&
+        perform_signed_post(client, handle, url)) {
+        // Parse response
+        response = decode_address_response(handle->response.memory, handle->response.size);
+    }
+    layer1_release_handle(client, handle);
 
-    if (res != CURLE_OK) {
-        free(chunk.memory);
+    if (response) {
+        layer1_forget_address_list(client, asset_pool_id, reference);
+    }
+
+    return response;
+}
+
+AddressResponse *layer1_create_address_by_asset(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *asset,
+    const char *reference
+) {
+    if (!client || !asset_pool_id || !asset || !reference) {
         return NULL;
     }
-    
-    // Parse the response
-    cJSON *response_json = cJSON_Parse(chunk.memory);
-    free(chunk.memory);
 
-    if (!response_json) {
+    // Prepare URL
+    char url[1024];
+    snprintf(url, sizeof(url), "%s/digital/v1/addresses", client->base_url);
+
+    // Check out a CURL handle and its buffers for this request
+    PooledHandle *handle = handle_pool_acquire(client->handles);
+    if (!handle) {
         return NULL;
     }
 
-    // Create the response structure
-    TransactionResponse *response = (TransactionResponse *)malloc(sizeof(TransactionResponse));
-    if (!response) {
-        cJSON_Delete(response_json);
+    // Write the JSON payload into the handle's reusable body buffer, then send it
+    AddressResponse *response = NULL;
+    if (encode_address_request(handle->request_body, asset_pool_id, NULL, asset, reference) &&
+        perform_signed_post(client, handle, url)) {
+        // Parse response
+        response = decode_address_response(handle->response.memory, handle->response.size);
+    }
+    layer1_release_handle(client, handle);
+
+    if (response) {
+        layer1_forget_address_list(client, asset_pool_id, reference);
+    }
+
+    return response;
+}
+
+TransactionResponse *layer1_create_transaction(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *network,
+    const char *asset,
+    const char *to_address,
+    const char *amount,
+    const char *reference
+) {
+    if (!client || !asset_pool_id || !network || !asset || !to_address || !amount) {
         return NULL;
     }
 
-    // Initialize all fields to NULL
-    memset(response, 0, sizeof(TransactionResponse));
+    // Build the URL
+    char url[1024];
+    snprintf(url, sizeof(url), "%s/digital/v1/transaction-requests", client->base_url);
 
-    // Extract fields from JSON
-    cJSON *id = cJSON_GetObjectItem(response_json, "requestId");
-    cJSON *status = cJSON_GetObjectItem(response_json, "status");
-    cJSON *network_json = cJSON_GetObjectItem(response_json, "network");
-    cJSON *asset_json = cJSON_GetObjectItem(response_json, "asset");
-    cJSON *reference_json = cJSON_GetObjectItem(response_json, "reference");
-    cJSON *created_at = cJSON_GetObjectItem(response_json, "createdAt");
+    // Check out a CURL handle and its buffers for this request
+    PooledHandle *handle = handle_pool_acquire(client->handles);
+    if (!handle) {
+        return NULL;
+    }
 
-    // Copy values if they exist
-    if (cJSON_IsString(id)) response->id = strdup(id->valuestring);
-    if (cJSON_IsString(status)) response->status = strdup(status->valuestring);
-    if (cJSON_IsString(network_json)) response->network = strdup(network_json->valuestring);
-    if (cJSON_IsString(asset_json)) response->asset = strdup(asset_json->valuestring);
-    if (cJSON_IsString(reference_json)) response->reference = strdup(reference_json->valuestring);
-    if (cJSON_IsString(created_at)) response->createdAt = strdup(created_at->valuestring);
+    // Write the JSON request body into the handle's reusable body buffer, then send it
+    TransactionResponse *response = NULL;
+    if (encode_transaction_request(handle->request_body, asset_pool_id, network, asset, to_address, amount, reference) &&
+        perform_signed_post(client, handle, url)) {
+        // Parse the response
+        response = decode_transaction_response(handle->response.memory, handle->response.size);
+    }
+    layer1_release_handle(client, handle);
+
+    if (response) {
+        layer1_forget_transaction_lists(client, asset_pool_id);
+    }
 
-    cJSON_Delete(response_json);
     return response;
 }
 
@@ -690,149 +967,593 @@ void layer1_free_transaction_response(TransactionResponse *response) {
     free(response);
 }
 
-TransactionListResponse *layer1_list_transactions(Layer1Client *client, const char *asset_pool_id, const char *query) {
-    if (!client || !asset_pool_id || !query) {
-        return NULL;
+bool layer1_stream_transactions(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *query,
+    TransactionHandler handler,
+    void *user_data
+) {
+    return layer1_stream_transactions_fields(client, asset_pool_id, query, TRANSACTION_FIELDS_ALL, handler, user_data);
+}
+
+bool layer1_stream_transactions_fields(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *query,
+    unsigned int fields,
+    TransactionHandler handler,
+    void *user_data
+) {
+    if (!client || !asset_pool_id || !query || !handler) {
+        return false;
     }
 
-    // Initialize CURL if not already initialized
-    if (!client->curl) {
-        client->curl = curl_easy_init();
-        if (!client->curl) {
-            fprintf(stderr, "Failed to initialize CURL\n");
-            return NULL;
+    char url[TRANSACTIONS_URL_SIZE];
+    if (!layer1_build_transactions_url(url, sizeof(url), client, asset_pool_id, query)) {
+        return false;
+    }
+
+    TransactionStream stream = { handler, user_data };
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_TRANSACTION, true, forward_transaction, &stream);
+    response_decoder_select_fields(&decoder, fields);
+    bool ok = perform_decoded_get(client, url, true, &decoder);
+    response_decoder_free(&decoder);
+
+    return ok;
+}
+
+bool layer1_stream_transactions_raw(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *query,
+    BodyHandler handler,
+    void *user_data
+) {
+    if (!client || !asset_pool_id || !query || !handler) {
+        return false;
+    }
+
+    char url[TRANSACTIONS_URL_SIZE];
+    if (!layer1_build_transactions_url(url, sizeof(url), client, asset_pool_id, query)) {
+        return false;
+    }
+    return perform_raw_get(client, url, true, handler, user_data);
+}
+
+// Unreserved characters (RFC 3986) pass through a query value; all others become %XX
+static bool url_unreserved(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+static size_t url_encoded_length(const char *value) {
+    size_t length = 0;
+    for (const unsigned char *p = (const unsigned char *)value; *p; p++) {
+        length += url_unreserved(*p) ? 1 : 3;
+    }
+    return length;
+}
+
+static char *url_encode(char *out, const char *value) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (const unsigned char *p = (const unsigned char *)value; *p; p++) {
+        if (url_unreserved(*p)) {
+            *out++ = (char)*p;
+        } else {
+            *out++ = '%';
+            *out++ = hex[*p >> 4];
+            *out++ = hex[*p & 0x0F];
         }
     }
+    return out;
+}
 
-    // Build the URL
-    char url[1024];
-    snprintf(url, sizeof(url), "%s/digital/v1/transactions?assetPoolId=%s&q=%s", 
-             client->base_url, asset_pool_id, query);
-            
-    // Set up the request
-    curl_easy_reset(client->curl);
-    curl_easy_setopt(client->curl, CURLOPT_URL, url);
-    curl_easy_setopt(client->curl, CURLOPT_WRITEFUNCTION, write_callback);
-
-    // Set up response buffer
-    MemoryStruct chunk = {0};
-    chunk.memory = malloc(1);
-    chunk.size = 0;
-
-    if (!chunk.memory) {
-        fprintf(stderr, "Failed to allocate memory for response buffer\n");
-        return NULL;
+bool layer1_build_reference_query(char *query, size_t query_size, const char *reference, const char *filter) {
+    if (!query || !reference) {
+        return false;
+    }
+
+    size_t filter_length = filter ? 1 + strlen(filter) : 0;
+    size_t needed = strlen("reference:") + url_encoded_length(reference) + filter_length + 1;
+    if (needed > query_size) {
+        return false;
+    }
+
+    char *end = query + strlen("reference:");
+    memcpy(query, "reference:", strlen("reference:"));
+    end = url_encode(end, reference);
+    if (filter) {
+        *end++ = '+';
+        memcpy(end, filter, filter_length - 1);
+        end += filter_length - 1;
+    }
+    *end = '\0';
+    return true;
+}
+
+// GET a transactions URL page by page, page=0 first, until the records
+// received reach the response's totalElements or a page comes back empty.
+// Each page goes through a fresh decoder feeding handler, or table when set.
+static bool perform_paged_get(Layer1Client *client, const char *url, unsigned int fields,
+                              RecordHandler handler, void *user_data, TransactionTable *table) {
+    char page_url[TRANSACTIONS_URL_SIZE + 16];
+    long received = 0;
+
+    for (int page = 0;; page++) {
+        snprintf(page_url, sizeof(page_url), "%s&page=%d", url, page);
+
+        ResponseDecoder decoder;
+        response_decoder_init(&decoder, RECORD_TRANSACTION, true, handler, user_data);
+        response_decoder_select_fields(&decoder, fields);
+        if (table) {
+            response_decoder_collect_table(&decoder, table);
+        }
+        bool ok = perform_decoded_get(client, page_url, true, &decoder);
+        int records = decoder.record_count;
+        int page_number = decoder.page_number;
+        long total = decoder.total_elements;
+        response_decoder_free(&decoder);
+
+        if (!ok) {
+            return false;
+        }
+        // A server ignoring the page parameter would repeat the first page forever
+        if (page_number != page) {
+            fprintf(stderr, "Requested transactions page %d, got page %d\n", page, page_number);
+            return false;
+        }
+
+        received += records;
+        if (records == 0 || received >= total) {
+            return true;
+        }
+    }
+}
+
+// Routes the records of a batched query to the list of their reference
+typedef struct {
+    const char *const *references;
+    TransactionListResponse **lists;
+    int *capacities;
+    int *batches;               // Query each reference was packed into, -1 if none
+    uint32_t *slots;            // Open-addressed by reference: index of its first occurrence + 1
+    size_t mask;
+    int batch;                  // Query being received
+    bool failed;
+} ReferenceDemux;
+
+// Index of the first occurrence of reference, -1 when it was not asked for
+static int find_reference(const ReferenceDemux *demux, const char *reference) {
+    size_t slot = string_hash(reference) & demux->mask;
+    while (demux->slots[slot]) {
+        int index = (int)demux->slots[slot] - 1;
+        if (strcmp(demux->references[index], reference) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & demux->mask;
+    }
+    return -1;
+}
+
+static int add_reference(ReferenceDemux *demux, int index) {
+    size_t slot = string_hash(demux->references[index]) & demux->mask;
+    while (demux->slots[slot]) {
+        int first = (int)demux->slots[slot] - 1;
+        if (strcmp(demux->references[first], demux->references[index]) == 0) {
+            return first;
+        }
+        slot = (slot + 1) & demux->mask;
+    }
+    demux->slots[slot] = (uint32_t)index + 1;
+    return index;
+}
+
+static bool demux_transaction(void *record, void *user_data) {
+    Transaction *transaction = (Transaction *)record;
+    ReferenceDemux *demux = (ReferenceDemux *)user_data;
+
+    // Records of references from other queries, or not asked for, are dropped
+    int index = transaction->reference ? find_reference(demux, transaction->reference) : -1;
+    if (index < 0 || demux->batches[index] != demux->batch) {
+        layer1_free_transaction_fields(transaction);
+        return true;
+    }
+
+    TransactionListResponse *list = demux->lists[index];
+    if (list->count == demux->capacities[index]) {
+        int capacity = demux->capacities[index] ? demux->capacities[index] * 2 : 4;
+        Transaction *grown = realloc(list->transactions, sizeof(Transaction) * (size_t)capacity);
+        if (!grown) {
+            layer1_free_transaction_fields(transaction);
+            demux->failed = true;
+            return false;
+        }
+        list->transactions = grown;
+        demux->capacities[index] = capacity;
+    }
+    list->transactions[list->count++] = *transaction;
+    return true;
+}
+
+// Drop the lists of a query that failed part way
+static void discard_batch(ReferenceDemux *demux, int count) {
+    for (int i = 0; i < count; i++) {
+        if (demux->batches[i] == demux->batch) {
+            layer1_free_transaction_list_response(demux->lists[i]);
+            demux->lists[i] = NULL;
+            demux->batches[i] = -1;
+        }
     }
+}
+
+bool layer1_list_transactions_by_references(
+    Layer1Client *client,
+    const char *asset_pool_id,
+    const char *const *references,
+    int count,
+    const char *filter,
+    unsigned int fields,
+    TransactionListResponse **lists
+) {
+    if (!client || !asset_pool_id || !references || count < 0 || !lists) {
+        return false;
+    }
+    memset(lists, 0, sizeof(TransactionListResponse *) * (size_t)count);
+
+    // Room the references have in a URL after its fixed parts
+    char url[TRANSACTIONS_URL_SIZE];
+    char query[TRANSACTIONS_URL_SIZE];
+    if (!layer1_build_transactions_url(query, sizeof(query), client, asset_pool_id, "")) {
+        return false;
+    }
+    size_t prefix_length = strlen("reference:(");
+    size_t suffix_length = 1 + (filter ? 1 + strlen(filter) : 0);
+    size_t fixed = strlen(query) + prefix_length + suffix_length + 1;
+    if (fixed >= sizeof(query)) {
+        fprintf(stderr, "Transaction query filter is too long\n");
+        return false;
+    }
+    size_t budget = sizeof(query) - fixed;
+
+    size_t buckets = 2;
+    while (buckets < (size_t)count * 2) {
+        buckets *= 2;
+    }
+    ReferenceDemux demux = {
+        .references = references,
+        .lists = lists,
+        .capacities = calloc((size_t)count + 1, sizeof(int)),
+        .batches = malloc(sizeof(int) * ((size_t)count + 1)),
+        .slots = calloc(buckets, sizeof(uint32_t)),
+        .mask = buckets - 1
+    };
+    int *first = malloc(sizeof(int) * ((size_t)count + 1));
+    if (!demux.capacities || !demux.batches || !demux.slots || !first) {
+        free(demux.capacities);
+        free(demux.batches);
+        free(demux.slots);
+        free(first);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        first[i] = add_reference(&demux, i);
+        demux.batches[i] = -1;
+    }
+
+    // Pack distinct references into reference:(a+b+c) queries, in order,
+    // until the next one would make the URL too long
+    bool ok = true;
+    int next = 0;
+    while (next < count) {
+        memcpy(query, "reference:(", prefix_length);
+        char *end = query + prefix_length;
+        size_t used = 0;
+        int packed = 0;
+
+        for (; next < count; next++) {
+            if (first[next] != next) {
+                continue;
+            }
 
-    curl_easy_setopt(client->curl, CURLOPT_WRITEDATA, &chunk);
+            size_t length = url_encoded_length(references[next]);
+            if (length > budget) {
+                fprintf(stderr, "Reference %s is too long for a transactions query\n", references[next]);
+                ok = false;
+                continue;
+            }
+            if (used + (packed > 0) + length > budget) {
+                break;
+            }
 
-    // Create HTTP signer
-    HttpSigner *signer = http_signer_create(client->private_key, client->client_id);
-    if (!signer) {
-        free(chunk.memory);
+            lists[next] = calloc(1, sizeof(TransactionListResponse));
+            if (!lists[next]) {
+                ok = false;
+                continue;
+            }
+            if (packed > 0) {
+                *end++ = '+';
+            }
+            end = url_encode(end, references[next]);
+            used += (packed > 0) + length;
+            demux.batches[next] = demux.batch;
+            packed++;
+        }
+
+        if (packed == 0) {
+            continue;
+        }
+        *end++ = ')';
+        if (filter) {
+            *end++ = '+';
+            memcpy(end, filter, strlen(filter));
+            end += strlen(filter);
+        }
+        *end = '\0';
+
+        // Every page of the query is read, so no reference loses transactions
+        // to the page size
+        bool fetched = layer1_build_transactions_url(url, sizeof(url), client, asset_pool_id, query) &&
+                       perform_paged_get(client, url, fields | TRANSACTION_FIELD_REFERENCE,
+                                         demux_transaction, &demux, NULL);
+        if (!fetched || demux.failed) {
+            discard_batch(&demux, count);
+            demux.failed = false;
+            ok = false;
+        }
+        demux.batch++;
+    }
+
+    // Repeated references share the list of their first occurrence
+    for (int i = 0; i < count; i++) {
+        if (first[i] != i && lists[first[i]]) {
+            atomic_fetch_add(&lists[first[i]]->shared_refs, 1);
+            lists[i] = lists[first[i]];
+        }
+    }
+
+    free(demux.capacities);
+    free(demux.batches);
+    free(demux.slots);
+    free(first);
+    return ok;
+}
+
+static void share_transaction_list(void *result, int extra_holders) {
+    atomic_fetch_add(&((TransactionListResponse *)result)->shared_refs, extra_holders);
+}
+
+static void retain_transaction_list(void *value) {
+    share_transaction_list(value, 1);
+}
+
+static void release_transaction_list(void *value) {
+    layer1_free_transaction_list_response((TransactionListResponse *)value);
+}
+
+// True when every transaction reached a final status. An empty page may
+// still be followed by new transactions.
+static bool transactions_settled(const TransactionListResponse *list) {
+    if (list->count == 0) {
+        return false;
+    }
+
+    for (int i = 0; i < list->count; i++) {
+        const char *status = list->transactions[i].status;
+        if (!status || (strcmp(status, "SUCCESS") != 0 && strcmp(status, "FAILED") != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *fetch_transaction_list(void *context, const char *key) {
+    ListFetch *fetch = (ListFetch *)context;
+    Layer1Client *client = fetch->client;
+
+    // Create the response structure
+    TransactionListResponse *list_response = calloc(1, sizeof(TransactionListResponse));
+    if (!list_response) {
+        fprintf(stderr, "Failed to allocate memory for response\n");
         return NULL;
     }
 
-    // Set up headers
-    struct curl_slist *headers = NULL;
-    headers = add_common_headers(headers, true);
+    // Records are appended as soon as each one has been received
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_TRANSACTION, true, collect_transaction_record, list_response);
+    response_decoder_select_fields(&decoder, fetch->fields);
+    bool ok = perform_decoded_get(client, fetch->url, true, &decoder);
+    response_decoder_free(&decoder);
 
-    // Add signature headers
-    if (!http_signer_add_headers(signer, client->curl, url, NULL, "GET", &headers)) {
-        http_signer_destroy(signer);
-        free(chunk.memory);
-        curl_slist_free_all(headers);
+    if (!ok) {
+        layer1_free_transaction_list_response(list_response);
         return NULL;
     }
 
-    curl_easy_setopt(client->curl, CURLOPT_HTTPHEADER, headers);
+    if (client->list_cache) {
+        atomic_fetch_add(&list_response->shared_refs, 1);
+        cache_fetched_list(fetch, key, list_response,
+                           transactions_settled(list_response) ? client->settled_ttl_ms : client->pending_ttl_ms,
+                           release_transaction_list);
+    }
 
-    // Make the request
-    CURLcode res = curl_easy_perform(client->curl);
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        http_signer_destroy(signer);
-        curl_slist_free_all(headers);
-        free(chunk.memory);
+    return list_response;
+}
+
+TransactionListResponse *layer1_list_transactions(Layer1Client *client, const char *asset_pool_id, const char *query) {
+    return layer1_list_transactions_fields(client, asset_pool_id, query, TRANSACTION_FIELDS_ALL);
+}
+
+TransactionListResponse *layer1_list_transactions_fields(Layer1Client *client, const char *asset_pool_id,
+                                                         const char *query, unsigned int fields) {
+    if (!client || !asset_pool_id || !query) {
         return NULL;
     }
-    
-    // Parse the response
-    cJSON *json = cJSON_Parse(chunk.memory);
-    if (!json) {
-        fprintf(stderr, "Failed to parse JSON response\n");
-        http_signer_destroy(signer);
-        curl_slist_free_all(headers);
-        free(chunk.memory);
+
+    // Build the URL
+    char url[TRANSACTIONS_URL_SIZE];
+    if (!layer1_build_transactions_url(url, sizeof(url), client, asset_pool_id, query)) {
         return NULL;
     }
 
-    // Create the response structure
-    TransactionListResponse *list_response = (TransactionListResponse *)malloc(sizeof(TransactionListResponse));
-    if (!list_response) {
+    char key_buffer[TRANSACTIONS_URL_SIZE + 16];
+    const char *key = list_key(key_buffer, sizeof(key_buffer), url, fields, TRANSACTION_FIELDS_ALL);
+    ListFetch fetch = { client, url, fields, atomic_load(&client->cache_generation) };
+
+    if (client->list_cache) {
+        TransactionListResponse *cached = response_cache_get(client->list_cache, key, retain_transaction_list);
+        if (cached) {
+            return cached;
+        }
+    }
+
+    // Identical calls already in flight are joined rather than repeated
+    if (client->list_flights) {
+        return single_flight_run(client->list_flights, key, fetch_transaction_list, share_transaction_list, &fetch);
+    }
+    return fetch_transaction_list(&fetch, key);
+}
+
+static void share_transaction_table(void *result, int extra_holders) {
+    atomic_fetch_add(&((TransactionTable *)result)->shared_refs, extra_holders);
+}
+
+static void retain_transaction_table(void *value) {
+    share_transaction_table(value, 1);
+}
+
+static void release_transaction_table(void *value) {
+    layer1_free_transaction_table((TransactionTable *)value);
+}
+
+// Same rule as transactions_settled, checked once per distinct status
+static bool table_settled(const TransactionTable *table) {
+    if (table->count == 0) {
+        return false;
+    }
+
+    for (uint16_t code = 0; code < table->statuses.count; code++) {
+        const char *status = table->arena + table->statuses.values[code];
+        if (strcmp(status, "SUCCESS") != 0 && strcmp(status, "FAILED") != 0) {
+            return false;
+        }
+    }
+    for (int row = 0; row < table->count; row++) {
+        if (table->status[row] == TRANSACTION_TABLE_NO_CODE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *fetch_transaction_table(void *context, const char *key) {
+    ListFetch *fetch = (ListFetch *)context;
+    Layer1Client *client = fetch->client;
+
+    TransactionTable *table = calloc(1, sizeof(TransactionTable));
+    if (!table) {
         fprintf(stderr, "Failed to allocate memory for response\n");
-        cJSON_Delete(json);
-        http_signer_destroy(signer);
-        curl_slist_free_all(headers);
-        free(chunk.memory);
         return NULL;
     }
 
-    // Parse the transactions array
-    cJSON *content = cJSON_GetObjectItem(json, "content");
-    if (!content || !cJSON_IsArray(content)) {
-        fprintf(stderr, "Invalid response format: missing content array\n");
-        free(list_response);
-        cJSON_Delete(json);
-        http_signer_destroy(signer);
-        curl_slist_free_all(headers);
-        free(chunk.memory);
+    if (!perform_paged_get(client, fetch->url, fetch->fields, NULL, NULL, table)) {
+        layer1_free_transaction_table(table);
         return NULL;
     }
 
-    list_response->count = cJSON_GetArraySize(content);
-    list_response->transactions = (Transaction *)malloc(sizeof(Transaction) * list_response->count);
-    if (!list_response->transactions) {
-        fprintf(stderr, "Failed to allocate memory for transactions\n");
-        free(list_response);
-        cJSON_Delete(json);
-        http_signer_destroy(signer);
-        curl_slist_free_all(headers);
-        free(chunk.memory);
+    if (client->list_cache) {
+        atomic_fetch_add(&table->shared_refs, 1);
+        cache_fetched_list(fetch, key, table,
+                           table_settled(table) ? client->settled_ttl_ms : client->pending_ttl_ms,
+                           release_transaction_table);
+    }
+
+    return table;
+}
+
+TransactionTable *layer1_list_transactions_table(Layer1Client *client, const char *asset_pool_id,
+                                                 const char *query, unsigned int fields) {
+    if (!client || !asset_pool_id || !query) {
         return NULL;
     }
 
-    // Parse each transaction
-    for (int i = 0; i < list_response->count; i++) {
-        cJSON *item = cJSON_GetArrayItem(content, i);
-        Transaction *tx = &list_response->transactions[i];
+    char url[TRANSACTIONS_URL_SIZE];
+    if (!layer1_build_transactions_url(url, sizeof(url), client, asset_pool_id, query)) {
+        return NULL;
+    }
 
-        cJSON *id = cJSON_GetObjectItem(item, "id");
-        cJSON *status = cJSON_GetObjectItem(item, "status");
-        cJSON *asset = cJSON_GetObjectItem(item, "asset");
-        cJSON *createdAt = cJSON_GetObjectItem(item, "createdAt");
-        cJSON *amount = cJSON_GetObjectItem(item, "amount");
+    // Tables share the cache with lists under keys of their own
+    char key[TRANSACTIONS_URL_SIZE + 16];
+    snprintf(key, sizeof(key), "%s#table=%x", url, fields);
+    ListFetch fetch = { client, url, fields, atomic_load(&client->cache_generation) };
 
-        cJSON *address = cJSON_GetObjectItem(item, "address");
-        cJSON *reference = address ? cJSON_GetObjectItem(address, "reference") : NULL;
-        cJSON *network = address ? cJSON_GetObjectItem(address, "network") : NULL;
-        
-        tx->id = id ? strdup(id->valuestring) : NULL;
-        tx->status = status ? strdup(status->valuestring) : NULL;
-        tx->network = network ? strdup(network->valuestring) : NULL;
-        tx->asset = asset ? strdup(asset->valuestring) : NULL;
-        tx->reference = reference ? strdup(reference->valuestring) : NULL;
-        tx->createdAt = createdAt ? strdup(createdAt->valuestring) : NULL;
-        tx->amount = amount ? strdup(amount->valuestring) : NULL;
+    if (client->list_cache) {
+        TransactionTable *cached = response_cache_get(client->list_cache, key, retain_transaction_table);
+        if (cached) {
+            return cached;
+        }
     }
 
-    // Clean up
-    cJSON_Delete(json);
-    http_signer_destroy(signer);
-    curl_slist_free_all(headers);
-    free(chunk.memory);
+    if (client->list_flights) {
+        return single_flight_run(client->list_flights, key, fetch_transaction_table, share_transaction_table, &fetch);
+    }
+    return fetch_transaction_table(&fetch, key);
+}
 
-    return list_response;
+static const struct {
+    const char *name;
+    unsigned int field;
+} transaction_field_names[] = {
+    { "id", TRANSACTION_FIELD_ID },
+    { "status", TRANSACTION_FIELD_STATUS },
+    { "network", TRANSACTION_FIELD_NETWORK },
+    { "asset", TRANSACTION_FIELD_ASSET },
+    { "reference", TRANSACTION_FIELD_REFERENCE },
+    { "createdAt", TRANSACTION_FIELD_CREATED_AT },
+    { "amount", TRANSACTION_FIELD_AMOUNT }
+};
+
+bool layer1_parse_transaction_fields(const char *names, unsigned int *fields) {
+    *fields = 0;
+
+    const char *name = names;
+    while (true) {
+        size_t length = strcspn(name, ",");
+        bool known = false;
+        for (size_t i = 0; i < sizeof(transaction_field_names) / sizeof(transaction_field_names[0]); i++) {
+            if (strlen(transaction_field_names[i].name) == length &&
+                strncmp(transaction_field_names[i].name, name, length) == 0) {
+                *fields |= transaction_field_names[i].field;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "Unknown transaction field '%.*s'\n", (int)length, name);
+            return false;
+        }
+
+        if (name[length] == '\0') {
+            return true;
+        }
+        name += length + 1;
+    }
+}
+
+void layer1_free_transaction_fields(Transaction *transaction) {
+    if (!transaction) {
+        return;
+    }
+
+    free(transaction->id);
+    free(transaction->status);
+    free(transaction->network);
+    free(transaction->asset);
+    free(transaction->reference);
+    free(transaction->createdAt);
+    free(transaction->amount);
 }
 
 void layer1_free_transaction_list_response(TransactionListResponse *response) {
@@ -840,15 +1561,13 @@ void layer1_free_transaction_list_response(TransactionListResponse *response) {
         return;
     }
 
+    // A coalesced response is freed by its last holder
+    if (atomic_fetch_sub(&response->shared_refs, 1) > 0) {
+        return;
+    }
+
     for (int i = 0; i < response->count; i++) {
-        Transaction *tx = &response->transactions[i];
-        free(tx->id);
-        free(tx->status);
-        free(tx->network);
-        free(tx->asset);
-        free(tx->reference);
-        free(tx->createdAt);
-        free(tx->amount);
+        layer1_free_transaction_fields(&response->transactions[i]);
     }
 
     free(response->transactions);
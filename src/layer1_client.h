@@ -2,18 +2,66 @@
 #define LAYER1_CLIENT_H
 
 #include <curl/curl.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "http_signer.h"
 
 typedef struct {
     char *memory;
     size_t size;
+    size_t capacity;
+    CURL *curl;                 // Transfer filling the buffer, for Content-Length; may be NULL
 } MemoryStruct;
 
+// Body sizes of one request. They differ when the response was compressed.
+typedef struct {
+    curl_off_t wire_bytes;      // Body bytes as received
+    curl_off_t decoded_bytes;   // Body bytes after decompression
+} Layer1TransferStats;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;         // Dropped to stay within max_entries
+    uint64_t expirations;       // Dropped because their TTL had passed
+    size_t entries;
+} Layer1CacheStats;
+
+// Called after every request with its method, URL and body sizes, on the
+// thread that made the request
+typedef void (*TransferObserver)(const char *method, const char *url, const Layer1TransferStats *stats, void *user_data);
+
+// Concurrency contract: once created and configured, a Layer1Client can be
+// shared by any number of threads, and all request functions may run at the
+// same time. Each request checks a CURL handle and its buffers out of the
+// client's pool, and the signer is read-only after creation.
+// - The layer1_client_set_* functions are not synchronized. Call them before
+//   the client is shared.
+// - layer1_client_destroy must not race with requests.
+// - curl_global_init must have run before the first client is created.
+// - The command registry is filled once at startup and is read-only afterwards.
+// - With coalescing or the list cache on, identical list calls can return the
+//   same response object. Treat list responses as read-only and free each
+//   one once.
 typedef struct {
     char *base_url;
     char *client_id;
     char *private_key;
-    CURL *curl;
+    HttpSigner *signer;                 // Parsed once, read-only afterwards
+    struct HandlePool *handles;         // CURL handles and buffers, one per in-flight request
+    size_t response_high_water;         // Larger response buffers are freed after use
+    char *accept_encoding;              // NULL leaves response compression off
+    pthread_mutex_t stats_lock;
+    Layer1TransferStats last_transfer;  // Most recent request on any thread
+    TransferObserver transfer_observer;
+    void *transfer_observer_data;
+    struct SingleFlight *list_flights;  // NULL unless list coalescing is on
+    struct ResponseCache *list_cache;   // NULL unless the list cache is on
+    unsigned int settled_ttl_ms;        // Lifetime of lists that will not change
+    unsigned int pending_ttl_ms;        // Lifetime of lists that still can
+    atomic_uint_fast64_t cache_generation; // Bumped by every create; lists fetched across one are not cached
 } Layer1Client;
 
 typedef struct Command {
@@ -21,6 +69,7 @@ typedef struct Command {
     const char *description;
     bool (*execute)(Layer1Client *client, int argc, char **argv);
     void (*help)(void);
+    bool raw_output;            // Passes response bodies through under --raw
 } Command;
 
 typedef struct {
@@ -40,8 +89,25 @@ typedef struct {
     int pageNumber;
     int pageSize;
     long totalElements;
+    atomic_int shared_refs;     // Holders besides the first, when coalesced
 } AddressListResponse;
 
+// Parsed timestamp of a record without a valid createdAt
+#define LAYER1_TIME_NONE INT64_MIN
+
+// Ids in binary form, for indexes, dedup sets and joins: fixed-size keys that
+// compare with one memcmp. They go back to text only when written out.
+#define LAYER1_UUID_TEXT_SIZE 37                // "0195bb81-4a56-7916-aae8-109f276eb8fd" and its NUL
+#define LAYER1_TRANSACTION_ID_TEXT_SIZE 73      // 72 hex digits and a NUL
+
+typedef struct {
+    uint8_t bytes[16];
+} Layer1Uuid;                   // Address and transaction request ids
+
+typedef struct {
+    uint8_t bytes[36];
+} Layer1TransactionId;          // Ids of listed transactions
+
 typedef struct {
     char *id;
     char *status;
@@ -50,13 +116,60 @@ typedef struct {
     char *reference;
     char *createdAt;
     char *amount;
+    int64_t createdAtMs;        // createdAt in milliseconds since the epoch, or LAYER1_TIME_NONE
 } Transaction;
 
 typedef struct {
     Transaction *transactions;
     int count;
+    atomic_int shared_refs;     // Holders besides the first, when coalesced
 } TransactionListResponse;
 
+// Column-oriented transaction page for large result sets. Every string lives
+// in one arena; text columns hold an arena offset per row, and the few
+// distinct statuses, networks and assets are interned into dictionaries so
+// their columns hold a 16-bit code per row. Scans over a column touch one
+// contiguous array instead of chasing a pointer per record. Ids are kept in
+// binary form in id_key; ids that are not 72 lowercase hex digits go to the
+// arena, so every id reads back exactly as received.
+#define TRANSACTION_TABLE_NO_OFFSET UINT32_MAX  // Text column row without a value
+#define TRANSACTION_TABLE_BINARY_ID (UINT32_MAX - 1)    // id row whose value is in id_key
+#define TRANSACTION_TABLE_NO_CODE UINT16_MAX    // Interned column row without a value
+
+typedef struct {
+    uint32_t *values;           // Arena offset of each distinct value, indexed by code
+    uint16_t count;
+    uint16_t capacity;
+    uint16_t last_code;         // Code of the previous lookup, tried first
+} TransactionDictionary;
+
+typedef struct {
+    int count;                  // Rows
+    char *arena;                // NUL-terminated strings, back to back
+    size_t arena_length;
+
+    uint32_t *id;               // TRANSACTION_TABLE_BINARY_ID for ids in id_key
+    Layer1TransactionId *id_key;
+    uint32_t *reference;
+    uint32_t *created_at;
+    uint32_t *amount;
+    int64_t *created_at_ms;     // Parsed created_at, or LAYER1_TIME_NONE
+
+    uint16_t *status;
+    uint16_t *network;
+    uint16_t *asset;
+    TransactionDictionary statuses;
+    TransactionDictionary networks;
+    TransactionDictionary assets;
+
+    atomic_int shared_refs;     // Holders besides the first, when coalesced or cached
+
+    // Builder state
+    size_t arena_capacity;
+    int row_capacity;
+    unsigned int row_fields;    // TRANSACTION_FIELD_* bits already set in the row being decoded
+} TransactionTable;
+
 typedef struct {
     char *id;
     char *status;
@@ -66,10 +179,70 @@ typedef struct {
     char *createdAt;
 } TransactionResponse;
 
+// Field masks for the *_fields list calls. Fields left out are skipped while
+// decoding, without allocating, and stay NULL in the records.
+enum {
+    ADDRESS_FIELD_ID            = 1 << 0,
+    ADDRESS_FIELD_ADDRESS       = 1 << 1,
+    ADDRESS_FIELD_NETWORK       = 1 << 2,
+    ADDRESS_FIELD_ASSET         = 1 << 3,
+    ADDRESS_FIELD_REFERENCE     = 1 << 4,
+    ADDRESS_FIELD_ASSET_POOL_ID = 1 << 5,
+    ADDRESS_FIELD_STATUS        = 1 << 6,
+    ADDRESS_FIELD_CREATED_AT    = 1 << 7,
+    ADDRESS_FIELDS_ALL          = (1 << 8) - 1
+};
+
+enum {
+    TRANSACTION_FIELD_ID         = 1 << 0,
+    TRANSACTION_FIELD_STATUS     = 1 << 1,
+    TRANSACTION_FIELD_NETWORK    = 1 << 2,
+    TRANSACTION_FIELD_ASSET      = 1 << 3,
+    TRANSACTION_FIELD_REFERENCE  = 1 << 4,
+    TRANSACTION_FIELD_CREATED_AT = 1 << 5,
+    TRANSACTION_FIELD_AMOUNT     = 1 << 6,
+    TRANSACTION_FIELDS_ALL       = (1 << 7) - 1
+};
+
+// Streaming handlers, called once per record as soon as it has been received.
+// The handler takes ownership of the record. Return false to stop the transfer.
+typedef bool (*AddressHandler)(AddressResponse *address, void *user_data);
+typedef bool (*TransactionHandler)(Transaction *transaction, void *user_data);
+
+// Raw body handler, called with the response bytes exactly as they arrive,
+// without decoding. Return false to stop the transfer.
+typedef bool (*BodyHandler)(const char *data, size_t length, void *user_data);
+
 // Client management
 Layer1Client *layer1_client_create(const char *base_url, const char *client_id, const char *private_key_path);
 void layer1_client_destroy(Layer1Client *client);
 
+// Response buffers grown beyond this many bytes are released after the request (default 1 MiB)
+void layer1_client_set_response_high_water(Layer1Client *client, size_t bytes);
+
+// Ask for compressed responses. encodings is a CURLOPT_ACCEPT_ENCODING list such as
+// "gzip, br, zstd"; "" offers every encoding libcurl was built with, NULL turns it off.
+bool layer1_client_set_compression(Layer1Client *client, const char *encodings);
+
+// Body sizes of the most recent request, and an optional per-request observer
+Layer1TransferStats layer1_client_last_transfer(Layer1Client *client);
+void layer1_client_set_transfer_observer(Layer1Client *client, TransferObserver observer, void *user_data);
+
+// Let concurrent identical layer1_list_addresses / layer1_list_transactions
+// calls share one request and one decoded response (off by default)
+bool layer1_client_set_coalescing(Layer1Client *client, bool enabled);
+
+// List calls that were answered by joining a request already in flight
+uint64_t layer1_client_coalesced_requests(Layer1Client *client);
+
+// Serve repeated list calls from an LRU cache of up to max_entries responses,
+// keyed by URL. Lists whose transactions all reached SUCCESS or FAILED, and
+// non-empty address lists, live for settled_ttl_ms; all others for
+// pending_ttl_ms. max_entries 0 turns the cache off.
+bool layer1_client_set_cache(Layer1Client *client, size_t max_entries,
+                             unsigned int settled_ttl_ms, unsigned int pending_ttl_ms);
+Layer1CacheStats layer1_client_cache_stats(Layer1Client *client);
+
 // Command management
 void register_command(Command *command);
 Command *get_command(const char *name);
@@ -82,6 +255,11 @@ size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp);
 AddressResponse *layer1_create_address(Layer1Client *client, const char *asset_pool_id, const char *network, const char *asset, const char *reference);
 AddressResponse *layer1_create_address_by_asset(Layer1Client *client, const char *asset_pool_id, const char *asset, const char *reference);
 AddressListResponse *layer1_list_addresses(Layer1Client *client, const char *asset_pool_id, const char *reference);
+bool layer1_stream_addresses(Layer1Client *client, const char *asset_pool_id, const char *reference, AddressHandler handler, void *user_data);
+AddressListResponse *layer1_list_addresses_fields(Layer1Client *client, const char *asset_pool_id, const char *reference, unsigned int fields);
+bool layer1_stream_addresses_fields(Layer1Client *client, const char *asset_pool_id, const char *reference, unsigned int fields, AddressHandler handler, void *user_data);
+bool layer1_stream_addresses_raw(Layer1Client *client, const char *asset_pool_id, const char *reference, BodyHandler handler, void *user_data);
+void layer1_free_address_fields(AddressResponse *address);
 void layer1_free_address_response(AddressResponse *response);
 void layer1_free_address_list_response(AddressListResponse *response);
 
@@ -89,6 +267,58 @@ void layer1_free_address_list_response(AddressListResponse *response);
 TransactionResponse *layer1_create_transaction(Layer1Client *client, const char *asset_pool_id, const char *network, const char *asset, const char *to_address, const char *amount, const char *reference);
 void layer1_free_transaction_response(TransactionResponse *response);
 TransactionListResponse *layer1_list_transactions(Layer1Client *client, const char *asset_pool_id, const char *query);
+bool layer1_stream_transactions(Layer1Client *client, const char *asset_pool_id, const char *query, TransactionHandler handler, void *user_data);
+TransactionListResponse *layer1_list_transactions_fields(Layer1Client *client, const char *asset_pool_id, const char *query, unsigned int fields);
+bool layer1_stream_transactions_fields(Layer1Client *client, const char *asset_pool_id, const char *query, unsigned int fields, TransactionHandler handler, void *user_data);
+bool layer1_stream_transactions_raw(Layer1Client *client, const char *asset_pool_id, const char *query, BodyHandler handler, void *user_data);
+// Write the query reference:<reference>+<filter> with the reference URL
+// encoded; filter is optional. False if it does not fit in query_size.
+#define LAYER1_QUERY_SIZE 1024      // Room for a query that still fits in a request URL
+bool layer1_build_reference_query(char *query, size_t query_size, const char *reference, const char *filter);
+// Transactions of many references, with the references packed into as few
+// reference:(a+b+c) queries as the URL length allows. References are URL
+// encoded; filter holds further query terms for every query, such as
+// type:(deposit+withdrawal), or is NULL. lists receives one list per
+// reference, in the order given, holding the transactions whose reference
+// matches it; the reference field is always decoded. Every page of each
+// query is read, following totalElements. A repeated reference shares one
+// list. False if any query failed; the references it carried get
+// NULL lists and the others are still filled. Free each list once.
+bool layer1_list_transactions_by_references(Layer1Client *client, const char *asset_pool_id, const char *const *references, int count, const char *filter, unsigned int fields, TransactionListResponse **lists);
+void layer1_free_transaction_fields(Transaction *transaction);
 void layer1_free_transaction_list_response(TransactionListResponse *response);
 
+// Columnar variant of layer1_list_transactions_fields. Every page of the
+// query is read into one table, following totalElements. Tables are
+// coalesced and cached like lists when that is on, so treat them as
+// read-only, and free each one once.
+TransactionTable *layer1_list_transactions_table(Layer1Client *client, const char *asset_pool_id, const char *query, unsigned int fields);
+void layer1_free_transaction_table(TransactionTable *table);
+
+// The string in a table column (a TRANSACTION_FIELD_* bit) for one row, NULL
+// when missing. Binary ids have no string; read them with layer1_transaction_table_id.
+const char *layer1_transaction_table_value(const TransactionTable *table, unsigned int field, int row);
+
+// Code of value in an interned column, TRANSACTION_TABLE_NO_CODE when no row has it
+uint16_t layer1_transaction_table_code(const TransactionTable *table, unsigned int field, const char *value);
+
+// The id of one table row as text: the arena string of an id kept as text,
+// or the binary id re-encoded into out. NULL when the row has no id.
+const char *layer1_transaction_table_id(const TransactionTable *table, int row, char out[LAYER1_TRANSACTION_ID_TEXT_SIZE]);
+
+// Binary ids. The parsers accept either case and fail on anything but the
+// exact layout; formatting writes lowercase text with its NUL. The canonical
+// parser accepts lowercase only, so what it parses formats back unchanged.
+bool layer1_uuid_parse(const char *text, size_t length, Layer1Uuid *id);
+void layer1_uuid_format(const Layer1Uuid *id, char out[LAYER1_UUID_TEXT_SIZE]);
+uint64_t layer1_uuid_hash(const Layer1Uuid *id);
+bool layer1_transaction_id_parse(const char *text, size_t length, Layer1TransactionId *id);
+bool layer1_transaction_id_parse_canonical(const char *text, size_t length, Layer1TransactionId *id);
+void layer1_transaction_id_format(const Layer1TransactionId *id, char out[LAYER1_TRANSACTION_ID_TEXT_SIZE]);
+uint64_t layer1_transaction_id_hash(const Layer1TransactionId *id);
+
+// Parse a comma-separated list of transaction field names (id, status, network,
+// asset, reference, createdAt, amount) into a TRANSACTION_FIELD_* mask
+bool layer1_parse_transaction_fields(const char *names, unsigned int *fields);
+
 #endif /* LAYER1_CLIENT_H */ 
@@ -3,6 +3,11 @@
 #include "commands/create_address_by_asset.h"
 #include "commands/create_transaction.h"
 #include "commands/list_transactions.h"
+#include "commands/bulk_create_address_by_asset.h"
+#include "commands/summarize_transactions.h"
+#include "commands/reconcile.h"
+#include "batch.h"
+#include "output.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,9 +18,18 @@ void init_commands(void) {
     register_create_address_by_asset_command();
     register_create_transaction_command();
     register_list_transactions_command();
+    register_bulk_create_address_by_asset_command();
+    register_summarize_transactions_command();
+    register_reconcile_command();
     // Register other commands here
 }
 
+static void print_transfer_stats(const char *method, const char *url, const Layer1TransferStats *stats, void *user_data) {
+    double ratio = stats->wire_bytes > 0 ? (double)stats->decoded_bytes / (double)stats->wire_bytes : 1.0;
+    fprintf(stderr, "%s %s: %lld bytes received, %lld bytes decoded (%.1fx)\n",
+            method, url, (long long)stats->wire_bytes, (long long)stats->decoded_bytes, ratio);
+}
+
 void print_usage(void) {
     printf("Usage: layer1_cli [--base-url <url>] --client-id <id> --key-file <path> <command> [args...]\n");
     printf("\n");
@@ -23,12 +37,20 @@ void print_usage(void) {
     printf("  --base-url <url>    Base URL for the API (default: https://api.sandbox.layer1.com)\n");
     printf("  --client-id <id>    OAuth2 Client ID\n");
     printf("  --key-file <path>   Path to the private key file\n");
+    printf("  --compress          Request compressed responses (gzip, br, zstd as supported)\n");
+    printf("  --transfer-stats    Print received and decoded body sizes for each request\n");
+    printf("  --batch <path|->    Run one command per line from a file or stdin instead of <command>\n");
+    printf("  --format <format>   Output records as text (default), jsonl, csv or tsv\n");
+    printf("  --raw               Write API response bodies to stdout as received, undecoded\n");
     printf("\n");
     printf("Commands:\n");
     printf("  create-address            Create a new address\n");
     printf("  create-address-by-asset   Create a new address for a specific asset\n");
     printf("  create-transaction        Create a new transaction\n");
     printf("  list-transactions         List transactions by reference\n");
+    printf("  bulk-create-address-by-asset  Create addresses by asset for a list of references\n");
+    printf("  summarize-transactions    Count and sum transactions by network, asset and status\n");
+    printf("  reconcile                 Match a ledger export against API transactions\n");
     printf("\n");
     printf("Run 'layer1_cli <command> --help' for more information on a command.\n");
 }
@@ -38,6 +60,9 @@ int main(int argc, char *argv[]) {
     const char *base_url = "https://api.sandbox.layer1.com";
     const char *client_id = NULL;
     const char *key_file = NULL;
+    bool compress = false;
+    bool transfer_stats = false;
+    const char *batch_file = NULL;
     
     // Parse command line arguments
     int arg_index = 1;
@@ -69,6 +94,32 @@ int main(int argc, char *argv[]) {
                 print_usage();
                 return 1;
             }
+        } else if (strcmp(argv[arg_index], "--compress") == 0) {
+            compress = true;
+            arg_index++;
+        } else if (strcmp(argv[arg_index], "--transfer-stats") == 0) {
+            transfer_stats = true;
+            arg_index++;
+        } else if (strcmp(argv[arg_index], "--format") == 0) {
+            if (arg_index + 1 < argc && output_set_format(argv[arg_index + 1])) {
+                arg_index += 2;
+            } else {
+                fprintf(stderr, "Error: --format needs one of text, jsonl, csv, tsv\n");
+                print_usage();
+                return 1;
+            }
+        } else if (strcmp(argv[arg_index], "--raw") == 0) {
+            output_set_format("raw");
+            arg_index++;
+        } else if (strcmp(argv[arg_index], "--batch") == 0) {
+            if (arg_index + 1 < argc) {
+                batch_file = argv[arg_index + 1];
+                arg_index += 2;
+            } else {
+                fprintf(stderr, "Error: Missing value for --batch\n");
+                print_usage();
+                return 1;
+            }
         } else {
             // This must be the command
             break;
@@ -88,8 +139,14 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    // Check if a command was provided
-    if (arg_index >= argc) {
+    // Check if a command was provided; in batch mode the commands come from the input
+    if (batch_file && arg_index < argc) {
+        fprintf(stderr, "Error: --batch cannot be combined with a command\n");
+        print_usage();
+        return 1;
+    }
+
+    if (!batch_file && arg_index >= argc) {
         fprintf(stderr, "Error: No command specified\n");
         print_usage();
         return 1;
@@ -102,23 +159,32 @@ int main(int argc, char *argv[]) {
     init_commands();
     
     // Get the command
-    const char *command_name = argv[arg_index++];
-    Command *command = get_command(command_name);
-    
-    if (!command) {
-        fprintf(stderr, "Error: Unknown command '%s'\n", command_name);
-        print_usage();
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Check for help flag
-    if (arg_index < argc && strcmp(argv[arg_index], "--help") == 0) {
-        command->help();
-        curl_global_cleanup();
-        return 0;
+    Command *command = NULL;
+    if (!batch_file) {
+        const char *command_name = argv[arg_index++];
+        command = get_command(command_name);
+
+        if (!command) {
+            fprintf(stderr, "Error: Unknown command '%s'\n", command_name);
+            print_usage();
+            curl_global_cleanup();
+            return 1;
+        }
+
+        // Check for help flag
+        if (arg_index < argc && strcmp(argv[arg_index], "--help") == 0) {
+            command->help();
+            curl_global_cleanup();
+            return 0;
+        }
+
+        if (output_format() == OUTPUT_RAW && !command->raw_output) {
+            fprintf(stderr, "Error: --raw is not supported by %s\n", command->name);
+            curl_global_cleanup();
+            return 1;
+        }
     }
-    
+
     // Create client
     Layer1Client *client = layer1_client_create(base_url, client_id, key_file);
     if (!client) {
@@ -126,9 +192,41 @@ int main(int argc, char *argv[]) {
         curl_global_cleanup();
         return 1;
     }
+
+    // An empty list offers every encoding libcurl was built with
+    if (compress && !layer1_client_set_compression(client, "")) {
+        fprintf(stderr, "Error: Failed to enable compression\n");
+        layer1_client_destroy(client);
+        curl_global_cleanup();
+        return 1;
+    }
+
+    if (transfer_stats) {
+        layer1_client_set_transfer_observer(client, print_transfer_stats, NULL);
+    }
     
-    // Execute command
-    bool success = command->execute(client, argc - arg_index + 1, argv + arg_index - 1);
+    // Execute the command, or every command of the batch on this one client
+    bool success;
+    if (batch_file) {
+        FILE *batch_input = strcmp(batch_file, "-") == 0 ? stdin : fopen(batch_file, "r");
+        if (!batch_input) {
+            fprintf(stderr, "Error: Failed to open batch file %s\n", batch_file);
+            layer1_client_destroy(client);
+            curl_global_cleanup();
+            return 1;
+        }
+        success = run_command_batch(client, batch_input);
+        if (batch_input != stdin) {
+            fclose(batch_input);
+        }
+    } else {
+        success = command->execute(client, argc - arg_index + 1, argv + arg_index - 1);
+    }
+    
+    if (!output_flush()) {
+        fprintf(stderr, "Error: Failed to write output\n");
+        success = false;
+    }
     
     // Clean up
     layer1_client_destroy(client);
@@ -0,0 +1,348 @@
+#include "output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+
+static OutputFormat format = OUTPUT_TEXT;
+static char *buffer = NULL;
+static size_t buffered = 0;
+static bool write_failed = false;
+
+static const OutputSchema *record_schema = NULL;
+static const OutputSchema *header_schema = NULL;   // Schema of the last CSV/TSV header row
+static int column = 0;
+
+bool output_set_format(const char *name) {
+    if (strcmp(name, "text") == 0) {
+        format = OUTPUT_TEXT;
+    } else if (strcmp(name, "jsonl") == 0) {
+        format = OUTPUT_JSONL;
+    } else if (strcmp(name, "csv") == 0) {
+        format = OUTPUT_CSV;
+    } else if (strcmp(name, "tsv") == 0) {
+        format = OUTPUT_TSV;
+    } else if (strcmp(name, "raw") == 0) {
+        format = OUTPUT_RAW;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+OutputFormat output_format(void) {
+    return format;
+}
+
+static void write_all(const char *data, size_t length) {
+    while (length > 0 && !write_failed) {
+        ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            write_failed = true;
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+bool output_flush(void) {
+    // Anything a command printed through stdio comes first
+    fflush(stdout);
+    write_all(buffer, buffered);
+    buffered = 0;
+    return !write_failed;
+}
+
+bool output_raw(const char *data, size_t length) {
+    // Keep records and stdio output from before in order, then bypass the buffer
+    output_flush();
+    write_all(data, length);
+    return !write_failed;
+}
+
+// Records that are not CSV or TSV are JSON lines, also alongside raw bodies
+static inline bool json_records(void) {
+    return format == OUTPUT_JSONL || format == OUTPUT_RAW;
+}
+
+// Slow path: no buffer yet, or not enough room left in it
+static void append_slow(const char *data, size_t length) {
+    if (!buffer) {
+        buffer = malloc(OUTPUT_BUFFER_SIZE);
+        if (!buffer) {
+            fflush(stdout);
+            write_all(data, length);
+            return;
+        }
+    }
+
+    if (buffered + length > OUTPUT_BUFFER_SIZE) {
+        output_flush();
+        if (length > OUTPUT_BUFFER_SIZE) {
+            write_all(data, length);
+            return;
+        }
+    }
+
+    memcpy(buffer + buffered, data, length);
+    buffered += length;
+}
+
+static inline void append(const char *data, size_t length) {
+    if (buffer && buffered + length <= OUTPUT_BUFFER_SIZE) {
+        memcpy(buffer + buffered, data, length);
+        buffered += length;
+        return;
+    }
+    append_slow(data, length);
+}
+
+static inline void append_char(char c) {
+    if (buffer && buffered < OUTPUT_BUFFER_SIZE) {
+        buffer[buffered++] = c;
+        return;
+    }
+    append_slow(&c, 1);
+}
+
+// Quote and escape for JSON, copying runs of plain bytes in one go
+static void append_json_string(const char *value) {
+    append_char('"');
+    const char *run = value;
+    const char *p = value;
+    for (;; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        if (c == '\0') {
+            break;
+        }
+
+        append(run, (size_t)(p - run));
+        run = p + 1;
+
+        char escaped[8];
+        switch (c) {
+            case '"':  append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            default:
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                append(escaped, 6);
+                break;
+        }
+    }
+    append(run, (size_t)(p - run));
+    append_char('"');
+}
+
+// Quote only fields that need it, doubling embedded quotes
+static void append_csv_field(const char *value) {
+    if (!strpbrk(value, ",\"\r\n")) {
+        append(value, strlen(value));
+        return;
+    }
+
+    append_char('"');
+    const char *run = value;
+    for (const char *quote = strchr(run, '"'); quote; quote = strchr(run, '"')) {
+        append(run, (size_t)(quote - run + 1));
+        append_char('"');
+        run = quote + 1;
+    }
+    append(run, strlen(run));
+    append_char('"');
+}
+
+static void append_tsv_field(const char *value) {
+    if (!strpbrk(value, "\t\n\r\\")) {
+        append(value, strlen(value));
+        return;
+    }
+
+    const char *run = value;
+    for (const char *p = value; *p; p++) {
+        const char *escaped;
+        switch (*p) {
+            case '\t': escaped = "\\t"; break;
+            case '\n': escaped = "\\n"; break;
+            case '\r': escaped = "\\r"; break;
+            case '\\': escaped = "\\\\"; break;
+            default: continue;
+        }
+        append(run, (size_t)(p - run));
+        append(escaped, 2);
+        run = p + 1;
+    }
+    append(run, strlen(run));
+}
+
+static void append_separator(void) {
+    if (column > 0) {
+        append_char(format == OUTPUT_TSV ? '\t' : ',');
+    }
+}
+
+void output_begin_record(const OutputSchema *schema) {
+    record_schema = schema;
+    column = 0;
+
+    if (json_records()) {
+        append_char('{');
+        return;
+    }
+
+    if ((format == OUTPUT_CSV || format == OUTPUT_TSV) && header_schema != schema) {
+        header_schema = schema;
+        for (int i = 0; i < schema->column_count; i++) {
+            append_separator();
+            append(schema->columns[i], strlen(schema->columns[i]));
+            column++;
+        }
+        append_char('\n');
+        column = 0;
+    }
+}
+
+static void begin_field(void) {
+    append_separator();
+    if (json_records()) {
+        append_char('"');
+        const char *name = record_schema->columns[column];
+        append(name, strlen(name));
+        append("\":", 2);
+    }
+    column++;
+}
+
+void output_string(const char *value) {
+    begin_field();
+    if (json_records()) {
+        if (value) {
+            append_json_string(value);
+        } else {
+            append("null", 4);
+        }
+    } else if (value) {
+        if (format == OUTPUT_CSV) {
+            append_csv_field(value);
+        } else {
+            append_tsv_field(value);
+        }
+    }
+}
+
+void output_literal(const char *value) {
+    begin_field();
+    append(value, strlen(value));
+}
+
+void output_end_record(void) {
+    if (json_records()) {
+        append_char('}');
+    }
+    append_char('\n');
+}
+
+static const char *const address_columns[] = {
+    "id", "address", "network", "asset", "reference", "assetPoolId", "status", "createdAt"
+};
+static const OutputSchema address_schema = { address_columns, 8 };
+
+void output_address(const AddressResponse *address) {
+    output_begin_record(&address_schema);
+    output_string(address->id);
+    output_string(address->address);
+    output_string(address->network);
+    output_string(address->asset);
+    output_string(address->reference);
+    output_string(address->assetPoolId);
+    output_string(address->status);
+    output_string(address->createdAt);
+    output_end_record();
+}
+
+static const char *const transaction_columns[] = {
+    "id", "status", "network", "asset", "reference", "createdAt", "amount"
+};
+static const OutputSchema transaction_schema = { transaction_columns, 7 };
+
+void output_transaction(const Transaction *transaction) {
+    output_begin_record(&transaction_schema);
+    output_string(transaction->id);
+    output_string(transaction->status);
+    output_string(transaction->network);
+    output_string(transaction->asset);
+    output_string(transaction->reference);
+    output_string(transaction->createdAt);
+    output_string(transaction->amount);
+    output_end_record();
+}
+
+// Columns of the selected fields only, rebuilt when the selection changes
+static const char *projected_columns[7];
+static OutputSchema projected_schema = { projected_columns, 0 };
+static unsigned int projected_fields = 0;
+
+void output_transaction_fields(const Transaction *transaction, unsigned int fields) {
+    if (fields == TRANSACTION_FIELDS_ALL) {
+        output_transaction(transaction);
+        return;
+    }
+
+    // Column order and field bits both follow transaction_columns
+    const char *values[7] = {
+        transaction->id, transaction->status, transaction->network, transaction->asset,
+        transaction->reference, transaction->createdAt, transaction->amount
+    };
+    static const unsigned int bits[7] = {
+        TRANSACTION_FIELD_ID, TRANSACTION_FIELD_STATUS, TRANSACTION_FIELD_NETWORK, TRANSACTION_FIELD_ASSET,
+        TRANSACTION_FIELD_REFERENCE, TRANSACTION_FIELD_CREATED_AT, TRANSACTION_FIELD_AMOUNT
+    };
+
+    if (fields != projected_fields) {
+        projected_fields = fields;
+        projected_schema.column_count = 0;
+        for (int i = 0; i < 7; i++) {
+            if (fields & bits[i]) {
+                projected_columns[projected_schema.column_count++] = transaction_columns[i];
+            }
+        }
+        // Same schema, different columns: CSV and TSV need a new header row
+        if (header_schema == &projected_schema) {
+            header_schema = NULL;
+        }
+    }
+
+    output_begin_record(&projected_schema);
+    for (int i = 0; i < 7; i++) {
+        if (fields & bits[i]) {
+            output_string(values[i]);
+        }
+    }
+    output_end_record();
+}
+
+// Same columns as a listed transaction, without the amount the API does not echo
+static const OutputSchema transaction_request_schema = { transaction_columns, 6 };
+
+void output_transaction_request(const TransactionResponse *response) {
+    output_begin_record(&transaction_request_schema);
+    output_string(response->id);
+    output_string(response->status);
+    output_string(response->network);
+    output_string(response->asset);
+    output_string(response->reference);
+    output_string(response->createdAt);
+    output_end_record();
+}
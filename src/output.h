@@ -0,0 +1,49 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "layer1_client.h"
+#include <stdbool.h>
+
+// Machine-readable command output. Records are formatted straight into one
+// large process-wide buffer that goes to stdout in big writes, instead of a
+// printf per field. The text format leaves printing to the commands.
+
+typedef enum {
+    OUTPUT_TEXT,
+    OUTPUT_JSONL,               // One JSON object per line
+    OUTPUT_CSV,                 // RFC 4180, header row per record type
+    OUTPUT_TSV,                 // Tab-separated, \t \n \r \\ escaped, header row per record type
+    OUTPUT_RAW                  // Response bodies as received; other records as JSON lines
+} OutputFormat;
+
+// Column names of one kind of record, in the order fields are written
+typedef struct {
+    const char *const *columns;
+    int column_count;
+} OutputSchema;
+
+// Select the format by name (text, jsonl, csv, tsv, raw)
+bool output_set_format(const char *name);
+OutputFormat output_format(void);
+
+// Write one record: begin, then every column in schema order, then end.
+// CSV and TSV repeat the header row whenever the record type changes.
+void output_begin_record(const OutputSchema *schema);
+void output_string(const char *value);      // NULL becomes null / an empty field
+void output_literal(const char *value);     // Number or boolean, unquoted in JSON
+void output_end_record(void);
+
+// Write out everything buffered; false if stdout could not be written
+bool output_flush(void);
+
+// Write bytes straight to stdout after whatever is buffered, in a single
+// write where the kernel takes it all; false if stdout could not be written
+bool output_raw(const char *data, size_t length);
+
+// Records for the client's response types
+void output_address(const AddressResponse *address);
+void output_transaction(const Transaction *transaction);
+void output_transaction_fields(const Transaction *transaction, unsigned int fields);   // TRANSACTION_FIELD_* columns only
+void output_transaction_request(const TransactionResponse *response);
+
+#endif // OUTPUT_H
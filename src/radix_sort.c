@@ -0,0 +1,71 @@
+#include "radix_sort.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+// Flipping the sign bit orders signed keys as unsigned
+static inline uint64_t sort_key(int64_t key) {
+    return (uint64_t)key ^ (1ull << 63);
+}
+
+static inline unsigned digit(uint64_t key, int pass) {
+    return (unsigned)(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+bool radix_sort(RadixItem *items, size_t count) {
+    if (count < 2) {
+        return true;
+    }
+
+    size_t (*histograms)[RADIX_BUCKETS] = calloc(RADIX_PASSES, sizeof(*histograms));
+    RadixItem *scratch = malloc(count * sizeof(RadixItem));
+    if (!histograms || !scratch) {
+        free(histograms);
+        free(scratch);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = sort_key(items[i].key);
+        for (int pass = 0; pass < RADIX_PASSES; pass++) {
+            histograms[pass][digit(key, pass)]++;
+        }
+    }
+
+    RadixItem *from = items;
+    RadixItem *to = scratch;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        size_t *histogram = histograms[pass];
+
+        // All keys share this byte: the order would not change
+        if (histogram[digit(sort_key(from[0].key), pass)] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            size_t bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            to[histogram[digit(sort_key(from[i].key), pass)]++] = from[i];
+        }
+
+        RadixItem *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != items) {
+        memcpy(items, from, count * sizeof(RadixItem));
+    }
+
+    free(histograms);
+    free(scratch);
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A sort key and the row it belongs to
+typedef struct {
+    int64_t key;
+    uint32_t row;
+} RadixItem;
+
+// Stable sort of items by ascending key: one counting pass over all eight
+// key bytes, then one scatter pass per byte, skipping bytes that are the
+// same in every key (the high bytes of nearby timestamps). False when the
+// scratch buffer cannot be allocated.
+bool radix_sort(RadixItem *items, size_t count);
+
+#endif // RADIX_SORT_H
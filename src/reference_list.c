@@ -0,0 +1,65 @@
+#include "reference_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+bool reference_list_read(const char *path, ReferenceList *list) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open %s\n", path);
+        return false;
+    }
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t length;
+    int capacity = 0;
+    bool ok = true;
+    while (ok && (length = getline(&line, &line_capacity, file)) != -1) {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length == 0) {
+            continue;
+        }
+
+        if (list->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            char **items = realloc(list->items, (size_t)capacity * sizeof(char *));
+            if (!items) {
+                ok = false;
+                break;
+            }
+            list->items = items;
+        }
+
+        list->items[list->count] = strdup(line);
+        ok = list->items[list->count] != NULL;
+        if (ok) {
+            list->count++;
+        }
+    }
+
+    if (ok && ferror(file)) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to read %s\n", path);
+    }
+
+    free(line);
+    if (file != stdin) {
+        fclose(file);
+    }
+    return ok;
+}
+
+void reference_list_free(ReferenceList *list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->items[i]);
+    }
+    free(list->items);
+    list->items = NULL;
+    list->count = 0;
+}
@@ -0,0 +1,18 @@
+#ifndef REFERENCE_LIST_H
+#define REFERENCE_LIST_H
+
+#include <stdbool.h>
+
+typedef struct {
+    char **items;
+    int count;
+} ReferenceList;
+
+// Read one reference per line from path, "-" for stdin, into a zeroed
+// list. Line endings are trimmed and blank lines skipped; lines may be of
+// any length. On failure an error is printed and whatever was read is left
+// in list for reference_list_free.
+bool reference_list_read(const char *path, ReferenceList *list);
+void reference_list_free(ReferenceList *list);
+
+#endif // REFERENCE_LIST_H
@@ -0,0 +1,232 @@
+#include "request_body.h"
+#include "http_signer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <openssl/sha.h>
+
+// Hash in blocks so the digest sees the bytes while they are still in cache
+// without paying a digest call for every small write
+#define DIGEST_BLOCK_SIZE 4096
+#define MAX_NESTING_DEPTH 31
+
+RequestBody *request_body_create(size_t initial_capacity) {
+    RequestBody *body = calloc(1, sizeof(RequestBody));
+    if (!body) {
+        return NULL;
+    }
+
+    if (initial_capacity < 64) {
+        initial_capacity = 64;
+    }
+
+    body->data = malloc(initial_capacity + 1);
+    body->digest_ctx = EVP_MD_CTX_new();
+    if (!body->data || !body->digest_ctx ||
+        EVP_DigestInit_ex(body->digest_ctx, EVP_sha256(), NULL) != 1) {
+        request_body_destroy(body);
+        return NULL;
+    }
+
+    body->capacity = initial_capacity;
+    body->data[0] = '\0';
+    return body;
+}
+
+void request_body_destroy(RequestBody *body) {
+    if (!body) {
+        return;
+    }
+
+    free(body->data);
+    EVP_MD_CTX_free(body->digest_ctx);
+    free(body);
+}
+
+bool request_body_reset(RequestBody *body) {
+    if (!body) {
+        return false;
+    }
+
+    body->length = 0;
+    body->digested = 0;
+    body->depth = 0;
+    body->need_comma = 0;
+    body->data[0] = '\0';
+    // The context keeps its digest, so re-initialising skips the algorithm lookup
+    body->failed = EVP_DigestInit_ex(body->digest_ctx, NULL, NULL) != 1;
+    return !body->failed;
+}
+
+static void digest_pending(RequestBody *body) {
+    if (body->length > body->digested &&
+        EVP_DigestUpdate(body->digest_ctx, body->data + body->digested, body->length - body->digested) != 1) {
+        body->failed = true;
+    }
+    body->digested = body->length;
+}
+
+static bool reserve(RequestBody *body, size_t extra) {
+    if (body->failed) {
+        return false;
+    }
+
+    if (body->length + extra <= body->capacity) {
+        return true;
+    }
+
+    size_t capacity = body->capacity * 2;
+    while (capacity < body->length + extra) {
+        capacity *= 2;
+    }
+
+    char *data = realloc(body->data, capacity + 1);
+    if (!data) {
+        body->failed = true;
+        return false;
+    }
+
+    body->data = data;
+    body->capacity = capacity;
+    return true;
+}
+
+void request_body_append(RequestBody *body, const char *data, size_t length) {
+    if (!body || !reserve(body, length)) {
+        return;
+    }
+
+    memcpy(body->data + body->length, data, length);
+    body->length += length;
+    body->data[body->length] = '\0';
+
+    if (body->length - body->digested >= DIGEST_BLOCK_SIZE) {
+        digest_pending(body);
+    }
+}
+
+static void append_char(RequestBody *body, char c) {
+    request_body_append(body, &c, 1);
+}
+
+// Escape exactly like cJSON's print_string_ptr so bodies stay byte-identical
+void request_body_append_string(RequestBody *body, const char *value) {
+    if (!body || !value) {
+        return;
+    }
+
+    append_char(body, '"');
+
+    const char *run = value;
+    for (const char *p = value; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 32 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        request_body_append(body, run, (size_t)(p - run));
+        run = p + 1;
+
+        char escaped[8];
+        switch (c) {
+            case '"':  request_body_append(body, "\\\"", 2); break;
+            case '\\': request_body_append(body, "\\\\", 2); break;
+            case '\b': request_body_append(body, "\\b", 2); break;
+            case '\f': request_body_append(body, "\\f", 2); break;
+            case '\n': request_body_append(body, "\\n", 2); break;
+            case '\r': request_body_append(body, "\\r", 2); break;
+            case '\t': request_body_append(body, "\\t", 2); break;
+            default:
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                request_body_append(body, escaped, 6);
+                break;
+        }
+    }
+
+    request_body_append(body, run, strlen(run));
+    append_char(body, '"');
+}
+
+// Write the separator and key that precede a value at the current level
+static void begin_value(RequestBody *body, const char *key) {
+    unsigned int level_bit = 1u << body->depth;
+    if (body->need_comma & level_bit) {
+        append_char(body, ',');
+    }
+    body->need_comma |= level_bit;
+
+    if (key) {
+        request_body_append_string(body, key);
+        append_char(body, ':');
+    }
+}
+
+static void open_container(RequestBody *body, const char *key, char open) {
+    if (!body) {
+        return;
+    }
+
+    if (body->depth >= MAX_NESTING_DEPTH) {
+        body->failed = true;
+        return;
+    }
+
+    begin_value(body, key);
+    append_char(body, open);
+    body->depth++;
+    body->need_comma &= ~(1u << body->depth);
+}
+
+static void close_container(RequestBody *body, char close) {
+    if (!body || body->depth == 0) {
+        return;
+    }
+
+    body->depth--;
+    append_char(body, close);
+}
+
+void request_body_begin_object(RequestBody *body, const char *key) {
+    open_container(body, key, '{');
+}
+
+void request_body_end_object(RequestBody *body) {
+    close_container(body, '}');
+}
+
+void request_body_begin_array(RequestBody *body, const char *key) {
+    open_container(body, key, '[');
+}
+
+void request_body_end_array(RequestBody *body) {
+    close_container(body, ']');
+}
+
+void request_body_add_string(RequestBody *body, const char *key, const char *value) {
+    if (!body || !value) {
+        return;
+    }
+
+    begin_value(body, key);
+    request_body_append_string(body, value);
+}
+
+char *request_body_finish_digest(RequestBody *body) {
+    if (!body) {
+        return NULL;
+    }
+
+    digest_pending(body);
+    if (body->failed) {
+        return NULL;
+    }
+
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    unsigned int hash_len = sizeof(hash);
+    if (EVP_DigestFinal_ex(body->digest_ctx, hash, &hash_len) != 1) {
+        body->failed = true;
+        return NULL;
+    }
+
+    return format_digest("sha-256", hash, hash_len);
+}
@@ -0,0 +1,53 @@
+#include "request_encoder.h"
+
+#define append_literal(body, literal) request_body_append((body), (literal), sizeof(literal) - 1)
+
+// Append a field whose key (with its leading comma) is a pre-escaped literal
+#define append_field(body, key_literal, value) \
+    do { \
+        if (value) { \
+            append_literal((body), key_literal); \
+            request_body_append_string((body), (value)); \
+        } \
+    } while (0)
+
+bool encode_address_request(RequestBody *body, const char *asset_pool_id, const char *network,
+                            const char *asset, const char *reference) {
+    if (!asset_pool_id || !request_body_reset(body)) {
+        return false;
+    }
+
+    append_literal(body, "{\"assetPoolId\":");
+    request_body_append_string(body, asset_pool_id);
+    append_field(body, ",\"network\":", network);
+    append_field(body, ",\"asset\":", asset);
+    append_field(body, ",\"reference\":", reference);
+    append_literal(body, "}");
+
+    return !body->failed;
+}
+
+bool encode_transaction_request(RequestBody *body, const char *asset_pool_id, const char *network,
+                                const char *asset, const char *to_address, const char *amount,
+                                const char *reference) {
+    if (!asset_pool_id || !to_address || !amount || !request_body_reset(body)) {
+        return false;
+    }
+
+    append_literal(body, "{\"assetPoolId\":");
+    request_body_append_string(body, asset_pool_id);
+    append_field(body, ",\"network\":", network);
+    append_field(body, ",\"asset\":", asset);
+
+    // A single destination
+    append_literal(body, ",\"destinations\":[{\"address\":");
+    request_body_append_string(body, to_address);
+    append_literal(body, ",\"amount\":");
+    request_body_append_string(body, amount);
+    append_literal(body, "}]");
+
+    append_field(body, ",\"reference\":", reference);
+    append_literal(body, "}");
+
+    return !body->failed;
+}
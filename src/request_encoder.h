@@ -0,0 +1,20 @@
+#ifndef REQUEST_ENCODER_H
+#define REQUEST_ENCODER_H
+
+#include "request_body.h"
+#include <stdbool.h>
+
+// Typed writers for the Layer1 request bodies. Each one resets the body and
+// writes the JSON in a single pass with pre-escaped keys, producing the same
+// bytes cJSON_PrintUnformatted did. NULL optional fields are left out.
+
+// {"assetPoolId","network"?,"asset"?,"reference"}
+bool encode_address_request(RequestBody *body, const char *asset_pool_id, const char *network,
+                            const char *asset, const char *reference);
+
+// {"assetPoolId","network","asset","destinations":[{"address","amount"}],"reference"?}
+bool encode_transaction_request(RequestBody *body, const char *asset_pool_id, const char *network,
+                                const char *asset, const char *to_address, const char *amount,
+                                const char *reference);
+
+#endif // REQUEST_ENCODER_H
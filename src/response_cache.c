@@ -0,0 +1,297 @@
+#include "response_cache.h"
+#include "string_hash.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define MAX_SHARDS 16
+#define MIN_SHARD_ENTRIES 8     // Below this, sharding costs more hit rate than it saves in contention
+
+typedef struct CacheEntry {
+    char *key;
+    uint64_t hash;
+    void *value;
+    CacheRelease release;
+    uint64_t expires_ns;
+    struct CacheEntry *bucket_next;
+    struct CacheEntry *lru_prev;    // Towards the most recently used end
+    struct CacheEntry *lru_next;
+} CacheEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    CacheEntry **buckets;
+    size_t bucket_mask;
+    CacheEntry *most_recent;
+    CacheEntry *least_recent;
+    size_t count;
+    size_t capacity;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t expirations;
+} CacheShard;
+
+struct ResponseCache {
+    CacheShard shards[MAX_SHARDS];
+    size_t shard_count;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+ResponseCache *response_cache_create(size_t max_entries) {
+    if (max_entries == 0) {
+        return NULL;
+    }
+
+    ResponseCache *cache = calloc(1, sizeof(ResponseCache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->shard_count = 1;
+    while (cache->shard_count < MAX_SHARDS && cache->shard_count * 2 * MIN_SHARD_ENTRIES <= max_entries) {
+        cache->shard_count *= 2;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        shard->capacity = (max_entries + cache->shard_count - 1) / cache->shard_count;
+
+        size_t buckets = 1;
+        while (buckets < shard->capacity * 2) {
+            buckets *= 2;
+        }
+        shard->bucket_mask = buckets - 1;
+        shard->buckets = calloc(buckets, sizeof(CacheEntry *));
+        pthread_mutex_init(&shard->lock, NULL);
+        if (!shard->buckets) {
+            cache->shard_count = i + 1;
+            response_cache_destroy(cache);
+            return NULL;
+        }
+    }
+
+    return cache;
+}
+
+static void free_entry(CacheEntry *entry) {
+    entry->release(entry->value);
+    free(entry->key);
+    free(entry);
+}
+
+void response_cache_destroy(ResponseCache *cache) {
+    if (!cache) {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        CacheEntry *entry = shard->most_recent;
+        while (entry) {
+            CacheEntry *next = entry->lru_next;
+            free_entry(entry);
+            entry = next;
+        }
+        free(shard->buckets);
+        pthread_mutex_destroy(&shard->lock);
+    }
+
+    free(cache);
+}
+
+// The low hash bits pick the bucket and the high bits the shard
+static CacheShard *shard_for(ResponseCache *cache, uint64_t hash) {
+    return &cache->shards[(hash >> 60) & (cache->shard_count - 1)];
+}
+
+static CacheEntry *find_entry(CacheShard *shard, const char *key, uint64_t hash) {
+    for (CacheEntry *entry = shard->buckets[hash & shard->bucket_mask]; entry; entry = entry->bucket_next) {
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void lru_unlink(CacheShard *shard, CacheEntry *entry) {
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        shard->most_recent = entry->lru_next;
+    }
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        shard->least_recent = entry->lru_prev;
+    }
+}
+
+static void lru_push_front(CacheShard *shard, CacheEntry *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = shard->most_recent;
+    if (shard->most_recent) {
+        shard->most_recent->lru_prev = entry;
+    } else {
+        shard->least_recent = entry;
+    }
+    shard->most_recent = entry;
+}
+
+// Take entry out of the shard; the caller frees it once the lock is dropped
+static void detach_entry(CacheShard *shard, CacheEntry *entry) {
+    CacheEntry **link = &shard->buckets[entry->hash & shard->bucket_mask];
+    while (*link != entry) {
+        link = &(*link)->bucket_next;
+    }
+    *link = entry->bucket_next;
+
+    lru_unlink(shard, entry);
+    shard->count--;
+}
+
+void *response_cache_get(ResponseCache *cache, const char *key, CacheRetain retain) {
+    uint64_t hash = string_hash(key);
+    CacheShard *shard = shard_for(cache, hash);
+    void *value = NULL;
+    CacheEntry *expired = NULL;
+
+    pthread_mutex_lock(&shard->lock);
+    CacheEntry *entry = find_entry(shard, key, hash);
+    if (entry && entry->expires_ns <= monotonic_ns()) {
+        detach_entry(shard, entry);
+        shard->expirations++;
+        expired = entry;
+        entry = NULL;
+    }
+
+    if (entry) {
+        lru_unlink(shard, entry);
+        lru_push_front(shard, entry);
+        retain(entry->value);
+        value = entry->value;
+        shard->hits++;
+    } else {
+        shard->misses++;
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (expired) {
+        free_entry(expired);
+    }
+    return value;
+}
+
+bool response_cache_put(ResponseCache *cache, const char *key, void *value, uint64_t ttl_ms,
+                        CacheRelease release) {
+    CacheEntry *entry = malloc(sizeof(CacheEntry));
+    char *key_copy = entry ? strdup(key) : NULL;
+    if (!key_copy) {
+        free(entry);
+        release(value);
+        return false;
+    }
+
+    entry->key = key_copy;
+    entry->hash = string_hash(key);
+    entry->value = value;
+    entry->release = release;
+    entry->expires_ns = monotonic_ns() + ttl_ms * 1000000ull;
+
+    CacheShard *shard = shard_for(cache, entry->hash);
+    CacheEntry *dropped = NULL;
+
+    pthread_mutex_lock(&shard->lock);
+    CacheEntry *previous = find_entry(shard, key, entry->hash);
+    if (previous) {
+        detach_entry(shard, previous);
+        previous->lru_next = dropped;
+        dropped = previous;
+    } else if (shard->count >= shard->capacity) {
+        CacheEntry *victim = shard->least_recent;
+        detach_entry(shard, victim);
+        victim->lru_next = dropped;
+        dropped = victim;
+        shard->evictions++;
+    }
+
+    CacheEntry **bucket = &shard->buckets[entry->hash & shard->bucket_mask];
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+    lru_push_front(shard, entry);
+    shard->count++;
+    pthread_mutex_unlock(&shard->lock);
+
+    // Releasing a response frees all of its records, so keep that out of the lock
+    while (dropped) {
+        CacheEntry *next = dropped->lru_next;
+        free_entry(dropped);
+        dropped = next;
+    }
+    return true;
+}
+
+void response_cache_remove(ResponseCache *cache, const char *key) {
+    uint64_t hash = string_hash(key);
+    CacheShard *shard = shard_for(cache, hash);
+
+    pthread_mutex_lock(&shard->lock);
+    CacheEntry *entry = find_entry(shard, key, hash);
+    if (entry) {
+        detach_entry(shard, entry);
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (entry) {
+        free_entry(entry);
+    }
+}
+
+void response_cache_remove_prefix(ResponseCache *cache, const char *prefix) {
+    size_t length = strlen(prefix);
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        CacheEntry *dropped = NULL;
+
+        pthread_mutex_lock(&shard->lock);
+        CacheEntry *entry = shard->most_recent;
+        while (entry) {
+            CacheEntry *next = entry->lru_next;
+            if (strncmp(entry->key, prefix, length) == 0) {
+                detach_entry(shard, entry);
+                entry->lru_next = dropped;
+                dropped = entry;
+            }
+            entry = next;
+        }
+        pthread_mutex_unlock(&shard->lock);
+
+        while (dropped) {
+            CacheEntry *next = dropped->lru_next;
+            free_entry(dropped);
+            dropped = next;
+        }
+    }
+}
+
+void response_cache_get_stats(ResponseCache *cache, ResponseCacheStats *stats) {
+    memset(stats, 0, sizeof(ResponseCacheStats));
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        CacheShard *shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        stats->expirations += shard->expirations;
+        stats->entries += shard->count;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
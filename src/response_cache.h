@@ -0,0 +1,50 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded LRU cache of reference-counted responses, keyed by request URL.
+// Keys are spread over independently locked shards, each with its own hash
+// table and LRU list, so threads looking up different keys rarely contend.
+
+// Take one more reference to a cached value for the caller
+typedef void (*CacheRetain)(void *value);
+
+// Drop the cache's reference to a value
+typedef void (*CacheRelease)(void *value);
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;         // Dropped to stay within max_entries
+    uint64_t expirations;       // Dropped because their TTL had passed
+    size_t entries;
+} ResponseCacheStats;
+
+typedef struct ResponseCache ResponseCache;
+
+ResponseCache *response_cache_create(size_t max_entries);
+
+// Release every cached value
+void response_cache_destroy(ResponseCache *cache);
+
+// Return the live value for key with a reference retained for the caller,
+// or NULL on a miss
+void *response_cache_get(ResponseCache *cache, const char *key, CacheRetain retain);
+
+// Store value under key for ttl_ms, replacing any previous value. The cache
+// takes over one reference, which is released with release on removal.
+bool response_cache_put(ResponseCache *cache, const char *key, void *value, uint64_t ttl_ms,
+                        CacheRelease release);
+
+void response_cache_remove(ResponseCache *cache, const char *key);
+
+// Remove every entry whose key starts with prefix. Walks all shards, so it
+// is meant for invalidation, not for the request path.
+void response_cache_remove_prefix(ResponseCache *cache, const char *prefix);
+
+void response_cache_get_stats(ResponseCache *cache, ResponseCacheStats *stats);
+
+#endif // RESPONSE_CACHE_H
@@ -0,0 +1,497 @@
+#include "response_decoder.h"
+#include "transaction_table.h"
+#include "timestamp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+struct FieldSpec {
+    const char *name;
+    size_t length;
+    size_t offset;
+    unsigned int bit;           // Selects the field in the decoder's field mask
+};
+
+#define FIELD(name, type, member, bit) { name, sizeof(name) - 1, offsetof(type, member), bit }
+#define FIELD_COUNT(fields) (sizeof(fields) / sizeof((fields)[0]))
+
+static const FieldSpec address_fields[] = {
+    FIELD("id", AddressResponse, id, ADDRESS_FIELD_ID),
+    FIELD("address", AddressResponse, address, ADDRESS_FIELD_ADDRESS),
+    FIELD("network", AddressResponse, network, ADDRESS_FIELD_NETWORK),
+    FIELD("asset", AddressResponse, asset, ADDRESS_FIELD_ASSET),
+    FIELD("reference", AddressResponse, reference, ADDRESS_FIELD_REFERENCE),
+    FIELD("assetPoolId", AddressResponse, assetPoolId, ADDRESS_FIELD_ASSET_POOL_ID),
+    FIELD("status", AddressResponse, status, ADDRESS_FIELD_STATUS),
+    FIELD("createdAt", AddressResponse, createdAt, ADDRESS_FIELD_CREATED_AT)
+};
+
+static const FieldSpec transaction_fields[] = {
+    FIELD("id", Transaction, id, TRANSACTION_FIELD_ID),
+    FIELD("status", Transaction, status, TRANSACTION_FIELD_STATUS),
+    FIELD("asset", Transaction, asset, TRANSACTION_FIELD_ASSET),
+    FIELD("createdAt", Transaction, createdAt, TRANSACTION_FIELD_CREATED_AT),
+    FIELD("amount", Transaction, amount, TRANSACTION_FIELD_AMOUNT)
+};
+
+// Fields of the "address" object nested in each transaction
+static const FieldSpec transaction_address_fields[] = {
+    FIELD("reference", Transaction, reference, TRANSACTION_FIELD_REFERENCE),
+    FIELD("network", Transaction, network, TRANSACTION_FIELD_NETWORK)
+};
+
+static const FieldSpec transaction_request_fields[] = {
+    FIELD("requestId", TransactionResponse, id, ~0u),
+    FIELD("status", TransactionResponse, status, ~0u),
+    FIELD("network", TransactionResponse, network, ~0u),
+    FIELD("asset", TransactionResponse, asset, ~0u),
+    FIELD("reference", TransactionResponse, reference, ~0u),
+    FIELD("createdAt", TransactionResponse, createdAt, ~0u)
+};
+
+enum {
+    ROOT_KEY_OTHER,
+    ROOT_KEY_CONTENT,
+    ROOT_KEY_PAGE_NUMBER,
+    ROOT_KEY_PAGE_SIZE,
+    ROOT_KEY_TOTAL_ELEMENTS
+};
+
+// Compare by length first, then by the first byte, and only then in full;
+// the API's keys are case-sensitive camelCase
+#define KEY_IS(key, key_len, literal) \
+    ((key_len) == sizeof(literal) - 1 && (key)[0] == (literal)[0] && \
+     memcmp((key), (literal), sizeof(literal) - 1) == 0)
+
+// Fields left out of the mask never match, so their values are skipped unallocated
+static const FieldSpec *match_field(const FieldSpec *fields, size_t count, unsigned int mask,
+                                    const char *key, size_t length) {
+    for (size_t i = 0; i < count; i++) {
+        if (fields[i].length == length && fields[i].name[0] == key[0] &&
+            memcmp(fields[i].name, key, length) == 0) {
+            return fields[i].bit & mask ? &fields[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+static const FieldSpec *record_fields(RecordKind kind, size_t *count) {
+    switch (kind) {
+        case RECORD_TRANSACTION:
+            *count = FIELD_COUNT(transaction_fields);
+            return transaction_fields;
+        case RECORD_TRANSACTION_REQUEST:
+            *count = FIELD_COUNT(transaction_request_fields);
+            return transaction_request_fields;
+        case RECORD_ADDRESS:
+        default:
+            *count = FIELD_COUNT(address_fields);
+            return address_fields;
+    }
+}
+
+static char **field_slot(ResponseDecoder *decoder, const FieldSpec *field) {
+    return (char **)((char *)&decoder->record + field->offset);
+}
+
+static void clear_record(ResponseDecoder *decoder) {
+    size_t count;
+    const FieldSpec *fields = record_fields(decoder->kind, &count);
+    for (size_t i = 0; i < count; i++) {
+        free(*field_slot(decoder, &fields[i]));
+    }
+
+    if (decoder->kind == RECORD_TRANSACTION) {
+        for (size_t i = 0; i < FIELD_COUNT(transaction_address_fields); i++) {
+            free(*field_slot(decoder, &transaction_address_fields[i]));
+        }
+    }
+
+    memset(&decoder->record, 0, sizeof(decoder->record));
+}
+
+static bool store_string(ResponseDecoder *decoder, const char *value, size_t length) {
+    char **slot = field_slot(decoder, decoder->field);
+
+    // The first occurrence of a key wins
+    if (*slot) {
+        return true;
+    }
+
+    *slot = malloc(length + 1);
+    if (!*slot) {
+        return false;
+    }
+    memcpy(*slot, value, length);
+    (*slot)[length] = '\0';
+
+    // Timestamps are parsed once here, so sorting and filtering compare integers
+    if (decoder->kind == RECORD_TRANSACTION && decoder->field->bit == TRANSACTION_FIELD_CREATED_AT &&
+        !timestamp_parse_ms(value, length, &decoder->record.transaction.createdAtMs)) {
+        decoder->record.transaction.createdAtMs = LAYER1_TIME_NONE;
+    }
+    return true;
+}
+
+static long parse_long(const char *value, size_t length) {
+    char number[64];
+    if (length >= sizeof(number)) {
+        return 0;
+    }
+    memcpy(number, value, length);
+    number[length] = '\0';
+    return (long)strtod(number, NULL);
+}
+
+static void on_key(ResponseDecoder *decoder, const char *key, size_t length) {
+    decoder->field = NULL;
+    decoder->pending_nested = false;
+    decoder->field_depth = decoder->depth;
+
+    if (length == 0) {
+        return;
+    }
+
+    if (decoder->in_record && decoder->depth == decoder->record_depth) {
+        size_t count;
+        const FieldSpec *fields = record_fields(decoder->kind, &count);
+        decoder->field = match_field(fields, count, decoder->fields, key, length);
+        decoder->pending_nested = decoder->kind == RECORD_TRANSACTION &&
+                                  (decoder->fields & (TRANSACTION_FIELD_REFERENCE | TRANSACTION_FIELD_NETWORK)) &&
+                                  KEY_IS(key, length, "address");
+    } else if (decoder->in_nested && decoder->depth == decoder->record_depth + 1) {
+        decoder->field = match_field(transaction_address_fields, FIELD_COUNT(transaction_address_fields),
+                                     decoder->fields, key, length);
+    } else if (decoder->paged && decoder->depth == 1) {
+        if (KEY_IS(key, length, "content")) decoder->root_key = ROOT_KEY_CONTENT;
+        else if (KEY_IS(key, length, "pageNumber")) decoder->root_key = ROOT_KEY_PAGE_NUMBER;
+        else if (KEY_IS(key, length, "pageSize")) decoder->root_key = ROOT_KEY_PAGE_SIZE;
+        else if (KEY_IS(key, length, "totalElements")) decoder->root_key = ROOT_KEY_TOTAL_ELEMENTS;
+        else decoder->root_key = ROOT_KEY_OTHER;
+    }
+}
+
+static void on_number(ResponseDecoder *decoder, const char *value, size_t length) {
+    if (!decoder->paged || decoder->depth != 1) {
+        return;
+    }
+
+    switch (decoder->root_key) {
+        case ROOT_KEY_PAGE_NUMBER:
+            decoder->page_number = (int)parse_long(value, length);
+            break;
+        case ROOT_KEY_PAGE_SIZE:
+            decoder->page_size = (int)parse_long(value, length);
+            break;
+        case ROOT_KEY_TOTAL_ELEMENTS:
+            decoder->total_elements = parse_long(value, length);
+            break;
+        default:
+            break;
+    }
+}
+
+static bool on_event(void *user_data, JsonEventType type, const char *value, size_t length) {
+    ResponseDecoder *decoder = (ResponseDecoder *)user_data;
+
+    switch (type) {
+        case JSON_EVENT_OBJECT_START:
+            decoder->depth++;
+            if (decoder->depth == decoder->record_depth && (!decoder->paged || decoder->in_content)) {
+                decoder->in_record = true;
+                if (decoder->kind == RECORD_TRANSACTION) {
+                    decoder->record.transaction.createdAtMs = LAYER1_TIME_NONE;
+                }
+            } else if (decoder->in_record && decoder->pending_nested &&
+                       decoder->depth == decoder->record_depth + 1) {
+                decoder->in_nested = true;
+            }
+            decoder->field = NULL;
+            decoder->pending_nested = false;
+            return true;
+
+        case JSON_EVENT_ARRAY_START:
+            decoder->depth++;
+            if (decoder->paged && decoder->depth == 2 && decoder->root_key == ROOT_KEY_CONTENT &&
+                !decoder->has_content) {
+                decoder->in_content = true;
+                decoder->has_content = true;
+            }
+            decoder->field = NULL;
+            decoder->pending_nested = false;
+            return true;
+
+        case JSON_EVENT_OBJECT_END:
+            if (decoder->in_nested && decoder->depth == decoder->record_depth + 1) {
+                decoder->in_nested = false;
+            } else if (decoder->in_record && decoder->depth == decoder->record_depth) {
+                decoder->in_record = false;
+                decoder->record_count++;
+                if (decoder->table) {
+                    if (!transaction_table_end_row(decoder->table)) {
+                        return false;
+                    }
+                    decoder->depth--;
+                    return true;
+                }
+                bool keep_going = decoder->handler(&decoder->record, decoder->user_data);
+
+                // The handler owns the strings now, even when it aborts
+                memset(&decoder->record, 0, sizeof(decoder->record));
+                if (!keep_going) {
+                    return false;
+                }
+            }
+            decoder->depth--;
+            return true;
+
+        case JSON_EVENT_ARRAY_END:
+            if (decoder->in_content && decoder->depth == 2) {
+                decoder->in_content = false;
+            }
+            decoder->depth--;
+            return true;
+
+        case JSON_EVENT_KEY:
+            on_key(decoder, value, length);
+            return true;
+
+        case JSON_EVENT_STRING: {
+            bool ok = true;
+            if (decoder->field && decoder->depth == decoder->field_depth) {
+                ok = decoder->table
+                    ? transaction_table_store(decoder->table, decoder->field->bit, value, length)
+                    : store_string(decoder, value, length);
+            }
+            decoder->field = NULL;
+            return ok;
+        }
+
+        case JSON_EVENT_NUMBER:
+            on_number(decoder, value, length);
+            decoder->field = NULL;
+            return true;
+
+        default:
+            decoder->field = NULL;
+            return true;
+    }
+}
+
+void response_decoder_init(ResponseDecoder *decoder, RecordKind kind, bool paged,
+                           RecordHandler handler, void *user_data) {
+    memset(decoder, 0, sizeof(ResponseDecoder));
+    decoder->kind = kind;
+    decoder->paged = paged;
+    // root object (1) > content array (2) > record (3)
+    decoder->record_depth = paged ? 3 : 1;
+    decoder->handler = handler;
+    decoder->user_data = user_data;
+    decoder->fields = ~0u;
+    json_stream_init(&decoder->stream, on_event, decoder);
+}
+
+void response_decoder_select_fields(ResponseDecoder *decoder, unsigned int fields) {
+    decoder->fields = fields;
+}
+
+void response_decoder_collect_table(ResponseDecoder *decoder, TransactionTable *table) {
+    decoder->table = table;
+}
+
+void response_decoder_free(ResponseDecoder *decoder) {
+    if (!decoder) {
+        return;
+    }
+
+    clear_record(decoder);
+    json_stream_free(&decoder->stream);
+}
+
+bool response_decoder_feed(ResponseDecoder *decoder, const char *data, size_t length) {
+    decoder->bytes_fed += length;
+    return json_stream_feed(&decoder->stream, data, length);
+}
+
+bool response_decoder_finish(ResponseDecoder *decoder) {
+    if (!json_stream_finish(&decoder->stream)) {
+        return false;
+    }
+    return decoder->paged ? decoder->has_content : decoder->record_count == 1;
+}
+
+size_t response_decoder_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    ResponseDecoder *decoder = (ResponseDecoder *)userp;
+
+    // Returning less than realsize makes curl abort the transfer
+    if (!response_decoder_feed(decoder, (const char *)contents, realsize)) {
+        return 0;
+    }
+    return realsize;
+}
+
+static bool take_address(void *record, void *user_data) {
+    AddressResponse **target = (AddressResponse **)user_data;
+    if (*target) {
+        return false;
+    }
+
+    *target = malloc(sizeof(AddressResponse));
+    if (!*target) {
+        return false;
+    }
+    memcpy(*target, record, sizeof(AddressResponse));
+    return true;
+}
+
+static bool take_transaction_request(void *record, void *user_data) {
+    TransactionResponse **target = (TransactionResponse **)user_data;
+    if (*target) {
+        return false;
+    }
+
+    *target = malloc(sizeof(TransactionResponse));
+    if (!*target) {
+        return false;
+    }
+    memcpy(*target, record, sizeof(TransactionResponse));
+    return true;
+}
+
+AddressResponse *decode_address_response(const char *json, size_t length) {
+    if (!json) {
+        return NULL;
+    }
+
+    AddressResponse *response = NULL;
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_ADDRESS, false, take_address, &response);
+    bool ok = response_decoder_feed(&decoder, json, length) && response_decoder_finish(&decoder);
+    response_decoder_free(&decoder);
+
+    if (!ok) {
+        layer1_free_address_response(response);
+        return NULL;
+    }
+
+    return response;
+}
+
+TransactionResponse *decode_transaction_response(const char *json, size_t length) {
+    if (!json) {
+        return NULL;
+    }
+
+    TransactionResponse *response = NULL;
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_TRANSACTION_REQUEST, false, take_transaction_request, &response);
+    bool ok = response_decoder_feed(&decoder, json, length) && response_decoder_finish(&decoder);
+    response_decoder_free(&decoder);
+
+    if (!ok) {
+        layer1_free_transaction_response(response);
+        return NULL;
+    }
+
+    return response;
+}
+
+#define ADDRESS_LIST_FIRST_CAPACITY 8
+#define TRANSACTION_LIST_FIRST_CAPACITY 16
+
+// Lists start with room for first_capacity records, a power of two, and
+// double each time they fill up, so the capacity follows from the count
+static bool needs_growth(int count, int first_capacity) {
+    return count == 0 || (count >= first_capacity && (count & (count - 1)) == 0);
+}
+
+bool collect_address_record(void *record, void *user_data) {
+    AddressListResponse *list = (AddressListResponse *)user_data;
+
+    // The record's strings are ours to free, even when it cannot be kept
+    if (needs_growth(list->contentCount, ADDRESS_LIST_FIRST_CAPACITY)) {
+        size_t capacity = list->contentCount ? (size_t)list->contentCount * 2 : ADDRESS_LIST_FIRST_CAPACITY;
+        AddressResponse **content = realloc(list->content, sizeof(AddressResponse *) * capacity);
+        if (!content) {
+            layer1_free_address_fields((AddressResponse *)record);
+            return false;
+        }
+        list->content = content;
+    }
+
+    AddressResponse *address = malloc(sizeof(AddressResponse));
+    if (!address) {
+        layer1_free_address_fields((AddressResponse *)record);
+        return false;
+    }
+    memcpy(address, record, sizeof(AddressResponse));
+    list->content[list->contentCount++] = address;
+    return true;
+}
+
+bool collect_transaction_record(void *record, void *user_data) {
+    TransactionListResponse *list = (TransactionListResponse *)user_data;
+
+    if (needs_growth(list->count, TRANSACTION_LIST_FIRST_CAPACITY)) {
+        size_t capacity = list->count ? (size_t)list->count * 2 : TRANSACTION_LIST_FIRST_CAPACITY;
+        Transaction *transactions = realloc(list->transactions, sizeof(Transaction) * capacity);
+        if (!transactions) {
+            layer1_free_transaction_fields((Transaction *)record);
+            return false;
+        }
+        list->transactions = transactions;
+    }
+
+    memcpy(&list->transactions[list->count++], record, sizeof(Transaction));
+    return true;
+}
+
+AddressListResponse *decode_address_list_response(const char *json, size_t length) {
+    if (!json) {
+        return NULL;
+    }
+
+    AddressListResponse *response = calloc(1, sizeof(AddressListResponse));
+    if (!response) {
+        return NULL;
+    }
+
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_ADDRESS, true, collect_address_record, response);
+    bool ok = response_decoder_feed(&decoder, json, length) && json_stream_finish(&decoder.stream);
+    response->pageNumber = decoder.page_number;
+    response->pageSize = decoder.page_size;
+    response->totalElements = decoder.total_elements;
+    response_decoder_free(&decoder);
+
+    if (!ok) {
+        layer1_free_address_list_response(response);
+        return NULL;
+    }
+
+    return response;
+}
+
+TransactionListResponse *decode_transaction_list_response(const char *json, size_t length) {
+    if (!json) {
+        return NULL;
+    }
+
+    TransactionListResponse *response = calloc(1, sizeof(TransactionListResponse));
+    if (!response) {
+        return NULL;
+    }
+
+    ResponseDecoder decoder;
+    response_decoder_init(&decoder, RECORD_TRANSACTION, true, collect_transaction_record, response);
+    bool ok = response_decoder_feed(&decoder, json, length) && response_decoder_finish(&decoder);
+    response_decoder_free(&decoder);
+
+    if (!ok) {
+        layer1_free_transaction_list_response(response);
+        return NULL;
+    }
+
+    return response;
+}
@@ -0,0 +1,87 @@
+#ifndef RESPONSE_DECODER_H
+#define RESPONSE_DECODER_H
+
+#include "layer1_client.h"
+#include "json_stream.h"
+#include <stddef.h>
+
+// Decoders specialized for the Layer1 response shapes. They sit on top of
+// the incremental tokenizer, so a body can be fed as curl delivers it. Keys
+// are matched against a fixed field table, strings go straight into the
+// client structs and unknown subtrees are skipped without building nodes.
+
+typedef enum {
+    RECORD_ADDRESS,             // AddressResponse
+    RECORD_TRANSACTION,         // Transaction from a transaction page
+    RECORD_TRANSACTION_REQUEST  // TransactionResponse from create-transaction
+} RecordKind;
+
+typedef struct FieldSpec FieldSpec;
+
+// Receives each record as soon as its closing brace has been decoded. The
+// handler takes ownership of the strings in the record. Return false to abort.
+typedef bool (*RecordHandler)(void *record, void *user_data);
+
+typedef struct {
+    JsonStream stream;
+    RecordKind kind;
+    bool paged;                 // Records are the elements of the top-level "content" array
+    int record_depth;
+    RecordHandler handler;
+    void *user_data;
+    unsigned int fields;        // ADDRESS_FIELD_* / TRANSACTION_FIELD_* bits to decode
+    TransactionTable *table;    // Transaction strings go here instead of to the handler
+
+    int depth;
+    const FieldSpec *field;     // Field the next scalar at field_depth belongs to
+    int field_depth;
+    int root_key;
+    bool pending_nested;
+    bool in_nested;
+    bool in_content;
+    bool has_content;
+    bool in_record;
+    int record_count;
+    size_t bytes_fed;           // Decoded body bytes, after any decompression
+
+    union {
+        AddressResponse address;
+        Transaction transaction;
+        TransactionResponse request;
+    } record;
+
+    // Page metadata, only filled for paged responses
+    int page_number;
+    int page_size;
+    long total_elements;
+} ResponseDecoder;
+
+void response_decoder_init(ResponseDecoder *decoder, RecordKind kind, bool paged,
+                           RecordHandler handler, void *user_data);
+void response_decoder_free(ResponseDecoder *decoder);
+
+// Decode only the record fields in mask; all of them by default
+void response_decoder_select_fields(ResponseDecoder *decoder, unsigned int fields);
+
+// Append transaction records to table, copying their strings into its arena
+// rather than allocating them one by one. The handler is not called.
+void response_decoder_collect_table(ResponseDecoder *decoder, TransactionTable *table);
+bool response_decoder_feed(ResponseDecoder *decoder, const char *data, size_t length);
+
+// True when the body was complete, well-formed and had the expected shape
+bool response_decoder_finish(ResponseDecoder *decoder);
+
+// CURLOPT_WRITEFUNCTION that feeds a ResponseDecoder passed as CURLOPT_WRITEDATA
+size_t response_decoder_write_callback(void *contents, size_t size, size_t nmemb, void *userp);
+
+// Record handlers appending to an AddressListResponse / TransactionListResponse
+bool collect_address_record(void *record, void *user_data);
+bool collect_transaction_record(void *record, void *user_data);
+
+// Decode a complete body, NULL on malformed JSON
+AddressResponse *decode_address_response(const char *json, size_t length);
+AddressListResponse *decode_address_list_response(const char *json, size_t length);
+TransactionResponse *decode_transaction_response(const char *json, size_t length);
+TransactionListResponse *decode_transaction_list_response(const char *json, size_t length);
+
+#endif // RESPONSE_DECODER_H
@@ -0,0 +1,281 @@
+#include "signing_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Intrusive multi-producer single-consumer queue (Vyukov). Producers only
+// ever touch head, the owning worker only ever touches tail.
+typedef struct {
+    _Atomic(SigningJob *) head;
+    SigningJob *tail;
+    SigningJob stub;
+} JobQueue;
+
+typedef struct {
+    SigningPool *pool;
+    pthread_t thread;
+    HttpSigner *signer;
+    EVP_MD_CTX *md_ctx;
+    JobQueue queue;
+    atomic_size_t pending;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool started;
+} SigningWorker;
+
+struct SigningPool {
+    SigningWorker *workers;
+    int worker_count;
+    int initialized_count;          // Workers whose lock and condvar exist
+    atomic_uint next_worker;
+    atomic_bool stopping;
+    atomic_uint_fast64_t jobs_signed;
+    atomic_uint_fast64_t jobs_failed;
+    atomic_uint_fast64_t total_wait_ns;
+    atomic_uint_fast64_t max_wait_ns;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void job_queue_init(JobQueue *queue) {
+    atomic_store(&queue->stub.next, NULL);
+    atomic_store(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+}
+
+static void job_queue_push(JobQueue *queue, SigningJob *job) {
+    atomic_store(&job->next, NULL);
+    SigningJob *prev = atomic_exchange(&queue->head, job);
+    atomic_store(&prev->next, job);
+}
+
+// Returns NULL when the queue is empty or a producer is halfway through a push
+static SigningJob *job_queue_pop(JobQueue *queue) {
+    SigningJob *tail = queue->tail;
+    SigningJob *next = atomic_load(&tail->next);
+
+    if (tail == &queue->stub) {
+        if (!next) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = atomic_load(&next->next);
+    }
+
+    if (next) {
+        queue->tail = next;
+        return tail;
+    }
+
+    if (tail != atomic_load(&queue->head)) {
+        return NULL;
+    }
+
+    job_queue_push(queue, &queue->stub);
+    next = atomic_load(&tail->next);
+    if (next) {
+        queue->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+static void record_wait(SigningPool *pool, uint64_t wait_ns) {
+    atomic_fetch_add(&pool->total_wait_ns, wait_ns);
+
+    uint_fast64_t prev = atomic_load(&pool->max_wait_ns);
+    while (wait_ns > prev && !atomic_compare_exchange_weak(&pool->max_wait_ns, &prev, wait_ns)) {
+    }
+}
+
+static void *signing_worker_main(void *arg) {
+    SigningWorker *worker = (SigningWorker *)arg;
+    SigningPool *pool = worker->pool;
+
+    for (;;) {
+        pthread_mutex_lock(&worker->lock);
+        while (atomic_load(&worker->pending) == 0 && !atomic_load(&pool->stopping)) {
+            pthread_cond_wait(&worker->wake, &worker->lock);
+        }
+        pthread_mutex_unlock(&worker->lock);
+
+        // Only reached with nothing pending when the pool is shutting down
+        if (atomic_load(&worker->pending) == 0) {
+            break;
+        }
+
+        SigningJob *job;
+        while (!(job = job_queue_pop(&worker->queue))) {
+            sched_yield();
+        }
+
+        record_wait(pool, monotonic_ns() - job->enqueued_ns);
+
+        if (job->content_digest) {
+            job->success = http_signer_add_headers_for_digest(worker->signer, worker->md_ctx,
+                                                              job->url, job->content_digest, job->method,
+                                                              &job->headers);
+        } else {
+            job->success = http_signer_add_headers_with_ctx(worker->signer, worker->md_ctx,
+                                                            job->url, job->payload, job->method,
+                                                            &job->headers);
+        }
+        atomic_fetch_add(job->success ? &pool->jobs_signed : &pool->jobs_failed, 1);
+        atomic_fetch_sub(&worker->pending, 1);
+
+        // The job may be freed by the callback, do not touch it afterwards
+        if (job->on_signed) {
+            job->on_signed(job, job->user_data);
+        }
+    }
+
+    return NULL;
+}
+
+SigningPool *signing_pool_create(const HttpSigner *signer, int worker_count) {
+    if (!signer) {
+        return NULL;
+    }
+
+    if (worker_count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = cpus > 0 ? (int)cpus : 1;
+    }
+
+    SigningPool *pool = calloc(1, sizeof(SigningPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->workers = calloc((size_t)worker_count, sizeof(SigningWorker));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->worker_count = worker_count;
+    atomic_init(&pool->next_worker, 0);
+    atomic_init(&pool->stopping, false);
+    atomic_init(&pool->jobs_signed, 0);
+    atomic_init(&pool->jobs_failed, 0);
+    atomic_init(&pool->total_wait_ns, 0);
+    atomic_init(&pool->max_wait_ns, 0);
+
+    for (int i = 0; i < worker_count; i++) {
+        SigningWorker *worker = &pool->workers[i];
+        worker->pool = pool;
+        job_queue_init(&worker->queue);
+        atomic_init(&worker->pending, 0);
+        if (pthread_mutex_init(&worker->lock, NULL) != 0) {
+            fprintf(stderr, "Failed to set up signing worker %d\n", i);
+            signing_pool_destroy(pool);
+            return NULL;
+        }
+        if (pthread_cond_init(&worker->wake, NULL) != 0) {
+            pthread_mutex_destroy(&worker->lock);
+            fprintf(stderr, "Failed to set up signing worker %d\n", i);
+            signing_pool_destroy(pool);
+            return NULL;
+        }
+        pool->initialized_count = i + 1;
+
+        worker->signer = http_signer_dup(signer);
+        worker->md_ctx = EVP_MD_CTX_new();
+        if (!worker->signer || !worker->md_ctx) {
+            fprintf(stderr, "Failed to set up signing worker %d\n", i);
+            signing_pool_destroy(pool);
+            return NULL;
+        }
+
+        if (pthread_create(&worker->thread, NULL, signing_worker_main, worker) != 0) {
+            fprintf(stderr, "Failed to start signing worker %d\n", i);
+            signing_pool_destroy(pool);
+            return NULL;
+        }
+        worker->started = true;
+    }
+
+    return pool;
+}
+
+void signing_pool_destroy(SigningPool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    atomic_store(&pool->stopping, true);
+
+    // A failed create leaves the workers past initialized_count untouched
+    for (int i = 0; i < pool->initialized_count; i++) {
+        SigningWorker *worker = &pool->workers[i];
+        pthread_mutex_lock(&worker->lock);
+        pthread_cond_signal(&worker->wake);
+        pthread_mutex_unlock(&worker->lock);
+    }
+
+    for (int i = 0; i < pool->initialized_count; i++) {
+        SigningWorker *worker = &pool->workers[i];
+        if (worker->started) {
+            pthread_join(worker->thread, NULL);
+        }
+        http_signer_destroy(worker->signer);
+        EVP_MD_CTX_free(worker->md_ctx);
+        pthread_mutex_destroy(&worker->lock);
+        pthread_cond_destroy(&worker->wake);
+    }
+
+    free(pool->workers);
+    free(pool);
+}
+
+bool signing_pool_submit(SigningPool *pool, SigningJob *job) {
+    if (!pool || !job || atomic_load(&pool->stopping)) {
+        return false;
+    }
+
+    unsigned int index = atomic_fetch_add(&pool->next_worker, 1) % (unsigned int)pool->worker_count;
+    SigningWorker *worker = &pool->workers[index];
+
+    job->success = false;
+    job->enqueued_ns = monotonic_ns();
+    job_queue_push(&worker->queue, job);
+
+    // Only an idle worker needs waking, busy ones re-check pending themselves
+    if (atomic_fetch_add(&worker->pending, 1) == 0) {
+        pthread_mutex_lock(&worker->lock);
+        pthread_cond_signal(&worker->wake);
+        pthread_mutex_unlock(&worker->lock);
+    }
+
+    return true;
+}
+
+void signing_pool_get_stats(SigningPool *pool, SigningPoolStats *stats) {
+    if (!pool || !stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(SigningPoolStats));
+    for (int i = 0; i < pool->worker_count; i++) {
+        stats->queue_depth += atomic_load(&pool->workers[i].pending);
+    }
+
+    stats->jobs_signed = atomic_load(&pool->jobs_signed);
+    stats->jobs_failed = atomic_load(&pool->jobs_failed);
+
+    uint64_t jobs = stats->jobs_signed + stats->jobs_failed;
+    if (jobs > 0) {
+        stats->avg_wait_ms = (double)atomic_load(&pool->total_wait_ns) / (double)jobs / 1e6;
+    }
+    stats->max_wait_ms = (double)atomic_load(&pool->max_wait_ns) / 1e6;
+}
@@ -0,0 +1,122 @@
+#include "single_flight.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+typedef struct Call {
+    char *key;
+    bool done;
+    void *result;
+    int waiters;                // Callers blocked on this call besides the one fetching
+    pthread_cond_t finished;
+    struct Call *next;
+} Call;
+
+// Only calls in flight are kept, so a short list is enough
+struct SingleFlight {
+    pthread_mutex_t lock;
+    Call *calls;
+    uint64_t joined;
+};
+
+SingleFlight *single_flight_create(void) {
+    SingleFlight *flight = calloc(1, sizeof(SingleFlight));
+    if (!flight) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&flight->lock, NULL);
+    return flight;
+}
+
+void single_flight_destroy(SingleFlight *flight) {
+    if (!flight) {
+        return;
+    }
+
+    pthread_mutex_destroy(&flight->lock);
+    free(flight);
+}
+
+static void free_call(Call *call) {
+    pthread_cond_destroy(&call->finished);
+    free(call->key);
+    free(call);
+}
+
+static void *wait_for_call(SingleFlight *flight, Call *call) {
+    call->waiters++;
+    flight->joined++;
+    while (!call->done) {
+        pthread_cond_wait(&call->finished, &flight->lock);
+    }
+
+    void *result = call->result;
+    bool last = --call->waiters == 0;
+    pthread_mutex_unlock(&flight->lock);
+
+    if (last) {
+        free_call(call);
+    }
+    return result;
+}
+
+void *single_flight_run(SingleFlight *flight, const char *key, SingleFlightFetch fetch,
+                        SingleFlightShare share, void *context) {
+    pthread_mutex_lock(&flight->lock);
+
+    for (Call *call = flight->calls; call; call = call->next) {
+        if (strcmp(call->key, key) == 0) {
+            return wait_for_call(flight, call);
+        }
+    }
+
+    // Nothing in flight for key: this caller fetches. Without memory for the
+    // bookkeeping it still can, just without sharing.
+    Call *call = calloc(1, sizeof(Call));
+    char *key_copy = call ? strdup(key) : NULL;
+    if (!key_copy) {
+        free(call);
+        pthread_mutex_unlock(&flight->lock);
+        return fetch(context, key);
+    }
+
+    call->key = key_copy;
+    pthread_cond_init(&call->finished, NULL);
+    call->next = flight->calls;
+    flight->calls = call;
+    pthread_mutex_unlock(&flight->lock);
+
+    void *result = fetch(context, key);
+
+    pthread_mutex_lock(&flight->lock);
+    for (Call **link = &flight->calls; *link; link = &(*link)->next) {
+        if (*link == call) {
+            *link = call->next;
+            break;
+        }
+    }
+
+    // Callers arriving from now on start a new fetch
+    if (result && call->waiters > 0) {
+        share(result, call->waiters);
+    }
+    call->result = result;
+    call->done = true;
+    bool shared = call->waiters > 0;
+    pthread_cond_broadcast(&call->finished);
+    pthread_mutex_unlock(&flight->lock);
+
+    if (!shared) {
+        free_call(call);
+    }
+    return result;
+}
+
+uint64_t single_flight_joined(SingleFlight *flight) {
+    pthread_mutex_lock(&flight->lock);
+    uint64_t joined = flight->joined;
+    pthread_mutex_unlock(&flight->lock);
+    return joined;
+}
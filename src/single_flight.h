@@ -0,0 +1,31 @@
+#ifndef SINGLE_FLIGHT_H
+#define SINGLE_FLIGHT_H
+
+#include <stdint.h>
+
+// Collapses concurrent calls for the same key into one fetch. The first
+// caller runs the fetch, callers arriving while it is in flight wait for it
+// and all of them get the same result.
+
+// Produce the result for key; may return NULL
+typedef void *(*SingleFlightFetch)(void *context, const char *key);
+
+// Account for extra_holders more owners of a non-NULL result
+typedef void (*SingleFlightShare)(void *result, int extra_holders);
+
+typedef struct SingleFlight SingleFlight;
+
+SingleFlight *single_flight_create(void);
+
+// No call may still be in flight
+void single_flight_destroy(SingleFlight *flight);
+
+// Run fetch for key, or join the call for key already in flight. Every
+// caller owns one reference to the returned result.
+void *single_flight_run(SingleFlight *flight, const char *key, SingleFlightFetch fetch,
+                        SingleFlightShare share, void *context);
+
+// Calls that joined another call instead of fetching
+uint64_t single_flight_joined(SingleFlight *flight);
+
+#endif // SINGLE_FLIGHT_H
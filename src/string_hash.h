@@ -0,0 +1,16 @@
+#ifndef STRING_HASH_H
+#define STRING_HASH_H
+
+#include <stdint.h>
+
+// 64-bit FNV-1a of a NUL-terminated string, for the in-memory lookup tables
+static inline uint64_t string_hash(const char *key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#endif // STRING_HASH_H
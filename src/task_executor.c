@@ -0,0 +1,406 @@
+#include "task_executor.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct {
+    TaskFunction function;
+    void *arg;
+    uint64_t run_at_ns;         // Only used by the timer queue
+} Task;
+
+// Growable ring buffer. The owner pushes and pops at the bottom, thieves take
+// from the top, so a steal gets the oldest and largest-grained work.
+typedef struct {
+    pthread_mutex_t lock;
+    Task *tasks;
+    size_t top;
+    size_t count;
+    size_t capacity;
+} TaskDeque;
+
+typedef struct {
+    TaskExecutor *executor;
+    pthread_t thread;
+    TaskDeque deque;
+    unsigned int steal_seed;
+    bool started;
+} TaskWorker;
+
+struct TaskExecutor {
+    TaskWorker *workers;
+    int worker_count;
+    atomic_uint next_worker;
+
+    // Sleeping workers and delayed tasks, both under lock
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    int sleeping;
+    bool stopping;
+    Task *timers;               // Min-heap on run_at_ns
+    size_t timer_count;
+    size_t timer_capacity;
+
+    atomic_ulong work_seq;      // Bumped on every submit so sleepers never miss work
+    atomic_size_t pending;      // Queued + delayed + running
+    atomic_uint_fast64_t tasks_run;
+    atomic_uint_fast64_t tasks_stolen;
+    atomic_uint_fast64_t tasks_delayed;
+};
+
+static _Thread_local TaskWorker *current_worker;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static bool deque_push(TaskDeque *deque, Task task) {
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count == deque->capacity) {
+        size_t capacity = deque->capacity ? deque->capacity * 2 : 64;
+        Task *tasks = malloc(capacity * sizeof(Task));
+        if (!tasks) {
+            pthread_mutex_unlock(&deque->lock);
+            return false;
+        }
+
+        for (size_t i = 0; i < deque->count; i++) {
+            tasks[i] = deque->tasks[(deque->top + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->top = 0;
+        deque->capacity = capacity;
+    }
+
+    deque->tasks[(deque->top + deque->count) % deque->capacity] = task;
+    deque->count++;
+
+    pthread_mutex_unlock(&deque->lock);
+    return true;
+}
+
+static bool deque_pop_bottom(TaskDeque *deque, Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->count > 0;
+    if (found) {
+        deque->count--;
+        *task = deque->tasks[(deque->top + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool deque_steal_top(TaskDeque *deque, Task *task) {
+    // Thieves do not wait for a busy deque, they try the next victim
+    if (pthread_mutex_trylock(&deque->lock) != 0) {
+        return false;
+    }
+
+    bool found = deque->count > 0;
+    if (found) {
+        *task = deque->tasks[deque->top];
+        deque->top = (deque->top + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static void timer_sift_up(TaskExecutor *executor, size_t index) {
+    Task *heap = executor->timers;
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (heap[parent].run_at_ns <= heap[index].run_at_ns) {
+            break;
+        }
+        Task swap = heap[parent];
+        heap[parent] = heap[index];
+        heap[index] = swap;
+        index = parent;
+    }
+}
+
+static void timer_sift_down(TaskExecutor *executor, size_t index) {
+    Task *heap = executor->timers;
+    for (;;) {
+        size_t smallest = index;
+        size_t left = index * 2 + 1;
+        size_t right = left + 1;
+        if (left < executor->timer_count && heap[left].run_at_ns < heap[smallest].run_at_ns) {
+            smallest = left;
+        }
+        if (right < executor->timer_count && heap[right].run_at_ns < heap[smallest].run_at_ns) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        Task swap = heap[smallest];
+        heap[smallest] = heap[index];
+        heap[index] = swap;
+        index = smallest;
+    }
+}
+
+// Pop the earliest timer if it is due. Called with the executor lock held.
+static bool take_due_timer(TaskExecutor *executor, Task *task, uint64_t now_ns) {
+    if (executor->timer_count == 0 || executor->timers[0].run_at_ns > now_ns) {
+        return false;
+    }
+
+    *task = executor->timers[0];
+    executor->timers[0] = executor->timers[--executor->timer_count];
+    timer_sift_down(executor, 0);
+    return true;
+}
+
+static bool find_task(TaskExecutor *executor, TaskWorker *worker, Task *task) {
+    if (deque_pop_bottom(&worker->deque, task)) {
+        return true;
+    }
+
+    // Start at a random victim so thieves do not all hit the same deque
+    int count = executor->worker_count;
+    int start = (int)(rand_r(&worker->steal_seed) % (unsigned int)count);
+    for (int i = 0; i < count; i++) {
+        TaskWorker *victim = &executor->workers[(start + i) % count];
+        if (victim != worker && deque_steal_top(&victim->deque, task)) {
+            atomic_fetch_add(&executor->tasks_stolen, 1);
+            return true;
+        }
+    }
+
+    pthread_mutex_lock(&executor->lock);
+    bool found = take_due_timer(executor, task, monotonic_ns());
+    pthread_mutex_unlock(&executor->lock);
+    return found;
+}
+
+static void notify_work(TaskExecutor *executor) {
+    atomic_fetch_add(&executor->work_seq, 1);
+
+    pthread_mutex_lock(&executor->lock);
+    if (executor->sleeping > 0) {
+        pthread_cond_signal(&executor->wake);
+    }
+    pthread_mutex_unlock(&executor->lock);
+}
+
+static void finish_task(TaskExecutor *executor) {
+    atomic_fetch_add(&executor->tasks_run, 1);
+
+    if (atomic_fetch_sub(&executor->pending, 1) == 1) {
+        pthread_mutex_lock(&executor->lock);
+        pthread_cond_broadcast(&executor->idle);
+        pthread_mutex_unlock(&executor->lock);
+    }
+}
+
+static void *task_worker_main(void *arg) {
+    TaskWorker *worker = (TaskWorker *)arg;
+    TaskExecutor *executor = worker->executor;
+    current_worker = worker;
+
+    for (;;) {
+        unsigned long seen = atomic_load(&executor->work_seq);
+
+        Task task;
+        if (find_task(executor, worker, &task)) {
+            task.function(executor, task.arg);
+            finish_task(executor);
+            continue;
+        }
+
+        pthread_mutex_lock(&executor->lock);
+        if (executor->stopping) {
+            pthread_mutex_unlock(&executor->lock);
+            break;
+        }
+
+        // Sleep until new work is submitted or the next timer is due
+        if (atomic_load(&executor->work_seq) == seen) {
+            executor->sleeping++;
+            if (executor->timer_count > 0) {
+                uint64_t due_ns = executor->timers[0].run_at_ns;
+                struct timespec deadline = {
+                    .tv_sec = (time_t)(due_ns / 1000000000ull),
+                    .tv_nsec = (long)(due_ns % 1000000000ull)
+                };
+                pthread_cond_timedwait(&executor->wake, &executor->lock, &deadline);
+            } else {
+                pthread_cond_wait(&executor->wake, &executor->lock);
+            }
+            executor->sleeping--;
+        }
+        pthread_mutex_unlock(&executor->lock);
+    }
+
+    return NULL;
+}
+
+TaskExecutor *task_executor_create(int worker_count) {
+    if (worker_count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = cpus > 0 ? (int)cpus : 1;
+    }
+
+    TaskExecutor *executor = calloc(1, sizeof(TaskExecutor));
+    if (!executor) {
+        return NULL;
+    }
+
+    executor->workers = calloc((size_t)worker_count, sizeof(TaskWorker));
+    if (!executor->workers) {
+        free(executor);
+        return NULL;
+    }
+
+    executor->worker_count = worker_count;
+    atomic_init(&executor->next_worker, 0);
+    atomic_init(&executor->work_seq, 0);
+    atomic_init(&executor->pending, 0);
+    atomic_init(&executor->tasks_run, 0);
+    atomic_init(&executor->tasks_stolen, 0);
+    atomic_init(&executor->tasks_delayed, 0);
+
+    // Timer deadlines are on the monotonic clock
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&executor->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&executor->idle, NULL);
+    pthread_mutex_init(&executor->lock, NULL);
+
+    for (int i = 0; i < worker_count; i++) {
+        TaskWorker *worker = &executor->workers[i];
+        worker->executor = executor;
+        worker->steal_seed = (unsigned int)i * 2654435761u + 1;
+        pthread_mutex_init(&worker->deque.lock, NULL);
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        TaskWorker *worker = &executor->workers[i];
+        if (pthread_create(&worker->thread, NULL, task_worker_main, worker) != 0) {
+            fprintf(stderr, "Failed to start task worker %d\n", i);
+            task_executor_destroy(executor);
+            return NULL;
+        }
+        worker->started = true;
+    }
+
+    return executor;
+}
+
+void task_executor_destroy(TaskExecutor *executor) {
+    if (!executor) {
+        return;
+    }
+
+    task_executor_wait(executor);
+
+    pthread_mutex_lock(&executor->lock);
+    executor->stopping = true;
+    pthread_cond_broadcast(&executor->wake);
+    pthread_mutex_unlock(&executor->lock);
+
+    for (int i = 0; i < executor->worker_count; i++) {
+        TaskWorker *worker = &executor->workers[i];
+        if (worker->started) {
+            pthread_join(worker->thread, NULL);
+        }
+        pthread_mutex_destroy(&worker->deque.lock);
+        free(worker->deque.tasks);
+    }
+
+    pthread_cond_destroy(&executor->wake);
+    pthread_cond_destroy(&executor->idle);
+    pthread_mutex_destroy(&executor->lock);
+    free(executor->timers);
+    free(executor->workers);
+    free(executor);
+}
+
+bool task_executor_submit(TaskExecutor *executor, TaskFunction function, void *arg) {
+    if (!executor || !function) {
+        return false;
+    }
+
+    // Work spawned by a task stays local; outside work is spread round-robin
+    TaskWorker *worker = current_worker;
+    if (!worker || worker->executor != executor) {
+        unsigned int index = atomic_fetch_add(&executor->next_worker, 1) % (unsigned int)executor->worker_count;
+        worker = &executor->workers[index];
+    }
+
+    atomic_fetch_add(&executor->pending, 1);
+    Task task = { function, arg, 0 };
+    if (!deque_push(&worker->deque, task)) {
+        atomic_fetch_sub(&executor->pending, 1);
+        return false;
+    }
+
+    notify_work(executor);
+    return true;
+}
+
+bool task_executor_submit_after(TaskExecutor *executor, unsigned int delay_ms, TaskFunction function, void *arg) {
+    if (!executor || !function) {
+        return false;
+    }
+
+    Task task = { function, arg, monotonic_ns() + (uint64_t)delay_ms * 1000000ull };
+
+    pthread_mutex_lock(&executor->lock);
+    if (executor->timer_count == executor->timer_capacity) {
+        size_t capacity = executor->timer_capacity ? executor->timer_capacity * 2 : 64;
+        Task *timers = realloc(executor->timers, capacity * sizeof(Task));
+        if (!timers) {
+            pthread_mutex_unlock(&executor->lock);
+            return false;
+        }
+        executor->timers = timers;
+        executor->timer_capacity = capacity;
+    }
+
+    atomic_fetch_add(&executor->pending, 1);
+    executor->timers[executor->timer_count++] = task;
+    timer_sift_up(executor, executor->timer_count - 1);
+    pthread_mutex_unlock(&executor->lock);
+
+    atomic_fetch_add(&executor->tasks_delayed, 1);
+
+    // A sleeper may need to shorten its timeout for the new deadline
+    notify_work(executor);
+    return true;
+}
+
+void task_executor_wait(TaskExecutor *executor) {
+    if (!executor) {
+        return;
+    }
+
+    pthread_mutex_lock(&executor->lock);
+    while (atomic_load(&executor->pending) > 0) {
+        pthread_cond_wait(&executor->idle, &executor->lock);
+    }
+    pthread_mutex_unlock(&executor->lock);
+}
+
+void task_executor_get_stats(TaskExecutor *executor, TaskExecutorStats *stats) {
+    if (!executor || !stats) {
+        return;
+    }
+
+    stats->tasks_run = atomic_load(&executor->tasks_run);
+    stats->tasks_stolen = atomic_load(&executor->tasks_stolen);
+    stats->tasks_delayed = atomic_load(&executor->tasks_delayed);
+}
@@ -0,0 +1,86 @@
+#include "timestamp.h"
+
+// Days from 1970-01-01 to year-month-day in the proleptic Gregorian calendar
+static int64_t days_from_civil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned year_of_era = (unsigned)(year - era * 400);
+    unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+// Length of a month, 1 to 12, in the proleptic Gregorian calendar
+static unsigned days_in_month(unsigned year, unsigned month) {
+    static const unsigned char lengths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    return lengths[month - 1] + (month == 2 && leap);
+}
+
+// Value of two digits; bad is or-ed with a non-zero value when either is not a digit
+static unsigned two_digits(const char *p, unsigned *bad) {
+    unsigned tens = (unsigned)(unsigned char)p[0] - '0';
+    unsigned ones = (unsigned)(unsigned char)p[1] - '0';
+    *bad |= (tens > 9) | (ones > 9);
+    return tens * 10 + ones;
+}
+
+bool timestamp_parse_ms(const char *text, size_t length, int64_t *ms) {
+    // Fixed part: YYYY-MM-DDTHH:MM:SS
+    if (length < 20) {
+        return false;
+    }
+
+    unsigned bad = 0;
+    unsigned year = two_digits(text, &bad) * 100 + two_digits(text + 2, &bad);
+    unsigned month = two_digits(text + 5, &bad);
+    unsigned day = two_digits(text + 8, &bad);
+    unsigned hour = two_digits(text + 11, &bad);
+    unsigned minute = two_digits(text + 14, &bad);
+    unsigned second = two_digits(text + 17, &bad);
+    bad |= (text[4] != '-') | (text[7] != '-') | ((text[10] | 0x20) != 't') |
+           (text[13] != ':') | (text[16] != ':');
+    bad |= (month - 1 > 11) | (day == 0) | (hour > 23) | (minute > 59) | (second > 60);
+    if (bad || day > days_in_month(year, month)) {
+        return false;
+    }
+
+    // Fraction: the first three digits are milliseconds, the rest are dropped
+    const char *p = text + 19;
+    const char *end = text + length;
+    unsigned millis = 0;
+    if (*p == '.') {
+        p++;
+        const char *digits = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (p - digits < 3) {
+                millis = millis * 10 + (unsigned)(*p - '0');
+            }
+            p++;
+        }
+        if (p == digits) {
+            return false;
+        }
+        for (long scale = p - digits; scale < 3; scale++) {
+            millis *= 10;
+        }
+    }
+
+    // Zone: Z, or an offset to take back off
+    int64_t offset_minutes = 0;
+    if (end - p == 6 && (*p == '+' || *p == '-') && p[3] == ':') {
+        unsigned offset_hours = two_digits(p + 1, &bad);
+        unsigned offset_rest = two_digits(p + 4, &bad);
+        if (bad || offset_hours > 23 || offset_rest > 59) {
+            return false;
+        }
+        offset_minutes = (int64_t)(offset_hours * 60 + offset_rest) * (*p == '-' ? -1 : 1);
+    } else if (end - p != 1 || (*p | 0x20) != 'z') {
+        return false;
+    }
+
+    int64_t days = days_from_civil(year, month, day);
+    int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset_minutes * 60;
+    *ms = seconds * 1000 + millis;
+    return true;
+}
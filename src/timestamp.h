@@ -0,0 +1,14 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Parse an ISO-8601 UTC timestamp as the API writes it,
+// "2025-03-22T01:39:27.446Z", into milliseconds since the Unix epoch. Any
+// number of fraction digits (or none) and a +HH:MM / -HH:MM offset instead
+// of Z are accepted too; other forms fail.
+bool timestamp_parse_ms(const char *text, size_t length, int64_t *ms);
+
+#endif // TIMESTAMP_H
@@ -0,0 +1,273 @@
+#include "transaction_table.h"
+#include "timestamp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT_FIELDS (TRANSACTION_FIELD_ID | TRANSACTION_FIELD_REFERENCE | \
+                     TRANSACTION_FIELD_CREATED_AT | TRANSACTION_FIELD_AMOUNT)
+
+static uint32_t *text_column(const TransactionTable *table, unsigned int field) {
+    switch (field) {
+        case TRANSACTION_FIELD_ID:         return table->id;
+        case TRANSACTION_FIELD_REFERENCE:  return table->reference;
+        case TRANSACTION_FIELD_CREATED_AT: return table->created_at;
+        case TRANSACTION_FIELD_AMOUNT:     return table->amount;
+        default:                           return NULL;
+    }
+}
+
+static uint16_t *code_column(const TransactionTable *table, unsigned int field) {
+    switch (field) {
+        case TRANSACTION_FIELD_STATUS:  return table->status;
+        case TRANSACTION_FIELD_NETWORK: return table->network;
+        case TRANSACTION_FIELD_ASSET:   return table->asset;
+        default:                        return NULL;
+    }
+}
+
+static const TransactionDictionary *dictionary_for(const TransactionTable *table, unsigned int field) {
+    switch (field) {
+        case TRANSACTION_FIELD_STATUS:  return &table->statuses;
+        case TRANSACTION_FIELD_NETWORK: return &table->networks;
+        case TRANSACTION_FIELD_ASSET:   return &table->assets;
+        default:                        return NULL;
+    }
+}
+
+// Copy a string into the arena, returning its offset
+static bool arena_append(TransactionTable *table, const char *value, size_t length, uint32_t *offset) {
+    size_t needed = table->arena_length + length + 1;
+    if (needed > TRANSACTION_TABLE_BINARY_ID) {
+        fprintf(stderr, "Transaction table arena is full\n");
+        return false;
+    }
+
+    if (needed > table->arena_capacity) {
+        size_t capacity = table->arena_capacity ? table->arena_capacity * 2 : 64 * 1024;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        char *arena = realloc(table->arena, capacity);
+        if (!arena) {
+            return false;
+        }
+        table->arena = arena;
+        table->arena_capacity = capacity;
+    }
+
+    *offset = (uint32_t)table->arena_length;
+    memcpy(table->arena + table->arena_length, value, length);
+    table->arena[table->arena_length + length] = '\0';
+    table->arena_length = needed;
+    return true;
+}
+
+static bool arena_equals(const TransactionTable *table, uint32_t offset, const char *value, size_t length) {
+    const char *stored = table->arena + offset;
+    return strlen(stored) == length && memcmp(stored, value, length) == 0;
+}
+
+// Few distinct values are expected, so a linear search behind a
+// previous-hit check is enough
+static bool intern(TransactionTable *table, TransactionDictionary *dictionary,
+                   const char *value, size_t length, uint16_t *code) {
+    if (dictionary->count > 0 && arena_equals(table, dictionary->values[dictionary->last_code], value, length)) {
+        *code = dictionary->last_code;
+        return true;
+    }
+
+    for (uint16_t i = 0; i < dictionary->count; i++) {
+        if (arena_equals(table, dictionary->values[i], value, length)) {
+            dictionary->last_code = i;
+            *code = i;
+            return true;
+        }
+    }
+
+    if (dictionary->count == TRANSACTION_TABLE_NO_CODE) {
+        fprintf(stderr, "Too many distinct values in an interned transaction column\n");
+        return false;
+    }
+
+    if (dictionary->count == dictionary->capacity) {
+        int capacity = dictionary->capacity ? dictionary->capacity * 2 : 8;
+        if (capacity > TRANSACTION_TABLE_NO_CODE) {
+            capacity = TRANSACTION_TABLE_NO_CODE;
+        }
+        uint32_t *values = realloc(dictionary->values, sizeof(uint32_t) * (size_t)capacity);
+        if (!values) {
+            return false;
+        }
+        dictionary->values = values;
+        dictionary->capacity = (uint16_t)capacity;
+    }
+
+    uint32_t offset;
+    if (!arena_append(table, value, length, &offset)) {
+        return false;
+    }
+    dictionary->values[dictionary->count] = offset;
+    dictionary->last_code = dictionary->count;
+    *code = dictionary->count++;
+    return true;
+}
+
+static bool grow_column(void **column, size_t width, int capacity) {
+    void *grown = realloc(*column, width * (size_t)capacity);
+    if (!grown) {
+        return false;
+    }
+    *column = grown;
+    return true;
+}
+
+// Make room for the row being decoded in every column
+static bool reserve_row(TransactionTable *table) {
+    if (table->count < table->row_capacity) {
+        return true;
+    }
+
+    int capacity = table->row_capacity ? table->row_capacity * 2 : 1024;
+    if (!grow_column((void **)&table->id, sizeof(uint32_t), capacity) ||
+        !grow_column((void **)&table->id_key, sizeof(Layer1TransactionId), capacity) ||
+        !grow_column((void **)&table->reference, sizeof(uint32_t), capacity) ||
+        !grow_column((void **)&table->created_at, sizeof(uint32_t), capacity) ||
+        !grow_column((void **)&table->amount, sizeof(uint32_t), capacity) ||
+        !grow_column((void **)&table->created_at_ms, sizeof(int64_t), capacity) ||
+        !grow_column((void **)&table->status, sizeof(uint16_t), capacity) ||
+        !grow_column((void **)&table->network, sizeof(uint16_t), capacity) ||
+        !grow_column((void **)&table->asset, sizeof(uint16_t), capacity)) {
+        return false;
+    }
+    table->row_capacity = capacity;
+    return true;
+}
+
+bool transaction_table_store(TransactionTable *table, unsigned int field, const char *value, size_t length) {
+    if (table->row_fields & field) {
+        return true;
+    }
+    if (!reserve_row(table)) {
+        return false;
+    }
+
+    uint32_t *text = text_column(table, field);
+    if (field == TRANSACTION_FIELD_ID &&
+        layer1_transaction_id_parse_canonical(value, length, &table->id_key[table->count])) {
+        text[table->count] = TRANSACTION_TABLE_BINARY_ID;
+    } else if (text) {
+        if (!arena_append(table, value, length, &text[table->count])) {
+            return false;
+        }
+        if (field == TRANSACTION_FIELD_CREATED_AT &&
+            !timestamp_parse_ms(value, length, &table->created_at_ms[table->count])) {
+            table->created_at_ms[table->count] = LAYER1_TIME_NONE;
+        }
+    } else {
+        uint16_t *codes = code_column(table, field);
+        TransactionDictionary *dictionary = (TransactionDictionary *)dictionary_for(table, field);
+        if (!codes || !intern(table, dictionary, value, length, &codes[table->count])) {
+            return false;
+        }
+    }
+
+    table->row_fields |= field;
+    return true;
+}
+
+bool transaction_table_end_row(TransactionTable *table) {
+    if (!reserve_row(table)) {
+        return false;
+    }
+
+    unsigned int missing = ~table->row_fields;
+    int row = table->count;
+    if (missing & TRANSACTION_FIELD_ID) table->id[row] = TRANSACTION_TABLE_NO_OFFSET;
+    if (table->id[row] != TRANSACTION_TABLE_BINARY_ID) {
+        memset(&table->id_key[row], 0, sizeof(Layer1TransactionId));
+    }
+    if (missing & TRANSACTION_FIELD_REFERENCE) table->reference[row] = TRANSACTION_TABLE_NO_OFFSET;
+    if (missing & TRANSACTION_FIELD_CREATED_AT) table->created_at[row] = TRANSACTION_TABLE_NO_OFFSET;
+    if (missing & TRANSACTION_FIELD_CREATED_AT) table->created_at_ms[row] = LAYER1_TIME_NONE;
+    if (missing & TRANSACTION_FIELD_AMOUNT) table->amount[row] = TRANSACTION_TABLE_NO_OFFSET;
+    if (missing & TRANSACTION_FIELD_STATUS) table->status[row] = TRANSACTION_TABLE_NO_CODE;
+    if (missing & TRANSACTION_FIELD_NETWORK) table->network[row] = TRANSACTION_TABLE_NO_CODE;
+    if (missing & TRANSACTION_FIELD_ASSET) table->asset[row] = TRANSACTION_TABLE_NO_CODE;
+
+    table->row_fields = 0;
+    table->count++;
+    return true;
+}
+
+void layer1_free_transaction_table(TransactionTable *table) {
+    if (!table) {
+        return;
+    }
+
+    // A shared table is freed by its last holder
+    if (atomic_fetch_sub(&table->shared_refs, 1) > 0) {
+        return;
+    }
+
+    free(table->arena);
+    free(table->id);
+    free(table->id_key);
+    free(table->reference);
+    free(table->created_at);
+    free(table->amount);
+    free(table->created_at_ms);
+    free(table->status);
+    free(table->network);
+    free(table->asset);
+    free(table->statuses.values);
+    free(table->networks.values);
+    free(table->assets.values);
+    free(table);
+}
+
+const char *layer1_transaction_table_value(const TransactionTable *table, unsigned int field, int row) {
+    if (row < 0 || row >= table->count) {
+        return NULL;
+    }
+
+    if (field & TEXT_FIELDS) {
+        uint32_t offset = text_column(table, field)[row];
+        if (offset == TRANSACTION_TABLE_NO_OFFSET || offset == TRANSACTION_TABLE_BINARY_ID) {
+            return NULL;
+        }
+        return table->arena + offset;
+    }
+
+    const uint16_t *codes = code_column(table, field);
+    if (!codes || codes[row] == TRANSACTION_TABLE_NO_CODE) {
+        return NULL;
+    }
+    return table->arena + dictionary_for(table, field)->values[codes[row]];
+}
+
+const char *layer1_transaction_table_id(const TransactionTable *table, int row, char out[LAYER1_TRANSACTION_ID_TEXT_SIZE]) {
+    if (row < 0 || row >= table->count || table->id[row] == TRANSACTION_TABLE_NO_OFFSET) {
+        return NULL;
+    }
+    if (table->id[row] != TRANSACTION_TABLE_BINARY_ID) {
+        return table->arena + table->id[row];
+    }
+    layer1_transaction_id_format(&table->id_key[row], out);
+    return out;
+}
+
+uint16_t layer1_transaction_table_code(const TransactionTable *table, unsigned int field, const char *value) {
+    const TransactionDictionary *dictionary = dictionary_for(table, field);
+    if (!dictionary) {
+        return TRANSACTION_TABLE_NO_CODE;
+    }
+
+    size_t length = strlen(value);
+    for (uint16_t i = 0; i < dictionary->count; i++) {
+        if (arena_equals(table, dictionary->values[i], value, length)) {
+            return i;
+        }
+    }
+    return TRANSACTION_TABLE_NO_CODE;
+}
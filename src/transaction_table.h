@@ -0,0 +1,14 @@
+#ifndef TRANSACTION_TABLE_H
+#define TRANSACTION_TABLE_H
+
+#include "layer1_client.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Builds a TransactionTable while a page is decoded. Values of the current
+// row are stored as they arrive; the first value stored for a field wins.
+// Both return false when out of memory or out of dictionary codes.
+bool transaction_table_store(TransactionTable *table, unsigned int field, const char *value, size_t length);
+bool transaction_table_end_row(TransactionTable *table);
+
+#endif // TRANSACTION_TABLE_H
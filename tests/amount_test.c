@@ -0,0 +1,138 @@
+// Exact amounts: parsing at the edges of the 128-bit range, padding of
+// scales past the 19 digits of one 64-bit step, trailing fraction zeros,
+// "-0", malformed decimals, and random units that must survive a
+// format-then-parse round trip at every scale.
+
+#include "amount.h"
+#include "test_support.h"
+#include <string.h>
+
+#define ROUND_TRIPS 20000
+
+__extension__ typedef unsigned __int128 Magnitude;
+
+// 2^127 - 1, the largest magnitude a parse can return
+#define UNITS_MAX ((AmountUnits)(~(Magnitude)0 >> 1))
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t next_random(void) {
+    random_state = random_state * 6364136223846793005ull + 1442695040888963407ull;
+    return random_state ^ (random_state >> 29);
+}
+
+static bool parses_to(const char *text, int scale, AmountUnits expected) {
+    AmountUnits units = 0;
+    return amount_parse(text, strlen(text), scale, &units) && units == expected;
+}
+
+static bool rejected(const char *text, int scale) {
+    AmountUnits units = 0;
+    return !amount_parse(text, strlen(text), scale, &units);
+}
+
+static bool formats_as(AmountUnits units, int scale, const char *expected) {
+    char out[AMOUNT_FORMAT_SIZE];
+    size_t length = amount_format(units, scale, out);
+    return length == strlen(expected) && strcmp(out, expected) == 0;
+}
+
+static AmountUnits power_of_ten(int exponent) {
+    AmountUnits value = 1;
+    while (exponent-- > 0) {
+        value *= 10;
+    }
+    return value;
+}
+
+static void test_range_limits(void) {
+    CHECK(parses_to("170141183460469231731687303715884105727", 0, UNITS_MAX));
+    CHECK(parses_to("-170141183460469231731687303715884105727", 0, -UNITS_MAX));
+    CHECK(rejected("170141183460469231731687303715884105728", 0));
+    CHECK(rejected("1000000000000000000000000000000000000000", 0));
+    CHECK(parses_to("170141183460469231731.687303715884105727", 18, UNITS_MAX));
+    CHECK(rejected("170141183460469231731.687303715884105728", 18));
+    CHECK(rejected("170141183460469231732", 18));
+
+    CHECK(formats_as(UNITS_MAX, 0, "170141183460469231731687303715884105727"));
+    CHECK(formats_as(-UNITS_MAX, 18, "-170141183460469231731.687303715884105727"));
+    CHECK(formats_as(UNITS_MAX, 36, "170.141183460469231731687303715884105727"));
+}
+
+// Scales past 19 are padded in more than one step
+static void test_large_scales(void) {
+    CHECK(parses_to("1", 20, power_of_ten(20)));
+    CHECK(parses_to("1", 36, power_of_ten(36)));
+    CHECK(parses_to("0.000000000000000000001", 30, power_of_ten(9)));
+    CHECK(parses_to("0.000000000000000000000000000000000001", 36, 1));
+    CHECK(parses_to("170", 36, 170 * power_of_ten(36)));
+    CHECK(rejected("171", 36));
+    CHECK(rejected("1", 37));
+
+    CHECK(formats_as(power_of_ten(36), 36, "1"));
+    CHECK(formats_as(1, 36, "0.000000000000000000000000000000000001"));
+    CHECK(formats_as(power_of_ten(9), 30, "0.000000000000000000001"));
+}
+
+static void test_fractions(void) {
+    CHECK(parses_to("0.020126058226553", 18, 20126058226553000));
+    CHECK(parses_to("1.50", 2, 150));
+    CHECK(parses_to("1.5000000", 2, 150));
+    CHECK(rejected("1.501", 2));
+    CHECK(parses_to("12", 6, 12000000));
+    CHECK(parses_to("00012.0", 6, 12000000));
+
+    CHECK(formats_as(150, 2, "1.5"));
+    CHECK(formats_as(100, 2, "1"));
+    CHECK(formats_as(20126058226553000, 18, "0.020126058226553"));
+    CHECK(formats_as(-5, 1, "-0.5"));
+    CHECK(formats_as(0, 18, "0"));
+    CHECK(formats_as(12, 0, "12"));
+}
+
+static void test_signs_and_malformed(void) {
+    CHECK(parses_to("-0", 6, 0));
+    CHECK(parses_to("-0.000", 6, 0));
+    CHECK(formats_as(0, 6, "0"));
+    CHECK(parses_to("-0.5", 1, -5));
+
+    CHECK(rejected("1.", 6));
+    CHECK(rejected(".5", 6));
+    CHECK(rejected("-.5", 6));
+    CHECK(rejected("", 6));
+    CHECK(rejected("-", 6));
+    CHECK(rejected("+1", 6));
+    CHECK(rejected("1e5", 6));
+    CHECK(rejected("1.2.3", 6));
+    CHECK(rejected("1,5", 6));
+    CHECK(rejected(" 1", 6));
+    CHECK(rejected("12345678a", 0));
+    CHECK(rejected("1.12345678a", 18));
+    CHECK(rejected("--1", 6));
+    CHECK(rejected("1", -1));
+}
+
+// Random magnitudes of every width, formatted and parsed back
+static void test_round_trips(void) {
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        Magnitude magnitude = ((Magnitude)next_random() << 64) | next_random();
+        magnitude >>= 1 + next_random() % 127;
+        AmountUnits units = (AmountUnits)magnitude * (next_random() % 2 ? -1 : 1);
+        int scale = (int)(next_random() % 37);
+
+        char out[AMOUNT_FORMAT_SIZE];
+        size_t length = amount_format(units, scale, out);
+        AmountUnits parsed = 0;
+        CHECK(length == strlen(out));
+        CHECK(amount_parse(out, length, scale, &parsed) && parsed == units);
+    }
+}
+
+int main(void) {
+    test_range_limits();
+    test_large_scales();
+    test_fractions();
+    test_signs_and_malformed();
+    test_round_trips();
+    return test_result();
+}
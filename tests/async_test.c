@@ -0,0 +1,312 @@
+// Drive Layer1Async from an epoll loop against the stub server: a mix of
+// address and transaction list requests with signing on the loop thread and
+// on workers, then cancellation of requests still in flight at destroy.
+
+#include "layer1_async.h"
+#include "test_support.h"
+#include "cJSON.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REQUESTS 60
+#define CONCURRENCY 8
+#define TRANSACTIONS_PER_REFERENCE 4
+
+static atomic_int reply_delay_ms;
+
+typedef struct {
+    int epoll_fd;
+    long timer_ms;              // -1 while disarmed
+    struct timespec armed_at;
+    Layer1Async *async;
+    int started;
+    int succeeded;
+} Loop;
+
+typedef struct {
+    Loop *loop;
+    char reference[32];
+    int calls;                  // Completion callbacks received
+    bool succeeded;             // Last callback carried a response
+} Pending;
+
+static Pending pending[REQUESTS];
+
+static char *address_reply(const StubRequest *request) {
+    cJSON *body = cJSON_ParseWithLength(request->body, request->body_length);
+    cJSON *reference = cJSON_GetObjectItemCaseSensitive(body, "reference");
+    cJSON *asset = cJSON_GetObjectItemCaseSensitive(body, "asset");
+    char *reply = NULL;
+    if (cJSON_IsString(reference) && cJSON_IsString(asset)) {
+        cJSON *address = cJSON_CreateObject();
+        cJSON_AddStringToObject(address, "id", "0195bb81-4a56-7916-aae8-109f276eb8fd");
+        cJSON_AddStringToObject(address, "address", "bc1qexample");
+        cJSON_AddStringToObject(address, "network", "BITCOIN");
+        cJSON_AddStringToObject(address, "asset", asset->valuestring);
+        cJSON_AddStringToObject(address, "reference", reference->valuestring);
+        cJSON_AddStringToObject(address, "status", "CREATED");
+        reply = cJSON_PrintUnformatted(address);
+        cJSON_Delete(address);
+    }
+    cJSON_Delete(body);
+    return reply;
+}
+
+static char *transaction_list_reply(const StubRequest *request) {
+    char query[256];
+    if (!stub_query_param(request->target, "q", query, sizeof(query)) ||
+        strncmp(query, "reference:", strlen("reference:")) != 0) {
+        return NULL;
+    }
+
+    cJSON *page = cJSON_CreateObject();
+    cJSON *content = cJSON_AddArrayToObject(page, "content");
+    for (int i = 0; i < TRANSACTIONS_PER_REFERENCE; i++) {
+        cJSON *transaction = cJSON_CreateObject();
+        cJSON_AddStringToObject(transaction, "status", "SUCCESS");
+        cJSON_AddStringToObject(transaction, "amount", "2.5");
+        cJSON *address = cJSON_AddObjectToObject(transaction, "address");
+        cJSON_AddStringToObject(address, "reference", query + strlen("reference:"));
+        cJSON_AddItemToArray(content, transaction);
+    }
+    cJSON_AddNumberToObject(page, "pageNumber", 0);
+    cJSON_AddNumberToObject(page, "totalElements", TRANSACTIONS_PER_REFERENCE);
+    char *reply = cJSON_PrintUnformatted(page);
+    cJSON_Delete(page);
+    return reply;
+}
+
+static void handle_request(const StubRequest *request, StubResponse *response, void *user_data) {
+    int delay_ms = atomic_load(&reply_delay_ms);
+    if (delay_ms > 0) {
+        usleep((useconds_t)delay_ms * 1000);
+    }
+
+    if (strcmp(request->method, "POST") == 0 && strcmp(request->target, "/digital/v1/addresses") == 0) {
+        response->body = address_reply(request);
+    } else if (strcmp(request->method, "GET") == 0 &&
+               strncmp(request->target, "/digital/v1/transactions?", 25) == 0) {
+        response->body = transaction_list_reply(request);
+    }
+    if (!response->body) {
+        response->status = 400;
+        response->body = strdup("{\"error\":\"bad request\"}");
+    }
+}
+
+static void on_socket(Layer1Async *async, curl_socket_t fd, int what, void *user_data, void *socket_data) {
+    Loop *loop = user_data;
+    if (what == CURL_POLL_REMOVE) {
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        return;
+    }
+
+    struct epoll_event event = { 0 };
+    event.data.fd = fd;
+    event.events = (what & CURL_POLL_IN ? EPOLLIN : 0) | (what & CURL_POLL_OUT ? EPOLLOUT : 0);
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+        CHECK(epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0);
+    }
+}
+
+static void on_timer(Layer1Async *async, long timeout_ms, void *user_data) {
+    Loop *loop = user_data;
+    loop->timer_ms = timeout_ms;
+    clock_gettime(CLOCK_MONOTONIC, &loop->armed_at);
+}
+
+static void start_next(Loop *loop);
+
+static void finish(Pending *request, bool succeeded) {
+    Loop *loop = request->loop;
+    request->calls++;
+    request->succeeded = succeeded;
+    if (succeeded) {
+        loop->succeeded++;
+    }
+    if (loop->async && loop->started < REQUESTS) {
+        start_next(loop);
+    }
+}
+
+static void address_done(AddressResponse *response, void *user_data) {
+    Pending *request = user_data;
+    if (response) {
+        CHECK(response->reference && strcmp(response->reference, request->reference) == 0);
+        CHECK(response->asset && strcmp(response->asset, "BTC") == 0);
+        layer1_free_address_response(response);
+    }
+    finish(request, response != NULL);
+}
+
+static void list_done(TransactionListResponse *response, void *user_data) {
+    Pending *request = user_data;
+    if (response) {
+        CHECK(response->count == TRANSACTIONS_PER_REFERENCE);
+        for (int i = 0; i < response->count; i++) {
+            CHECK(response->transactions[i].reference &&
+                  strcmp(response->transactions[i].reference, request->reference) == 0);
+        }
+        layer1_free_transaction_list_response(response);
+    }
+    finish(request, response != NULL);
+}
+
+// Alternate address creation and transaction lists, each tagged with its own
+// reference so a response delivered to the wrong callback is caught
+static void start_next(Loop *loop) {
+    Pending *request = &pending[loop->started];
+    request->loop = loop;
+    request->calls = 0;
+    snprintf(request->reference, sizeof(request->reference), "async-%d", loop->started);
+
+    bool started;
+    if (loop->started % 2) {
+        started = layer1_async_create_address_by_asset(loop->async, "pool-1", "BTC", request->reference,
+                                                       address_done, request);
+    } else {
+        char query[LAYER1_QUERY_SIZE];
+        started = layer1_build_reference_query(query, sizeof(query), request->reference, NULL) &&
+                  layer1_async_list_transactions(loop->async, "pool-1", query, list_done, request);
+    }
+    CHECK(started);
+    loop->started++;
+}
+
+// Wait up to max_wait_ms (-1 for no limit besides the timer) for one batch
+// of events and hand them to the async front end
+static void run_once(Loop *loop, int max_wait_ms) {
+    int wait_ms = max_wait_ms;
+    bool timer_bounds_wait = false;
+    if (loop->timer_ms >= 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed = (now.tv_sec - loop->armed_at.tv_sec) * 1000 +
+                       (now.tv_nsec - loop->armed_at.tv_nsec) / 1000000;
+        int timer_wait_ms = loop->timer_ms > elapsed ? (int)(loop->timer_ms - elapsed) : 0;
+        if (wait_ms < 0 || timer_wait_ms <= wait_ms) {
+            wait_ms = timer_wait_ms;
+            timer_bounds_wait = true;
+        }
+    }
+
+    struct epoll_event events[64];
+    int count = epoll_wait(loop->epoll_fd, events, 64, wait_ms);
+    if (count == 0 && timer_bounds_wait) {
+        loop->timer_ms = -1;
+        layer1_async_timeout(loop->async);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        int mask = (events[i].events & EPOLLIN ? CURL_CSELECT_IN : 0) |
+                   (events[i].events & EPOLLOUT ? CURL_CSELECT_OUT : 0) |
+                   (events[i].events & (EPOLLERR | EPOLLHUP) ? CURL_CSELECT_ERR : 0);
+        layer1_async_socket_action(loop->async, events[i].data.fd, mask);
+    }
+}
+
+static Loop *open_loop(Layer1Client *client, int signing_workers) {
+    Loop *loop = calloc(1, sizeof(Loop));
+    loop->epoll_fd = epoll_create1(0);
+    loop->timer_ms = -1;
+    loop->async = layer1_async_create(client, signing_workers, on_socket, on_timer, loop);
+    CHECK(loop->epoll_fd >= 0 && loop->async != NULL);
+    return loop;
+}
+
+static void close_loop(Loop *loop) {
+    Layer1Async *async = loop->async;
+    loop->async = NULL;         // Cancelled callbacks must not start more requests
+    layer1_async_destroy(async);
+    close(loop->epoll_fd);
+    free(loop);
+}
+
+// Every request completes, with its own response, whether signatures are
+// made on the loop thread or on workers
+static void test_requests_complete(Layer1Client *client, int signing_workers) {
+    Loop *loop = open_loop(client, signing_workers);
+    if (!loop->async) {
+        close_loop(loop);
+        return;
+    }
+
+    for (int i = 0; i < CONCURRENCY; i++) {
+        start_next(loop);
+    }
+    CHECK(layer1_async_in_flight(loop->async) == CONCURRENCY);
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (layer1_async_in_flight(loop->async) > 0) {
+        run_once(loop, -1);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec - start.tv_sec > 30) {
+            CHECK(!"requests did not finish within 30 seconds");
+            break;
+        }
+    }
+
+    CHECK(loop->started == REQUESTS);
+    CHECK(loop->succeeded == REQUESTS);
+    for (int i = 0; i < loop->started; i++) {
+        CHECK(pending[i].calls == 1);
+    }
+    printf("%d signing workers: %d of %d requests completed\n", signing_workers, loop->succeeded, REQUESTS);
+    close_loop(loop);
+}
+
+// Destroying the front end calls each unfinished request back with NULL,
+// exactly once
+static void test_destroy_cancels(Layer1Client *client, int signing_workers) {
+    atomic_store(&reply_delay_ms, 300);
+    Loop *loop = open_loop(client, signing_workers);
+    if (loop->async) {
+        for (int i = 0; i < CONCURRENCY; i++) {
+            start_next(loop);
+        }
+        // Let the requests reach the server, which holds its replies back
+        for (int i = 0; i < 10; i++) {
+            run_once(loop, 10);
+        }
+        CHECK(layer1_async_in_flight(loop->async) == CONCURRENCY);
+    }
+    int started = loop->started;
+    close_loop(loop);
+
+    int calls = 0;
+    for (int i = 0; i < started; i++) {
+        CHECK(pending[i].calls == 1 && !pending[i].succeeded);
+        calls += pending[i].calls;
+    }
+    CHECK(calls == CONCURRENCY);
+    printf("%d signing workers: %d requests cancelled at destroy\n", signing_workers, calls);
+    atomic_store(&reply_delay_ms, 0);
+}
+
+int main(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    char *key_path = test_write_key();
+    StubServer *server = stub_server_start(handle_request, NULL);
+    Layer1Client *client = key_path && server
+        ? layer1_client_create(stub_server_url(server), "async-client", key_path) : NULL;
+    CHECK(client != NULL);
+
+    if (client) {
+        test_requests_complete(client, 0);
+        test_requests_complete(client, 2);
+        test_destroy_cancels(client, 0);
+        test_destroy_cancels(client, 2);
+        CHECK(stub_server_unsigned_requests(server) == 0);
+        layer1_client_destroy(client);
+    }
+
+    stub_server_stop(server);
+    test_remove_key(key_path);
+    curl_global_cleanup();
+    return test_result();
+}
@@ -0,0 +1,195 @@
+// Binary ids against a plain one-digit-at-a-time reference decoder: random
+// ids round-trip through parse and format, uppercase digits are accepted by
+// the parsers but not by the canonical one, and a bad character anywhere is
+// caught, including in the last 16 digits of a transaction id, which the
+// SSE2 decoder reads as a block overlapping the one before. The same file is
+// built as binary_id_scalar_test with LAYER1_NO_SIMD to cover the scalar
+// decoder as well. Transaction tables keep uppercase ids as text.
+
+#include "layer1_client.h"
+#include "transaction_table.h"
+#include "test_support.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RANDOM_IDS 20000
+
+#define ID_DIGITS (LAYER1_TRANSACTION_ID_TEXT_SIZE - 1)
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t next_random(void) {
+    random_state = random_state * 6364136223846793005ull + 1442695040888963407ull;
+    return (uint32_t)(random_state >> 33);
+}
+
+static int reference_digit(unsigned char c, bool fold_case) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (fold_case && c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool reference_decode(const char *text, size_t length, uint8_t *out, bool fold_case) {
+    for (size_t i = 0; i < length; i += 2) {
+        int high = reference_digit((unsigned char)text[i], fold_case);
+        int low = reference_digit((unsigned char)text[i + 1], fold_case);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out[i / 2] = (uint8_t)(high << 4 | low);
+    }
+    return true;
+}
+
+static void random_id(char *text, bool uppercase) {
+    const char *digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    for (int i = 0; i < ID_DIGITS; i++) {
+        text[i] = digits[next_random() % 16];
+    }
+    text[ID_DIGITS] = '\0';
+}
+
+// Both parsers agree with the reference on whether text is an id and on its
+// bytes; what the canonical parser accepts formats back unchanged
+static void check_transaction_id(const char *text) {
+    uint8_t expected[sizeof(Layer1TransactionId)];
+    bool folded_ok = reference_decode(text, ID_DIGITS, expected, true);
+
+    Layer1TransactionId id;
+    CHECK(layer1_transaction_id_parse(text, ID_DIGITS, &id) == folded_ok);
+    CHECK(!folded_ok || memcmp(id.bytes, expected, sizeof(expected)) == 0);
+
+    bool canonical_ok = reference_decode(text, ID_DIGITS, expected, false);
+    CHECK(layer1_transaction_id_parse_canonical(text, ID_DIGITS, &id) == canonical_ok);
+    if (canonical_ok) {
+        char formatted[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+        layer1_transaction_id_format(&id, formatted);
+        CHECK(memcmp(id.bytes, expected, sizeof(expected)) == 0);
+        CHECK(memcmp(formatted, text, ID_DIGITS) == 0 && formatted[ID_DIGITS] == '\0');
+    }
+}
+
+static void test_round_trips(void) {
+    char text[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+    for (int i = 0; i < RANDOM_IDS; i++) {
+        random_id(text, false);
+        check_transaction_id(text);
+    }
+
+    Layer1Uuid uuid;
+    const char *uuid_text = "0195bb81-4a56-7916-aae8-109f276eb8fd";
+    char formatted[LAYER1_UUID_TEXT_SIZE];
+    CHECK(layer1_uuid_parse(uuid_text, strlen(uuid_text), &uuid));
+    layer1_uuid_format(&uuid, formatted);
+    CHECK(strcmp(formatted, uuid_text) == 0);
+    CHECK(uuid.bytes[0] == 0x01 && uuid.bytes[15] == 0xfd);
+}
+
+// Uppercase parses to the same bytes as lowercase, but only through the
+// case-folding parsers
+static void test_uppercase(void) {
+    char text[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+    for (int i = 0; i < RANDOM_IDS / 10; i++) {
+        random_id(text, true);
+        check_transaction_id(text);
+    }
+
+    // One uppercase letter in the overlapping tail is enough to refuse
+    char lower[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+    memset(lower, 'a', ID_DIGITS);
+    lower[ID_DIGITS] = '\0';
+    memcpy(text, lower, sizeof(text));
+    text[ID_DIGITS - 1] = 'A';
+    Layer1TransactionId from_lower, from_upper;
+    CHECK(layer1_transaction_id_parse(lower, ID_DIGITS, &from_lower));
+    CHECK(layer1_transaction_id_parse(text, ID_DIGITS, &from_upper));
+    CHECK(memcmp(&from_lower, &from_upper, sizeof(from_lower)) == 0);
+    CHECK(!layer1_transaction_id_parse_canonical(text, ID_DIGITS, &from_upper));
+
+    Layer1Uuid a, b;
+    CHECK(layer1_uuid_parse("0195BB81-4A56-7916-AAE8-109F276EB8FD", 36, &a));
+    CHECK(layer1_uuid_parse("0195bb81-4a56-7916-aae8-109f276eb8fd", 36, &b));
+    CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+}
+
+// Every position, the overlapping tail included, with characters on either
+// side of each digit range and bytes of 0x80 and up
+static void test_bad_characters(void) {
+    static const unsigned char bad[] = { '/', ':', '@', 'G', '`', 'g', ' ', '-', 0x80, 0xB0, 0xE1, 0xFF, 0x00 };
+    char text[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+    random_id(text, false);
+    for (int position = 0; position < ID_DIGITS; position++) {
+        for (size_t k = 0; k < sizeof(bad); k++) {
+            char saved = text[position];
+            text[position] = (char)bad[k];
+            check_transaction_id(text);
+            text[position] = saved;
+        }
+    }
+
+    Layer1TransactionId id;
+    CHECK(!layer1_transaction_id_parse(text, ID_DIGITS - 1, &id));
+    CHECK(!layer1_transaction_id_parse(text, ID_DIGITS - 2, &id));
+    Layer1Uuid uuid;
+    CHECK(!layer1_uuid_parse("0195bb81-4a56-7916-aae8-109f276eb8f", 35, &uuid));
+    CHECK(!layer1_uuid_parse("0195bb81-4a56-7916-aae8-109f276eb8fg", 36, &uuid));
+    CHECK(!layer1_uuid_parse("0195bb81_4a56-7916-aae8-109f276eb8fd", 36, &uuid));
+}
+
+// Random text drawn mostly from hex digits of both cases, so that most ids
+// have a single bad character or none
+static void test_random_text(void) {
+    static const char alphabet[] = "0123456789abcdefABCDEF0123456789abcdefxG/:@`";
+    char text[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+    for (int i = 0; i < RANDOM_IDS; i++) {
+        random_id(text, false);
+        int changes = (int)(next_random() % 3);
+        for (int k = 0; k < changes; k++) {
+            text[next_random() % ID_DIGITS] = alphabet[next_random() % (sizeof(alphabet) - 1)];
+        }
+        check_transaction_id(text);
+    }
+}
+
+// A table keeps lowercase ids in binary and hands back any other id exactly
+// as received
+static void test_table_ids(void) {
+    char lower[LAYER1_TRANSACTION_ID_TEXT_SIZE], upper[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+    random_id(lower, false);
+    random_id(upper, true);
+    const char *ids[] = { lower, upper, "not-hex" };
+
+    TransactionTable *table = calloc(1, sizeof(TransactionTable));
+    CHECK(table != NULL);
+    for (int i = 0; table && i < 3; i++) {
+        CHECK(transaction_table_store(table, TRANSACTION_FIELD_ID, ids[i], strlen(ids[i])));
+        CHECK(transaction_table_end_row(table));
+    }
+    if (table && table->count == 3) {
+        CHECK(table->id[0] == TRANSACTION_TABLE_BINARY_ID);
+        CHECK(table->id[1] != TRANSACTION_TABLE_BINARY_ID);
+        for (int i = 0; i < 3; i++) {
+            char out[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+            const char *id = layer1_transaction_table_id(table, i, out);
+            CHECK(id && strcmp(id, ids[i]) == 0);
+        }
+    }
+    CHECK(table && table->count == 3);
+    layer1_free_transaction_table(table);
+}
+
+int main(void) {
+    test_round_trips();
+    test_uppercase();
+    test_bad_characters();
+    test_random_text();
+    test_table_ids();
+    return test_result();
+}
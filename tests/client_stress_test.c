@@ -0,0 +1,178 @@
+// Drive one shared Layer1Client from many threads against the stub server
+// and check that every response comes back whole and belongs to the request
+// that asked for it.
+
+#include "layer1_client.h"
+#include "test_support.h"
+#include "cJSON.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THREADS 8
+#define ITERATIONS 50
+#define TRANSACTIONS_PER_REFERENCE 3
+
+static Layer1Client *client;
+static atomic_int completed;
+
+static char *address_reply(const StubRequest *request) {
+    cJSON *body = cJSON_ParseWithLength(request->body, request->body_length);
+    cJSON *reference = cJSON_GetObjectItemCaseSensitive(body, "reference");
+    cJSON *pool = cJSON_GetObjectItemCaseSensitive(body, "assetPoolId");
+    cJSON *network = cJSON_GetObjectItemCaseSensitive(body, "network");
+    char *reply = NULL;
+    if (cJSON_IsString(reference) && cJSON_IsString(pool) && cJSON_IsString(network)) {
+        cJSON *address = cJSON_CreateObject();
+        cJSON_AddStringToObject(address, "id", "0195bb81-4a56-7916-aae8-109f276eb8fd");
+        cJSON_AddStringToObject(address, "address", "0x64c0");
+        cJSON_AddStringToObject(address, "network", network->valuestring);
+        cJSON_AddStringToObject(address, "reference", reference->valuestring);
+        cJSON_AddStringToObject(address, "assetPoolId", pool->valuestring);
+        cJSON_AddStringToObject(address, "status", "CREATED");
+        cJSON_AddStringToObject(address, "createdAt", "2025-03-22T01:39:27.446Z");
+        reply = cJSON_PrintUnformatted(address);
+        cJSON_Delete(address);
+    }
+    cJSON_Delete(body);
+    return reply;
+}
+
+static char *transaction_request_reply(const StubRequest *request) {
+    cJSON *body = cJSON_ParseWithLength(request->body, request->body_length);
+    cJSON *reference = cJSON_GetObjectItemCaseSensitive(body, "reference");
+    char *reply = NULL;
+    if (cJSON_IsString(reference)) {
+        cJSON *transaction = cJSON_CreateObject();
+        cJSON_AddStringToObject(transaction, "requestId", "0195bb81-4a56-7916-aae8-109f276eb8fd");
+        cJSON_AddStringToObject(transaction, "status", "CREATED");
+        cJSON_AddStringToObject(transaction, "network", "ETHEREUM");
+        cJSON_AddStringToObject(transaction, "asset", "ETH");
+        cJSON_AddStringToObject(transaction, "reference", reference->valuestring);
+        cJSON_AddStringToObject(transaction, "createdAt", "2025-03-22T01:39:27.446Z");
+        reply = cJSON_PrintUnformatted(transaction);
+        cJSON_Delete(transaction);
+    }
+    cJSON_Delete(body);
+    return reply;
+}
+
+// A page of transactions carrying the reference from q=reference:<ref>+...
+static char *transaction_list_reply(const StubRequest *request) {
+    char query[256];
+    if (!stub_query_param(request->target, "q", query, sizeof(query)) ||
+        strncmp(query, "reference:", strlen("reference:")) != 0) {
+        return NULL;
+    }
+    char *reference = query + strlen("reference:");
+    reference[strcspn(reference, "+")] = '\0';
+
+    cJSON *page = cJSON_CreateObject();
+    cJSON *content = cJSON_AddArrayToObject(page, "content");
+    for (int i = 0; i < TRANSACTIONS_PER_REFERENCE; i++) {
+        char id[LAYER1_TRANSACTION_ID_TEXT_SIZE];
+        snprintf(id, sizeof(id), "0195bb814a567916aae8109f276eb8fd3524d51c2ab64031ba3613afc85b7478694554%02x", i);
+        cJSON *transaction = cJSON_CreateObject();
+        cJSON_AddStringToObject(transaction, "id", id);
+        cJSON_AddStringToObject(transaction, "status", "SUCCESS");
+        cJSON_AddStringToObject(transaction, "asset", "ETH");
+        cJSON_AddStringToObject(transaction, "amount", "1.5");
+        cJSON_AddStringToObject(transaction, "createdAt", "2025-03-22T01:39:27.446Z");
+        cJSON *address = cJSON_AddObjectToObject(transaction, "address");
+        cJSON_AddStringToObject(address, "reference", reference);
+        cJSON_AddStringToObject(address, "network", "ETHEREUM");
+        cJSON_AddItemToArray(content, transaction);
+    }
+    cJSON_AddNumberToObject(page, "pageNumber", 0);
+    cJSON_AddNumberToObject(page, "pageSize", TRANSACTIONS_PER_REFERENCE);
+    cJSON_AddNumberToObject(page, "totalElements", TRANSACTIONS_PER_REFERENCE);
+    char *reply = cJSON_PrintUnformatted(page);
+    cJSON_Delete(page);
+    return reply;
+}
+
+static void handle_request(const StubRequest *request, StubResponse *response, void *user_data) {
+    const char *path = request->target;
+    if (strcmp(request->method, "POST") == 0 && strcmp(path, "/digital/v1/addresses") == 0) {
+        response->body = address_reply(request);
+    } else if (strcmp(request->method, "POST") == 0 && strcmp(path, "/digital/v1/transaction-requests") == 0) {
+        response->body = transaction_request_reply(request);
+    } else if (strcmp(request->method, "GET") == 0 && strncmp(path, "/digital/v1/transactions?", 25) == 0) {
+        response->body = transaction_list_reply(request);
+    }
+    if (!response->body) {
+        response->status = 400;
+        response->body = strdup("{\"error\":\"bad request\"}");
+    }
+}
+
+static void *run_worker(void *arg) {
+    long worker = (long)arg;
+    char reference[64];
+    char query[LAYER1_QUERY_SIZE];
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        snprintf(reference, sizeof(reference), "stress-%ld-%d", worker, i);
+
+        AddressResponse *address = layer1_create_address(client, "pool-1", "ETHEREUM", NULL, reference);
+        CHECK(address && address->reference && strcmp(address->reference, reference) == 0);
+        CHECK(address && address->assetPoolId && strcmp(address->assetPoolId, "pool-1") == 0);
+        layer1_free_address_response(address);
+
+        TransactionResponse *request = layer1_create_transaction(client, "pool-1", "ETHEREUM", "ETH",
+                                                                 "0xabc", "1.5", reference);
+        CHECK(request && request->reference && strcmp(request->reference, reference) == 0);
+        layer1_free_transaction_response(request);
+
+        CHECK(layer1_build_reference_query(query, sizeof(query), reference, "type:(deposit+withdrawal)"));
+        TransactionListResponse *list = layer1_list_transactions(client, "pool-1", query);
+        CHECK(list && list->count == TRANSACTIONS_PER_REFERENCE);
+        for (int k = 0; list && k < list->count; k++) {
+            CHECK(list->transactions[k].reference && strcmp(list->transactions[k].reference, reference) == 0);
+            CHECK(list->transactions[k].amount && strcmp(list->transactions[k].amount, "1.5") == 0);
+        }
+        layer1_free_transaction_list_response(list);
+
+        atomic_fetch_add(&completed, 1);
+    }
+    return NULL;
+}
+
+int main(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    char *key_path = test_write_key();
+    StubServer *server = stub_server_start(handle_request, NULL);
+    CHECK(key_path && server);
+    if (key_path && server) {
+        client = layer1_client_create(stub_server_url(server), "stress-client", key_path);
+        CHECK(client != NULL);
+    }
+
+    if (client) {
+        pthread_t threads[THREADS];
+        int started = 0;
+        for (long i = 0; i < THREADS; i++) {
+            if (pthread_create(&threads[i], NULL, run_worker, (void *)i) == 0) {
+                started++;
+            }
+        }
+        CHECK(started == THREADS);
+        for (int i = 0; i < started; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        CHECK(atomic_load(&completed) == THREADS * ITERATIONS);
+        CHECK(stub_server_requests(server) == 3u * THREADS * ITERATIONS);
+        CHECK(stub_server_unsigned_requests(server) == 0);
+        printf("%d threads x %d iterations: %d completed, %llu requests, %d failed checks\n",
+               THREADS, ITERATIONS, atomic_load(&completed),
+               (unsigned long long)stub_server_requests(server), test_failures());
+        layer1_client_destroy(client);
+    }
+
+    stub_server_stop(server);
+    test_remove_key(key_path);
+    curl_global_cleanup();
+    return test_result();
+}
@@ -0,0 +1,119 @@
+// Radix sort against a stable comparison sort: negative keys, rows without a
+// timestamp (LAYER1_TIME_NONE, the smallest key), the extremes of int64,
+// runs of equal keys that must keep their order, and keys that share their
+// high bytes so those passes are skipped.
+
+#include "radix_sort.h"
+#include "layer1_client.h"
+#include "test_support.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ITEMS 50000
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ull;
+
+static uint64_t next_random(void) {
+    random_state = random_state * 6364136223846793005ull + 1442695040888963407ull;
+    return random_state ^ (random_state >> 29);
+}
+
+// Rows are numbered in input order, so ordering by row breaks ties stably
+static int compare_items(const void *a, const void *b) {
+    const RadixItem *x = a;
+    const RadixItem *y = b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->row < y->row ? -1 : x->row > y->row;
+}
+
+static void check_sorted(RadixItem *items, size_t count) {
+    RadixItem *expected = malloc(sizeof(RadixItem) * (count + 1));
+    CHECK(expected != NULL);
+    if (!expected) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        items[i].row = (uint32_t)i;
+    }
+    memcpy(expected, items, sizeof(RadixItem) * count);
+    qsort(expected, count, sizeof(RadixItem), compare_items);
+
+    CHECK(radix_sort(items, count));
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        mismatches += items[i].key != expected[i].key || items[i].row != expected[i].row;
+    }
+    CHECK(mismatches == 0);
+    free(expected);
+}
+
+static void test_small(void) {
+    CHECK(radix_sort(NULL, 0));
+    RadixItem one = { -5, 0 };
+    CHECK(radix_sort(&one, 1) && one.key == -5 && one.row == 0);
+
+    RadixItem items[] = {
+        { 3, 0 }, { -1, 0 }, { LAYER1_TIME_NONE, 0 }, { 0, 0 }, { INT64_MAX, 0 },
+        { -1, 0 }, { LAYER1_TIME_NONE, 0 }, { INT64_MIN + 1, 0 }, { 1, 0 }, { -256, 0 }
+    };
+    size_t count = sizeof(items) / sizeof(items[0]);
+    check_sorted(items, count);
+    CHECK(items[0].key == LAYER1_TIME_NONE && items[0].row == 2);
+    CHECK(items[1].key == LAYER1_TIME_NONE && items[1].row == 6);
+    CHECK(items[2].key == INT64_MIN + 1);
+    CHECK(items[count - 1].key == INT64_MAX);
+}
+
+// Keys anywhere in the int64 range, negative half the time
+static void test_full_range(void) {
+    static RadixItem items[ITEMS];
+    for (size_t i = 0; i < ITEMS; i++) {
+        items[i].key = (int64_t)next_random();
+    }
+    check_sorted(items, ITEMS);
+}
+
+// Timestamps a few days either side of the epoch, a tenth of them missing
+// and many repeated, as in a real export
+static void test_timestamps(void) {
+    static RadixItem items[ITEMS];
+    for (size_t i = 0; i < ITEMS; i++) {
+        uint64_t r = next_random();
+        if (r % 10 == 0) {
+            items[i].key = LAYER1_TIME_NONE;
+        } else {
+            items[i].key = (int64_t)(r % 500000000) - 250000000;
+            items[i].key -= items[i].key % 1000;
+        }
+    }
+    check_sorted(items, ITEMS);
+}
+
+// All keys share their high bytes, so only the low passes run
+static void test_shared_high_bytes(void) {
+    static RadixItem items[ITEMS];
+    for (size_t i = 0; i < ITEMS; i++) {
+        items[i].key = 1742607567000ll + (int64_t)(next_random() % 65536);
+    }
+    check_sorted(items, ITEMS);
+
+    for (size_t i = 0; i < ITEMS; i++) {
+        items[i].key = -1 - (int64_t)(next_random() % 256);
+    }
+    check_sorted(items, ITEMS);
+
+    for (size_t i = 0; i < ITEMS; i++) {
+        items[i].key = 42;
+    }
+    check_sorted(items, ITEMS);
+}
+
+int main(void) {
+    test_small();
+    test_full_range();
+    test_timestamps();
+    test_shared_high_bytes();
+    return test_result();
+}
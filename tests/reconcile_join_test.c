@@ -0,0 +1,229 @@
+// The reconcile join, table-driven: each case is one reference's listed
+// transactions and ledger lines, with the result and paired transaction
+// expected for every line and the state expected for every transaction.
+// The cases walk the four passes in turn (id, exact amount, the not-settled
+// fallback and the per-asset cursor), with duplicate amounts, ids the list
+// does not have, and rows returned for other references.
+
+#include "commands/reconcile_join.h"
+#include "test_support.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ROWS 8
+#define REFERENCE "order-1"
+
+// Ids are written as one digit, repeated to the full 72
+typedef struct {
+    char id;
+    const char *status;
+    const char *asset;
+    const char *reference;
+    const char *amount;
+    int state;                  // Expected TRANSACTION_* after the join
+} TransactionRow;
+
+typedef struct {
+    const char *asset;
+    const char *amount;
+    char id;
+    int result;                 // Expected
+    int match;
+} LineRow;
+
+typedef struct {
+    const char *name;
+    int transaction_count;
+    TransactionRow transactions[MAX_ROWS];
+    int line_count;
+    LineRow lines[MAX_ROWS];
+} JoinCase;
+
+static const JoinCase cases[] = {
+    {
+        "id pass pairs by id, whatever the amount", 3, {
+            { 'a', "SUCCESS", "USDT", REFERENCE, "10", TRANSACTION_PAIRED },
+            { 'b', "SUCCESS", "USDT", REFERENCE, "5", TRANSACTION_PAIRED },
+            { 'c', "SUCCESS", "USDT", REFERENCE, "5", TRANSACTION_OPEN },
+        }, 2, {
+            { "USDT", "5", 'b', RESULT_MATCHED, 1 },
+            { "USDT", "9.5", 'a', RESULT_AMOUNT_MISMATCH, 0 },
+        }
+    },
+    {
+        "a line whose id is not listed stays missing", 1, {
+            { 'a', "SUCCESS", "USDT", REFERENCE, "1", TRANSACTION_OPEN },
+        }, 1, {
+            { "USDT", "1", 'f', RESULT_MISSING, NO_MATCH },
+        }
+    },
+    {
+        "duplicate amounts pair in list order", 3, {
+            { 0, "SUCCESS", "USDT", REFERENCE, "5", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "USDT", REFERENCE, "7", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "USDT", REFERENCE, "5.000", TRANSACTION_PAIRED },
+        }, 3, {
+            { "USDT", "5", 0, RESULT_MATCHED, 0 },
+            { "USDT", "5.0", 0, RESULT_MATCHED, 2 },
+            { "USDT", "5", 0, RESULT_AMOUNT_MISMATCH, 1 },
+        }
+    },
+    {
+        "an exact amount of another asset does not pair", 2, {
+            { 0, "SUCCESS", "ETH", REFERENCE, "5", TRANSACTION_OPEN },
+            { 0, "SUCCESS", "USDT", REFERENCE, "6", TRANSACTION_PAIRED },
+        }, 1, {
+            { "USDT", "5", 0, RESULT_AMOUNT_MISMATCH, 1 },
+        }
+    },
+    {
+        "settled transactions win, then pending and failed ones explain lines", 4, {
+            { 0, "PENDING", "USDT", REFERENCE, "3", TRANSACTION_PAIRED },
+            { 'd', "FAILED", "USDT", REFERENCE, "4", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "USDT", REFERENCE, "3", TRANSACTION_PAIRED },
+            { 0, NULL, "USDT", REFERENCE, "8", TRANSACTION_NOT_SETTLED },
+        }, 4, {
+            { "USDT", "3", 0, RESULT_MATCHED, 2 },
+            { "USDT", "3", 0, RESULT_NOT_SETTLED, 0 },
+            { "USDT", "4", 'd', RESULT_NOT_SETTLED, 1 },
+            { "USDT", "2", 0, RESULT_MISSING, NO_MATCH },
+        }
+    },
+    {
+        "leftover lines take open transactions per asset, in list order", 5, {
+            { 0, "SUCCESS", "ETH", REFERENCE, "1", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "USDT", REFERENCE, "2", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "ETH", REFERENCE, "3", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "USDT", REFERENCE, "9", TRANSACTION_PAIRED },
+            { 0, "SUCCESS", "USDT", REFERENCE, "4", TRANSACTION_PAIRED },
+        }, 6, {
+            { "USDT", "8", 0, RESULT_AMOUNT_MISMATCH, 1 },
+            { "ETH", "0.5", 0, RESULT_AMOUNT_MISMATCH, 0 },
+            { "USDT", "4", 0, RESULT_MATCHED, 4 },
+            { "ETH", "0.7", 0, RESULT_AMOUNT_MISMATCH, 2 },
+            { "USDT", "1", 0, RESULT_AMOUNT_MISMATCH, 3 },
+            { "ETH", "5", 0, RESULT_MISSING, NO_MATCH },
+        }
+    },
+    {
+        "rows of other references never pair", 4, {
+            { 0, "SUCCESS", "USDT", "order-2", "5", TRANSACTION_OTHER_REFERENCE },
+            { 0, "SUCCESS", "USDT", NULL, "5", TRANSACTION_OTHER_REFERENCE },
+            { 'e', "SUCCESS", "USDT", "order-10", "6", TRANSACTION_OTHER_REFERENCE },
+            { 0, "PENDING", "USDT", "order-2", "7", TRANSACTION_OTHER_REFERENCE },
+        }, 3, {
+            { "USDT", "5", 0, RESULT_MISSING, NO_MATCH },
+            { "USDT", "6", 'e', RESULT_MISSING, NO_MATCH },
+            { "USDT", "7", 0, RESULT_MISSING, NO_MATCH },
+        }
+    },
+    {
+        "transactions of assets the ledger lacks stay open", 2, {
+            { 0, "SUCCESS", "BTC", REFERENCE, "5", TRANSACTION_OPEN },
+            { 0, "SUCCESS", "USDT", REFERENCE, "not-a-number", TRANSACTION_PAIRED },
+        }, 1, {
+            { "USDT", "5", 0, RESULT_AMOUNT_MISMATCH, 1 },
+        }
+    },
+};
+
+static char *expand_id(char digit) {
+    char *id = malloc(LAYER1_TRANSACTION_ID_TEXT_SIZE);
+    if (id) {
+        memset(id, digit, LAYER1_TRANSACTION_ID_TEXT_SIZE - 1);
+        id[LAYER1_TRANSACTION_ID_TEXT_SIZE - 1] = '\0';
+    }
+    return id;
+}
+
+static char *copy(const char *value) {
+    return value ? strdup(value) : NULL;
+}
+
+static TransactionListResponse *build_transactions(const JoinCase *test) {
+    TransactionListResponse *list = calloc(1, sizeof(TransactionListResponse));
+    Transaction *transactions = list ? calloc(MAX_ROWS, sizeof(Transaction)) : NULL;
+    if (!transactions) {
+        free(list);
+        return NULL;
+    }
+    list->transactions = transactions;
+    list->count = test->transaction_count;
+
+    for (int i = 0; i < test->transaction_count; i++) {
+        const TransactionRow *row = &test->transactions[i];
+        transactions[i].id = row->id ? expand_id(row->id) : NULL;
+        transactions[i].status = copy(row->status);
+        transactions[i].asset = copy(row->asset);
+        transactions[i].reference = copy(row->reference);
+        transactions[i].amount = copy(row->amount);
+        transactions[i].createdAtMs = LAYER1_TIME_NONE;
+    }
+    return list;
+}
+
+static void run_case(const JoinCase *test) {
+    char usdt[] = "USDT", eth[] = "ETH", reference[] = REFERENCE;
+    char *assets[] = { usdt, eth };
+    int scales[] = { amount_scale_for_asset(usdt), amount_scale_for_asset(eth) };
+    LedgerLine lines[MAX_ROWS];
+    uint32_t order[MAX_ROWS];
+
+    Reconciliation run = { 0 };
+    run.lines = lines;
+    run.line_count = (uint32_t)test->line_count;
+    run.order = order;
+    run.assets = assets;
+    run.scales = scales;
+    run.asset_count = 2;
+
+    for (int i = 0; i < test->line_count; i++) {
+        const LineRow *row = &test->lines[i];
+        LedgerLine *line = &lines[i];
+        memset(line, 0, sizeof(LedgerLine));
+        line->match = NO_MATCH;
+        line->asset = strcmp(row->asset, "USDT") == 0 ? 0 : 1;
+        CHECK(amount_parse(row->amount, strlen(row->amount), scales[line->asset], &line->units));
+        if (row->id) {
+            char *id = expand_id(row->id);
+            line->has_id = id && layer1_transaction_id_parse(id, strlen(id), &line->id);
+            CHECK(line->has_id);
+            free(id);
+        }
+        order[i] = (uint32_t)i;
+    }
+
+    ReferenceGroup group = { 0 };
+    group.run = &run;
+    group.reference = reference;
+    group.count = (uint32_t)test->line_count;
+    group.transactions = build_transactions(test);
+    CHECK(group.transactions != NULL);
+    if (!group.transactions) {
+        return;
+    }
+
+    CHECK(reconcile_join_group(&group));
+    int failures = test_failures();
+    for (int i = 0; i < test->line_count; i++) {
+        CHECK(lines[i].result == test->lines[i].result);
+        CHECK(lines[i].match == test->lines[i].match);
+    }
+    for (int i = 0; group.states && i < test->transaction_count; i++) {
+        CHECK(group.states[i] == test->transactions[i].state);
+    }
+    if (test_failures() != failures) {
+        fprintf(stderr, "  in case: %s\n", test->name);
+    }
+
+    layer1_free_transaction_list_response(group.transactions);
+    free(group.states);
+}
+
+int main(void) {
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        run_case(&cases[i]);
+    }
+    printf("%zu join cases\n", sizeof(cases) / sizeof(cases[0]));
+    return test_result();
+}
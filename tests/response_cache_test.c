@@ -0,0 +1,243 @@
+// The client's list cache against the stub server: hits skip the request,
+// lists that can still change expire after the pending TTL while settled
+// ones stay, the least recently used entry is evicted when the cache is
+// full, and creating an address drops the cached list for its reference.
+// Creating a transaction drops the pool's transaction lists, including one
+// whose fetch was still in flight when the transaction was created.
+
+#include "layer1_client.h"
+#include "test_support.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SETTLED_TTL_MS 60000
+#define PENDING_TTL_MS 100
+
+static Layer1Client *client;
+static StubServer *server;
+
+static pthread_mutex_t gate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gate_changed = PTHREAD_COND_INITIALIZER;
+static bool gate_open = true;
+static bool held_arrived;
+
+static void set_gate(bool open) {
+    pthread_mutex_lock(&gate_lock);
+    gate_open = open;
+    held_arrived = false;
+    pthread_cond_broadcast(&gate_changed);
+    pthread_mutex_unlock(&gate_lock);
+}
+
+// The list of reference "held" is answered only once the gate is open
+static void hold_reply(void) {
+    pthread_mutex_lock(&gate_lock);
+    held_arrived = true;
+    pthread_cond_broadcast(&gate_changed);
+    while (!gate_open) {
+        pthread_cond_wait(&gate_changed, &gate_lock);
+    }
+    pthread_mutex_unlock(&gate_lock);
+}
+
+static void wait_for_held(void) {
+    pthread_mutex_lock(&gate_lock);
+    while (!held_arrived) {
+        pthread_cond_wait(&gate_changed, &gate_lock);
+    }
+    pthread_mutex_unlock(&gate_lock);
+}
+
+// Transactions of references starting with "pending" are still PENDING
+static void handle_request(const StubRequest *request, StubResponse *response, void *user_data) {
+    char reference[256] = "";
+    char query[256];
+    if (stub_query_param(request->target, "q", query, sizeof(query)) &&
+        strncmp(query, "reference:", strlen("reference:")) == 0) {
+        snprintf(reference, sizeof(reference), "%s", query + strlen("reference:"));
+    }
+
+    char body[512];
+    if (strcmp(request->target, "/digital/v1/transaction-requests") == 0) {
+        snprintf(body, sizeof(body), "{\"requestId\":\"r1\",\"status\":\"PENDING\",\"reference\":\"settled\"}");
+    } else if (strncmp(request->target, "/digital/v1/transactions?", 25) == 0) {
+        if (strcmp(reference, "held") == 0) {
+            hold_reply();
+        }
+        const char *status = strncmp(reference, "pending", 7) == 0 ? "PENDING" : "SUCCESS";
+        snprintf(body, sizeof(body),
+                 "{\"content\":[{\"status\":\"%s\",\"amount\":\"1\",\"address\":{\"reference\":\"%s\"}}],"
+                 "\"pageNumber\":0,\"totalElements\":1}", status, reference);
+    } else if (strcmp(request->method, "GET") == 0) {
+        snprintf(body, sizeof(body),
+                 "{\"content\":[{\"id\":\"a1\",\"address\":\"0x64c0\",\"reference\":\"%s\"}],"
+                 "\"pageNumber\":0,\"pageSize\":20,\"totalElements\":1}", reference);
+    } else {
+        snprintf(body, sizeof(body), "{\"id\":\"a2\",\"address\":\"0x64c1\",\"reference\":\"shop\"}");
+    }
+    response->body = strdup(body);
+}
+
+static void sleep_ms(long ms) {
+    struct timespec pause = { ms / 1000, (ms % 1000) * 1000000 };
+    nanosleep(&pause, NULL);
+}
+
+// List reference and report whether that took a request
+static bool list_fetched(const char *reference) {
+    char query[LAYER1_QUERY_SIZE];
+    uint64_t requests = stub_server_requests(server);
+    TransactionListResponse *list = layer1_build_reference_query(query, sizeof(query), reference, NULL)
+        ? layer1_list_transactions(client, "pool-1", query) : NULL;
+    CHECK(list && list->count == 1);
+    CHECK(list && list->transactions[0].reference && strcmp(list->transactions[0].reference, reference) == 0);
+    layer1_free_transaction_list_response(list);
+    return stub_server_requests(server) != requests;
+}
+
+static void test_hits(void) {
+    CHECK(layer1_client_set_cache(client, 8, SETTLED_TTL_MS, PENDING_TTL_MS));
+    CHECK(list_fetched("settled"));
+    CHECK(!list_fetched("settled"));
+    CHECK(!list_fetched("settled"));
+
+    Layer1CacheStats stats = layer1_client_cache_stats(client);
+    CHECK(stats.hits == 2 && stats.misses == 1 && stats.entries == 1);
+}
+
+// A pending list is served until its TTL passes, then fetched again; a
+// settled list cached at the same time is still there
+static void test_pending_expiry(void) {
+    CHECK(layer1_client_set_cache(client, 8, SETTLED_TTL_MS, PENDING_TTL_MS));
+    CHECK(list_fetched("pending-1"));
+    CHECK(list_fetched("settled"));
+    CHECK(!list_fetched("pending-1"));
+
+    sleep_ms(PENDING_TTL_MS + 50);
+    CHECK(list_fetched("pending-1"));
+    CHECK(!list_fetched("settled"));
+
+    Layer1CacheStats stats = layer1_client_cache_stats(client);
+    CHECK(stats.expirations == 1);
+    CHECK(stats.hits == 2 && stats.misses == 3);
+}
+
+// With room for three lists, a fourth evicts the least recently used
+static void test_eviction(void) {
+    CHECK(layer1_client_set_cache(client, 3, SETTLED_TTL_MS, PENDING_TTL_MS));
+    CHECK(list_fetched("k1"));
+    CHECK(list_fetched("k2"));
+    CHECK(list_fetched("k3"));
+    CHECK(!list_fetched("k1"));        // k2 is now the oldest
+    CHECK(list_fetched("k4"));
+
+    Layer1CacheStats stats = layer1_client_cache_stats(client);
+    CHECK(stats.evictions == 1 && stats.entries == 3);
+
+    CHECK(!list_fetched("k1"));
+    CHECK(!list_fetched("k3"));
+    CHECK(!list_fetched("k4"));
+    CHECK(list_fetched("k2"));
+}
+
+static void test_create_invalidates(void) {
+    CHECK(layer1_client_set_cache(client, 8, SETTLED_TTL_MS, PENDING_TTL_MS));
+    uint64_t requests = stub_server_requests(server);
+    AddressListResponse *list = layer1_list_addresses(client, "pool-1", "shop");
+    layer1_free_address_list_response(list);
+    list = layer1_list_addresses(client, "pool-1", "shop");
+    CHECK(list && list->contentCount == 1);
+    layer1_free_address_list_response(list);
+    CHECK(stub_server_requests(server) - requests == 1);
+
+    AddressResponse *address = layer1_create_address(client, "pool-1", "ETHEREUM", NULL, "shop");
+    CHECK(address != NULL);
+    layer1_free_address_response(address);
+
+    list = layer1_list_addresses(client, "pool-1", "shop");
+    CHECK(list && list->contentCount == 1);
+    layer1_free_address_list_response(list);
+    CHECK(stub_server_requests(server) - requests == 3);
+}
+
+static bool table_fetched(const char *reference) {
+    char query[LAYER1_QUERY_SIZE];
+    uint64_t requests = stub_server_requests(server);
+    TransactionTable *table = layer1_build_reference_query(query, sizeof(query), reference, NULL)
+        ? layer1_list_transactions_table(client, "pool-1", query, TRANSACTION_FIELDS_ALL) : NULL;
+    CHECK(table && table->count == 1);
+    layer1_free_transaction_table(table);
+    return stub_server_requests(server) != requests;
+}
+
+static bool create_transaction(void) {
+    TransactionResponse *transaction = layer1_create_transaction(client, "pool-1", "ETHEREUM", "USDT",
+                                                                 "0x64c0", "1", "settled");
+    layer1_free_transaction_response(transaction);
+    return transaction != NULL;
+}
+
+// Settled lists and tables would otherwise hide the new transaction for the
+// whole settled TTL
+static void test_transaction_create_invalidates(void) {
+    CHECK(layer1_client_set_cache(client, 8, SETTLED_TTL_MS, PENDING_TTL_MS));
+    CHECK(list_fetched("settled"));
+    CHECK(table_fetched("settled"));
+    CHECK(!list_fetched("settled"));
+    CHECK(!table_fetched("settled"));
+
+    CHECK(create_transaction());
+    CHECK(layer1_client_cache_stats(client).entries == 0);
+    CHECK(list_fetched("settled"));
+    CHECK(table_fetched("settled"));
+    CHECK(!list_fetched("settled"));
+}
+
+static void *list_held(void *arg) {
+    CHECK(list_fetched("held"));
+    return NULL;
+}
+
+// A list whose request went out before the create answers with what it had
+// then, and must not be cached after the create flushed the cache
+static void test_create_during_fetch(void) {
+    CHECK(layer1_client_set_cache(client, 8, SETTLED_TTL_MS, PENDING_TTL_MS));
+    set_gate(false);
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, list_held, NULL) == 0);
+    wait_for_held();
+    CHECK(create_transaction());
+    set_gate(true);
+    pthread_join(thread, NULL);
+
+    CHECK(layer1_client_cache_stats(client).entries == 0);
+    CHECK(list_fetched("held"));
+    CHECK(!list_fetched("held"));
+}
+
+int main(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    char *key_path = test_write_key();
+    server = stub_server_start(handle_request, NULL);
+    client = key_path && server
+        ? layer1_client_create(stub_server_url(server), "cache-client", key_path) : NULL;
+    CHECK(client != NULL);
+
+    if (client) {
+        test_hits();
+        test_pending_expiry();
+        test_eviction();
+        test_create_invalidates();
+        test_transaction_create_invalidates();
+        test_create_during_fetch();
+        printf("%llu requests served\n", (unsigned long long)stub_server_requests(server));
+        layer1_client_destroy(client);
+    }
+
+    stub_server_stop(server);
+    test_remove_key(key_path);
+    curl_global_cleanup();
+    return test_result();
+}
@@ -0,0 +1,244 @@
+// Signing pool: jobs submitted from several threads are each signed once,
+// with signatures that verify against the request they were made for; failed
+// jobs are reported as such; the counters add up; and destroying the pool
+// signs whatever is still queued first.
+
+#include "signing_pool.h"
+#include "layer1_client.h"
+#include "test_support.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WORKERS 4
+#define PRODUCERS 4
+#define JOBS_PER_PRODUCER 150
+#define JOBS (PRODUCERS * JOBS_PER_PRODUCER)
+
+typedef struct {
+    SigningJob job;
+    char url[128];
+    char payload[64];
+    char *content_digest;
+    atomic_int calls;
+} TestJob;
+
+static TestJob jobs[JOBS];
+static atomic_int finished;
+static SigningPool *pool;
+
+static void on_signed(SigningJob *job, void *user_data) {
+    TestJob *test_job = user_data;
+    CHECK(job == &test_job->job);
+    atomic_fetch_add(&test_job->calls, 1);
+    atomic_fetch_add(&finished, 1);
+}
+
+// GETs without a body, POSTs hashed by the signer, and POSTs whose digest
+// was computed up front
+static void prepare_job(TestJob *test_job, int index) {
+    memset(test_job, 0, sizeof(*test_job));
+    snprintf(test_job->url, sizeof(test_job->url),
+             "https://api.layer1.com/digital/v1/transactions?assetPoolId=pool-1&q=reference:job-%d", index);
+    snprintf(test_job->payload, sizeof(test_job->payload), "{\"reference\":\"job-%d\"}", index);
+    test_job->job.url = test_job->url;
+    test_job->job.on_signed = on_signed;
+    test_job->job.user_data = test_job;
+    switch (index % 3) {
+        case 0:
+            test_job->job.method = "GET";
+            break;
+        case 1:
+            test_job->job.method = "POST";
+            test_job->job.payload = test_job->payload;
+            break;
+        default:
+            test_job->job.method = "POST";
+            test_job->content_digest = create_digest("sha-256", test_job->payload);
+            test_job->job.content_digest = test_job->content_digest;
+            break;
+    }
+}
+
+static const char *header_value(const struct curl_slist *headers, const char *name) {
+    size_t length = strlen(name);
+    for (; headers; headers = headers->next) {
+        if (strncmp(headers->data, name, length) == 0 && headers->data[length] == ':') {
+            return headers->data + length + 2;
+        }
+    }
+    return NULL;
+}
+
+// Rebuild the signature base from the headers and check the signature on it
+static bool signature_verifies(const HttpSigner *signer, const TestJob *test_job) {
+    const struct curl_slist *headers = test_job->job.headers;
+    const char *input = header_value(headers, "Signature-Input");
+    const char *signature = header_value(headers, "Signature");
+    const char *digest = header_value(headers, "Content-Digest");
+    if (!input || !signature || strncmp(input, "sig=", 4) != 0 || strncmp(signature, "sig=:", 5) != 0) {
+        return false;
+    }
+    if ((test_job->job.payload || test_job->job.content_digest) != (digest != NULL)) {
+        return false;
+    }
+
+    char base[1024];
+    if (digest) {
+        snprintf(base, sizeof(base), "\"@method\": %s\n\"@target-uri\": %s\n\"content-digest\": %s\n\"@signature-params\": %s",
+                 test_job->job.method, test_job->url, digest, input + 4);
+    } else {
+        snprintf(base, sizeof(base), "\"@method\": %s\n\"@target-uri\": %s\n\"@signature-params\": %s",
+                 test_job->job.method, test_job->url, input + 4);
+    }
+
+    // Ed25519 signatures are 64 bytes, 88 characters of base64
+    const char *encoded = signature + 5;
+    size_t encoded_length = strlen(encoded);
+    if (encoded_length < 1 || encoded[encoded_length - 1] != ':') {
+        return false;
+    }
+    encoded_length--;
+    unsigned char raw[128];
+    if (encoded_length != 88 || EVP_DecodeBlock(raw, (const unsigned char *)encoded, (int)encoded_length) != 66) {
+        return false;
+    }
+
+    EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+    bool verified = md_ctx &&
+                    EVP_DigestVerifyInit(md_ctx, NULL, NULL, NULL, signer->signing_key) == 1 &&
+                    EVP_DigestVerify(md_ctx, raw, 64, (const unsigned char *)base, strlen(base)) == 1;
+    EVP_MD_CTX_free(md_ctx);
+    return verified;
+}
+
+static void *submit_jobs(void *arg) {
+    long producer = (long)arg;
+    for (int i = 0; i < JOBS_PER_PRODUCER; i++) {
+        CHECK(signing_pool_submit(pool, &jobs[producer * JOBS_PER_PRODUCER + i].job));
+    }
+    return NULL;
+}
+
+static bool wait_for_finished(int count) {
+    struct timespec pause = { 0, 1000000 };
+    for (int i = 0; i < 30000; i++) {
+        if (atomic_load(&finished) >= count) {
+            return true;
+        }
+        nanosleep(&pause, NULL);
+    }
+    return false;
+}
+
+static void release_jobs(int count) {
+    for (int i = 0; i < count; i++) {
+        curl_slist_free_all(jobs[i].job.headers);
+        free(jobs[i].content_digest);
+    }
+}
+
+static void test_concurrent_submit(const HttpSigner *signer) {
+    for (int i = 0; i < JOBS; i++) {
+        prepare_job(&jobs[i], i);
+    }
+    atomic_store(&finished, 0);
+    pool = signing_pool_create(signer, WORKERS);
+    CHECK(pool != NULL);
+    if (!pool) {
+        release_jobs(JOBS);
+        return;
+    }
+
+    pthread_t producers[PRODUCERS];
+    for (long i = 0; i < PRODUCERS; i++) {
+        CHECK(pthread_create(&producers[i], NULL, submit_jobs, (void *)i) == 0);
+    }
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    CHECK(wait_for_finished(JOBS));
+
+    int verified = 0;
+    for (int i = 0; i < JOBS; i++) {
+        CHECK(atomic_load(&jobs[i].calls) == 1);
+        CHECK(jobs[i].job.success);
+        if (signature_verifies(signer, &jobs[i])) {
+            verified++;
+        }
+    }
+    CHECK(verified == JOBS);
+
+    SigningPoolStats stats;
+    signing_pool_get_stats(pool, &stats);
+    CHECK(stats.jobs_signed == JOBS && stats.jobs_failed == 0);
+    CHECK(stats.queue_depth == 0);
+    CHECK(stats.max_wait_ms >= stats.avg_wait_ms && stats.avg_wait_ms >= 0.0);
+    printf("%d workers: %d of %d jobs signed and verified, average wait %.2f ms\n",
+           WORKERS, verified, JOBS, stats.avg_wait_ms);
+
+    signing_pool_destroy(pool);
+    release_jobs(JOBS);
+}
+
+// A job the signer rejects completes with success false and is counted
+static void test_failed_job(const HttpSigner *signer) {
+    prepare_job(&jobs[0], 0);
+    jobs[0].job.method = NULL;
+    atomic_store(&finished, 0);
+    pool = signing_pool_create(signer, 1);
+    CHECK(pool != NULL);
+    if (!pool) {
+        release_jobs(1);
+        return;
+    }
+    CHECK(signing_pool_submit(pool, &jobs[0].job));
+    CHECK(wait_for_finished(1));
+    CHECK(!jobs[0].job.success);
+
+    SigningPoolStats stats;
+    signing_pool_get_stats(pool, &stats);
+    CHECK(stats.jobs_signed == 0 && stats.jobs_failed == 1);
+    signing_pool_destroy(pool);
+    release_jobs(1);
+}
+
+// Jobs still queued when the pool is destroyed are signed before it returns
+static void test_destroy_drains(const HttpSigner *signer) {
+    for (int i = 0; i < JOBS; i++) {
+        prepare_job(&jobs[i], i);
+    }
+    atomic_store(&finished, 0);
+    pool = signing_pool_create(signer, 2);
+    bool created = pool != NULL;
+    CHECK(created);
+    for (int i = 0; created && i < JOBS; i++) {
+        CHECK(signing_pool_submit(pool, &jobs[i].job));
+    }
+    signing_pool_destroy(pool);
+
+    CHECK(atomic_load(&finished) == (created ? JOBS : 0));
+    for (int i = 0; created && i < JOBS; i++) {
+        CHECK(atomic_load(&jobs[i].calls) == 1 && jobs[i].job.success);
+    }
+    release_jobs(JOBS);
+}
+
+int main(void) {
+    char *key_path = test_write_key();
+    char *pem = key_path ? read_file_to_string(key_path) : NULL;
+    HttpSigner *signer = pem ? http_signer_create(pem, "pool-client") : NULL;
+    CHECK(signer && signer->algorithm == SIGNATURE_ALG_ED25519);
+
+    if (signer) {
+        test_concurrent_submit(signer);
+        test_failed_job(signer);
+        test_destroy_drains(signer);
+        http_signer_destroy(signer);
+    }
+
+    free(pem);
+    test_remove_key(key_path);
+    return test_result();
+}
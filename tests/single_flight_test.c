@@ -0,0 +1,190 @@
+// Concurrent identical list calls on a client with coalescing on must share
+// one request and one response. The stub server holds its reply until every
+// caller has joined the call in flight, so the outcome does not depend on
+// thread timing.
+
+#include "layer1_client.h"
+#include "test_support.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CALLERS 8
+#define TRANSACTIONS 5
+
+static pthread_mutex_t gate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gate_opened = PTHREAD_COND_INITIALIZER;
+static bool gate_open = true;
+
+static Layer1Client *client;
+static pthread_barrier_t start_line;
+
+typedef struct {
+    const char *query;
+    TransactionListResponse *list;
+    AddressListResponse *addresses;
+} Caller;
+
+static void set_gate(bool open) {
+    pthread_mutex_lock(&gate_lock);
+    gate_open = open;
+    pthread_cond_broadcast(&gate_opened);
+    pthread_mutex_unlock(&gate_lock);
+}
+
+static void handle_request(const StubRequest *request, StubResponse *response, void *user_data) {
+    pthread_mutex_lock(&gate_lock);
+    while (!gate_open) {
+        pthread_cond_wait(&gate_opened, &gate_lock);
+    }
+    pthread_mutex_unlock(&gate_lock);
+
+    char body[2048];
+    size_t length = 0;
+    if (strncmp(request->target, "/digital/v1/transactions?", 25) == 0) {
+        length += (size_t)snprintf(body, sizeof(body), "{\"content\":[");
+        for (int i = 0; i < TRANSACTIONS; i++) {
+            length += (size_t)snprintf(body + length, sizeof(body) - length,
+                                       "%s{\"status\":\"PENDING\",\"amount\":\"%d.5\",\"address\":{\"reference\":\"shared\"}}",
+                                       i ? "," : "", i);
+        }
+        snprintf(body + length, sizeof(body) - length, "],\"pageNumber\":0,\"totalElements\":%d}", TRANSACTIONS);
+    } else {
+        snprintf(body, sizeof(body),
+                 "{\"content\":[{\"id\":\"a1\",\"address\":\"0x64c0\",\"network\":\"ETHEREUM\",\"reference\":\"shared\"}],"
+                 "\"pageNumber\":0,\"pageSize\":20,\"totalElements\":1}");
+    }
+    response->body = strdup(body);
+}
+
+static void *list_transactions(void *arg) {
+    Caller *caller = arg;
+    pthread_barrier_wait(&start_line);
+    caller->list = layer1_list_transactions(client, "pool-1", caller->query);
+    return NULL;
+}
+
+static void *list_addresses(void *arg) {
+    Caller *caller = arg;
+    pthread_barrier_wait(&start_line);
+    caller->addresses = layer1_list_addresses(client, "pool-1", "shared");
+    return NULL;
+}
+
+// Wait until the client reports joined callers, or give up after 10 seconds
+static bool wait_for_joined(uint64_t joined) {
+    struct timespec pause = { 0, 1000000 };
+    for (int i = 0; i < 10000; i++) {
+        if (layer1_client_coalesced_requests(client) >= joined) {
+            return true;
+        }
+        nanosleep(&pause, NULL);
+    }
+    return false;
+}
+
+static void run_callers(Caller *callers, void *(*call)(void *), uint64_t expect_joined) {
+    pthread_t threads[CALLERS];
+    pthread_barrier_init(&start_line, NULL, CALLERS);
+    set_gate(false);
+    for (int i = 0; i < CALLERS; i++) {
+        CHECK(pthread_create(&threads[i], NULL, call, &callers[i]) == 0);
+    }
+    CHECK(wait_for_joined(expect_joined));
+    set_gate(true);
+    for (int i = 0; i < CALLERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&start_line);
+}
+
+// CALLERS identical transaction lists: one request, CALLERS - 1 joined, and
+// every caller holds the same response, freed once by each
+static void test_identical_lists(StubServer *server) {
+    Caller callers[CALLERS] = { { 0 } };
+    for (int i = 0; i < CALLERS; i++) {
+        callers[i].query = "reference:shared";
+    }
+
+    uint64_t requests = stub_server_requests(server);
+    uint64_t joined = layer1_client_coalesced_requests(client);
+    run_callers(callers, list_transactions, joined + CALLERS - 1);
+
+    CHECK(stub_server_requests(server) - requests == 1);
+    CHECK(layer1_client_coalesced_requests(client) - joined == CALLERS - 1);
+    for (int i = 0; i < CALLERS; i++) {
+        CHECK(callers[i].list && callers[i].list == callers[0].list);
+        CHECK(callers[i].list && callers[i].list->count == TRANSACTIONS);
+    }
+    for (int i = 0; i < CALLERS; i++) {
+        layer1_free_transaction_list_response(callers[i].list);
+    }
+}
+
+static void test_identical_address_lists(StubServer *server) {
+    Caller callers[CALLERS] = { { 0 } };
+    uint64_t requests = stub_server_requests(server);
+    uint64_t joined = layer1_client_coalesced_requests(client);
+    run_callers(callers, list_addresses, joined + CALLERS - 1);
+
+    CHECK(stub_server_requests(server) - requests == 1);
+    for (int i = 0; i < CALLERS; i++) {
+        CHECK(callers[i].addresses && callers[i].addresses == callers[0].addresses);
+        CHECK(callers[i].addresses && callers[i].addresses->contentCount == 1);
+    }
+    for (int i = 0; i < CALLERS; i++) {
+        layer1_free_address_list_response(callers[i].addresses);
+    }
+}
+
+// Two distinct queries are never merged, and a call made after the shared
+// one finished fetches again
+static void test_distinct_and_later_calls(StubServer *server) {
+    Caller callers[CALLERS] = { { 0 } };
+    for (int i = 0; i < CALLERS; i++) {
+        callers[i].query = i % 2 ? "reference:odd" : "reference:even";
+    }
+
+    uint64_t requests = stub_server_requests(server);
+    uint64_t joined = layer1_client_coalesced_requests(client);
+    run_callers(callers, list_transactions, joined + CALLERS - 2);
+
+    CHECK(stub_server_requests(server) - requests == 2);
+    for (int i = 0; i < CALLERS; i++) {
+        CHECK(callers[i].list && callers[i].list == callers[i % 2].list);
+    }
+    CHECK(callers[0].list != callers[1].list);
+    for (int i = 0; i < CALLERS; i++) {
+        layer1_free_transaction_list_response(callers[i].list);
+    }
+
+    TransactionListResponse *later = layer1_list_transactions(client, "pool-1", "reference:even");
+    CHECK(later && later->count == TRANSACTIONS);
+    CHECK(stub_server_requests(server) - requests == 3);
+    layer1_free_transaction_list_response(later);
+}
+
+int main(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    char *key_path = test_write_key();
+    StubServer *server = stub_server_start(handle_request, NULL);
+    client = key_path && server
+        ? layer1_client_create(stub_server_url(server), "single-flight-client", key_path) : NULL;
+    CHECK(client && layer1_client_set_coalescing(client, true));
+
+    if (client) {
+        test_identical_lists(server);
+        test_identical_address_lists(server);
+        test_distinct_and_later_calls(server);
+        printf("%llu requests served, %llu calls coalesced\n",
+               (unsigned long long)stub_server_requests(server),
+               (unsigned long long)layer1_client_coalesced_requests(client));
+        layer1_client_destroy(client);
+    }
+
+    stub_server_stop(server);
+    test_remove_key(key_path);
+    curl_global_cleanup();
+    return test_result();
+}
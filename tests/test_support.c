@@ -0,0 +1,368 @@
+#include "test_support.h"
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static atomic_int failures;
+
+void test_fail(const char *file, int line, const char *condition) {
+    atomic_fetch_add(&failures, 1);
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+}
+
+int test_failures(void) {
+    return atomic_load(&failures);
+}
+
+int test_result(void) {
+    return test_failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+char *test_write_key(void) {
+    EVP_PKEY *key = EVP_PKEY_Q_keygen(NULL, NULL, "ED25519");
+    if (!key) {
+        fprintf(stderr, "Error: Could not generate a test key\n");
+        return NULL;
+    }
+
+    char *path = strdup("/tmp/layer1_test_key_XXXXXX");
+    int fd = path ? mkstemp(path) : -1;
+    FILE *file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    bool written = file && PEM_write_PrivateKey(file, key, NULL, NULL, 0, NULL, NULL);
+    if (file) {
+        written = fclose(file) == 0 && written;
+    } else if (fd >= 0) {
+        close(fd);
+    }
+    EVP_PKEY_free(key);
+
+    if (!written) {
+        fprintf(stderr, "Error: Could not write the test key\n");
+        if (fd >= 0) {
+            unlink(path);
+        }
+        free(path);
+        return NULL;
+    }
+    return path;
+}
+
+void test_remove_key(char *path) {
+    if (path) {
+        unlink(path);
+        free(path);
+    }
+}
+
+typedef struct StubConnection {
+    int fd;
+    pthread_t thread;
+    StubServer *server;
+    struct StubConnection *next;
+} StubConnection;
+
+struct StubServer {
+    int listen_fd;
+    char url[64];
+    StubHandler handler;
+    void *user_data;
+    pthread_t accept_thread;
+    pthread_mutex_t lock;               // Guards connections and stopping
+    StubConnection *connections;
+    bool stopping;
+    atomic_uint_fast64_t requests;
+    atomic_uint_fast64_t unsigned_requests;
+};
+
+static bool send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return true;
+}
+
+// Value of header name in the header block, which ends at headers_end
+static const char *find_header(const char *headers, const char *headers_end, const char *name) {
+    size_t name_length = strlen(name);
+    for (const char *line = strstr(headers, "\r\n"); line && line < headers_end; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, name, name_length) == 0 && line[name_length] == ':') {
+            const char *value = line + name_length + 1;
+            while (*value == ' ') {
+                value++;
+            }
+            return value;
+        }
+    }
+    return NULL;
+}
+
+static bool send_response(int fd, const StubResponse *response) {
+    const char *body = response->body ? response->body : "";
+    size_t body_length = strlen(body);
+    char head[256];
+    int head_length = snprintf(head, sizeof(head),
+                               "HTTP/1.1 %d %s\r\n"
+                               "Content-Type: application/json\r\n"
+                               "Content-Length: %zu\r\n"
+                               "\r\n",
+                               response->status, response->status < 400 ? "OK" : "Error", body_length);
+    return send_all(fd, head, (size_t)head_length) && send_all(fd, body, body_length);
+}
+
+// Serve requests on one keep-alive connection until the peer or the server
+// closes it
+static void *serve_connection(void *arg) {
+    StubConnection *connection = arg;
+    StubServer *server = connection->server;
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    char *buffer = malloc(capacity + 1);
+
+    while (buffer) {
+        // Read until the header block is complete
+        char *headers_end;
+        buffer[length] = '\0';
+        while (!(headers_end = strstr(buffer, "\r\n\r\n"))) {
+            if (length == capacity) {
+                goto done;
+            }
+            ssize_t got = recv(connection->fd, buffer + length, capacity - length, 0);
+            if (got <= 0) {
+                goto done;
+            }
+            length += (size_t)got;
+            buffer[length] = '\0';
+        }
+
+        const char *content_length = find_header(buffer, headers_end, "Content-Length");
+        size_t body_length = content_length ? strtoul(content_length, NULL, 10) : 0;
+        size_t head_length = (size_t)(headers_end - buffer) + 4;
+        if (head_length + body_length > capacity) {
+            goto done;
+        }
+
+        const char *expect = find_header(buffer, headers_end, "Expect");
+        if (expect && strncasecmp(expect, "100-continue", 12) == 0 && length < head_length + body_length) {
+            static const char proceed[] = "HTTP/1.1 100 Continue\r\n\r\n";
+            if (!send_all(connection->fd, proceed, sizeof(proceed) - 1)) {
+                goto done;
+            }
+        }
+        while (length < head_length + body_length) {
+            ssize_t got = recv(connection->fd, buffer + length, capacity - length, 0);
+            if (got <= 0) {
+                goto done;
+            }
+            length += (size_t)got;
+        }
+
+        bool signed_request = find_header(buffer, headers_end, "Signature") &&
+                              find_header(buffer, headers_end, "Signature-Input");
+
+        // Split "METHOD target HTTP/1.1" in place
+        *headers_end = '\0';
+        char *target = strchr(buffer, ' ');
+        char *version = target ? strchr(target + 1, ' ') : NULL;
+        if (!version) {
+            goto done;
+        }
+        *target++ = '\0';
+        *version = '\0';
+
+        char saved = buffer[head_length + body_length];
+        buffer[head_length + body_length] = '\0';
+        StubRequest request = { buffer, target, buffer + head_length, body_length, signed_request };
+        StubResponse response = { 200, NULL };
+        atomic_fetch_add(&server->requests, 1);
+        if (!signed_request) {
+            atomic_fetch_add(&server->unsigned_requests, 1);
+        }
+        server->handler(&request, &response, server->user_data);
+        buffer[head_length + body_length] = saved;
+
+        bool sent = send_response(connection->fd, &response);
+        free(response.body);
+        if (!sent) {
+            goto done;
+        }
+
+        // Keep whatever of the next request already arrived
+        length -= head_length + body_length;
+        memmove(buffer, buffer + head_length + body_length, length);
+    }
+
+done:
+    free(buffer);
+    return NULL;
+}
+
+static void *accept_connections(void *arg) {
+    StubServer *server = arg;
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return NULL;        // Listener shut down by stub_server_stop
+        }
+
+        StubConnection *connection = calloc(1, sizeof(StubConnection));
+        if (!connection) {
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->server = server;
+        int nodelay = 1;        // Headers and body go out in separate sends
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        pthread_mutex_lock(&server->lock);
+        bool started = !server->stopping &&
+                       pthread_create(&connection->thread, NULL, serve_connection, connection) == 0;
+        if (started) {
+            connection->next = server->connections;
+            server->connections = connection;
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        if (!started) {
+            close(fd);
+            free(connection);
+        }
+    }
+}
+
+StubServer *stub_server_start(StubHandler handler, void *user_data) {
+    StubServer *server = calloc(1, sizeof(StubServer));
+    if (!server) {
+        return NULL;
+    }
+    server->handler = handler;
+    server->user_data = user_data;
+    atomic_init(&server->requests, 0);
+    atomic_init(&server->unsigned_requests, 0);
+
+    struct sockaddr_in address = { 0 };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;       // Any free port
+    socklen_t address_length = sizeof(address);
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0 ||
+        bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(server->listen_fd, 128) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&address, &address_length) != 0) {
+        fprintf(stderr, "Error: Could not start the stub server\n");
+        if (server->listen_fd >= 0) {
+            close(server->listen_fd);
+        }
+        free(server);
+        return NULL;
+    }
+    snprintf(server->url, sizeof(server->url), "http://127.0.0.1:%u", (unsigned)ntohs(address.sin_port));
+
+    if (pthread_mutex_init(&server->lock, NULL) != 0) {
+        close(server->listen_fd);
+        free(server);
+        return NULL;
+    }
+    if (pthread_create(&server->accept_thread, NULL, accept_connections, server) != 0) {
+        pthread_mutex_destroy(&server->lock);
+        close(server->listen_fd);
+        free(server);
+        return NULL;
+    }
+    return server;
+}
+
+const char *stub_server_url(const StubServer *server) {
+    return server->url;
+}
+
+uint64_t stub_server_requests(StubServer *server) {
+    return atomic_load(&server->requests);
+}
+
+uint64_t stub_server_unsigned_requests(StubServer *server) {
+    return atomic_load(&server->unsigned_requests);
+}
+
+void stub_server_stop(StubServer *server) {
+    if (!server) {
+        return;
+    }
+
+    // Wake accept, then every connection blocked in recv
+    shutdown(server->listen_fd, SHUT_RDWR);
+    pthread_join(server->accept_thread, NULL);
+    close(server->listen_fd);
+
+    pthread_mutex_lock(&server->lock);
+    server->stopping = true;
+    StubConnection *connection = server->connections;
+    server->connections = NULL;
+    pthread_mutex_unlock(&server->lock);
+
+    while (connection) {
+        StubConnection *next = connection->next;
+        shutdown(connection->fd, SHUT_RDWR);
+        pthread_join(connection->thread, NULL);
+        close(connection->fd);
+        free(connection);
+        connection = next;
+    }
+
+    pthread_mutex_destroy(&server->lock);
+    free(server);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+bool stub_query_param(const char *target, const char *name, char *out, size_t out_size) {
+    const char *query = strchr(target, '?');
+    size_t name_length = strlen(name);
+    while (query) {
+        query++;
+        if (strncmp(query, name, name_length) == 0 && query[name_length] == '=') {
+            const char *value = query + name_length + 1;
+            size_t length = 0;
+            while (*value && *value != '&') {
+                int high, low;
+                char c = *value++;
+                if (c == '%' && (high = hex_value(value[0])) >= 0 && (low = hex_value(value[1])) >= 0) {
+                    c = (char)(high << 4 | low);
+                    value += 2;
+                }
+                if (length + 1 >= out_size) {
+                    return false;
+                }
+                out[length++] = c;
+            }
+            out[length] = '\0';
+            return true;
+        }
+        query = strchr(query, '&');
+    }
+    return false;
+}
@@ -0,0 +1,61 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Count a failed check and carry on, so one run reports every failure
+#define CHECK(condition) \
+    ((condition) ? (void)0 : test_fail(__FILE__, __LINE__, #condition))
+
+void test_fail(const char *file, int line, const char *condition);
+
+// Checks failed so far; main returns test_result() as its exit status
+int test_failures(void);
+int test_result(void);
+
+// Write a fresh Ed25519 private key to a temporary PEM file. The returned
+// path is freed, and the file removed, with test_remove_key.
+char *test_write_key(void);
+void test_remove_key(char *path);
+
+// A minimal HTTP/1.1 server on 127.0.0.1 standing in for the Layer1 API.
+// Every connection is served on its own thread with keep-alive, and each
+// request is handed to the handler, which fills in the response.
+typedef struct {
+    const char *method;
+    const char *target;         // Path and query, as sent
+    const char *body;
+    size_t body_length;
+    bool signed_request;        // Carried Signature and Signature-Input headers
+} StubRequest;
+
+typedef struct {
+    int status;                 // 200 unless set
+    char *body;                 // malloc'ed by the handler, freed by the server
+} StubResponse;
+
+// Called on connection threads, possibly several at once
+typedef void (*StubHandler)(const StubRequest *request, StubResponse *response, void *user_data);
+
+typedef struct StubServer StubServer;
+
+StubServer *stub_server_start(StubHandler handler, void *user_data);
+
+// Base URL to create clients with, e.g. http://127.0.0.1:40123
+const char *stub_server_url(const StubServer *server);
+
+// Requests served, and those among them that were not signed
+uint64_t stub_server_requests(StubServer *server);
+uint64_t stub_server_unsigned_requests(StubServer *server);
+
+// Close every connection and wait for the server threads
+void stub_server_stop(StubServer *server);
+
+// Copy the percent-decoded value of a query parameter of a request target
+// into out; false if it is absent or does not fit
+bool stub_query_param(const char *target, const char *name, char *out, size_t out_size);
+
+#endif // TEST_SUPPORT_H
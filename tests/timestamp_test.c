@@ -0,0 +1,129 @@
+// createdAt parsing: fractions of one to nine digits, +hh:mm and -hh:mm
+// offsets, days checked against the length of their month in leap and
+// common years, malformed text, and every day from 1970 to 2100 against
+// timegm.
+
+#include "timestamp.h"
+#include "test_support.h"
+#include <string.h>
+#include <time.h>
+
+static bool parses_to(const char *text, int64_t expected) {
+    int64_t ms = 0;
+    return timestamp_parse_ms(text, strlen(text), &ms) && ms == expected;
+}
+
+static bool rejected(const char *text) {
+    int64_t ms = 0;
+    return !timestamp_parse_ms(text, strlen(text), &ms);
+}
+
+// 2025-03-22T01:39:27Z
+#define BASE_MS 1742607567000ll
+
+static void test_fractions(void) {
+    CHECK(parses_to("2025-03-22T01:39:27Z", BASE_MS));
+    CHECK(parses_to("2025-03-22T01:39:27.4Z", BASE_MS + 400));
+    CHECK(parses_to("2025-03-22T01:39:27.44Z", BASE_MS + 440));
+    CHECK(parses_to("2025-03-22T01:39:27.446Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.4461Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.44619Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.446199Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.4461999Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.44619999Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.446199999Z", BASE_MS + 446));
+    CHECK(parses_to("2025-03-22T01:39:27.007Z", BASE_MS + 7));
+    CHECK(parses_to("2025-03-22t01:39:27.446z", BASE_MS + 446));
+    CHECK(rejected("2025-03-22T01:39:27.Z"));
+    CHECK(rejected("2025-03-22T01:39:27.4a6Z"));
+}
+
+// An offset is the local time's distance from UTC, so it is taken back off
+static void test_offsets(void) {
+    CHECK(parses_to("2025-03-22T01:39:27+00:00", BASE_MS));
+    CHECK(parses_to("2025-03-22T07:09:27+05:30", BASE_MS));
+    CHECK(parses_to("2025-03-21T17:39:27-08:00", BASE_MS));
+    CHECK(parses_to("2025-03-22T01:39:27.446-00:45", BASE_MS + 446 + 45 * 60000));
+    CHECK(parses_to("2025-03-22T01:39:27.5+23:59", BASE_MS + 500 - (23 * 60 + 59) * 60000ll));
+    CHECK(rejected("2025-03-22T01:39:27+24:00"));
+    CHECK(rejected("2025-03-22T01:39:27+05:60"));
+    CHECK(rejected("2025-03-22T01:39:27+0530"));
+    CHECK(rejected("2025-03-22T01:39:27+05:3"));
+    CHECK(rejected("2025-03-22T01:39:27"));
+    CHECK(rejected("2025-03-22T01:39:27ZZ"));
+}
+
+static void test_days_of_month(void) {
+    CHECK(rejected("2025-02-29T00:00:00Z"));
+    CHECK(rejected("2025-02-31T00:00:00Z"));
+    CHECK(parses_to("2024-02-29T23:59:59Z", 1709251199000ll));
+    CHECK(rejected("2024-02-30T00:00:00Z"));
+    CHECK(parses_to("2000-02-29T00:00:00Z", 951782400000ll));
+    CHECK(rejected("1900-02-29T00:00:00Z"));
+    CHECK(rejected("2100-02-29T00:00:00Z"));
+    CHECK(rejected("2025-04-31T00:00:00Z"));
+    CHECK(rejected("2025-06-31T00:00:00Z"));
+    CHECK(rejected("2025-09-31T00:00:00Z"));
+    CHECK(rejected("2025-11-31T00:00:00Z"));
+    CHECK(!rejected("2025-01-31T00:00:00Z"));
+    CHECK(!rejected("2025-12-31T00:00:00Z"));
+    CHECK(rejected("2025-01-00T00:00:00Z"));
+    CHECK(rejected("2025-01-32T00:00:00Z"));
+    CHECK(rejected("2025-00-10T00:00:00Z"));
+    CHECK(rejected("2025-13-10T00:00:00Z"));
+}
+
+static void test_malformed(void) {
+    CHECK(parses_to("1969-12-31T23:59:59.999Z", -1));
+    CHECK(parses_to("1970-01-01T00:00:00Z", 0));
+    CHECK(rejected("2025-03-22 01:39:27Z"));
+    CHECK(rejected("2025/03/22T01:39:27Z"));
+    CHECK(rejected("2025-03-22T01-39-27Z"));
+    CHECK(rejected("2025-03-22T24:00:00Z"));
+    CHECK(rejected("2025-03-22T23:60:00Z"));
+    CHECK(rejected("2025-03-22T23:59:61Z"));
+    CHECK(rejected("2025-3-22T01:39:27Z"));
+    CHECK(rejected("20x5-03-22T01:39:27Z"));
+    CHECK(rejected("2025-03-22"));
+    CHECK(rejected(""));
+}
+
+// 12:34:56.789 on every day of 1970 to 2100, leap days included
+static void test_against_timegm(void) {
+    static const int lengths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int checked = 0;
+    for (int year = 1970; year <= 2100; year++) {
+        bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+        for (int month = 1; month <= 12; month++) {
+            int days = lengths[month - 1] + (month == 2 && leap);
+            for (int day = 1; day <= days + 1; day++) {
+                char text[64];
+                snprintf(text, sizeof(text), "%04d-%02d-%02dT12:34:56.789Z", year, month, day);
+                if (day > days) {
+                    CHECK(rejected(text));
+                    continue;
+                }
+
+                struct tm tm = { 0 };
+                tm.tm_year = year - 1900;
+                tm.tm_mon = month - 1;
+                tm.tm_mday = day;
+                tm.tm_hour = 12;
+                tm.tm_min = 34;
+                tm.tm_sec = 56;
+                CHECK(parses_to(text, (int64_t)timegm(&tm) * 1000 + 789));
+                checked++;
+            }
+        }
+    }
+    CHECK(checked == 47847);
+}
+
+int main(void) {
+    test_fractions();
+    test_offsets();
+    test_days_of_month();
+    test_malformed();
+    test_against_timegm();
+    return test_result();
+}